@@ -46,6 +46,176 @@ typedef int32_t dtl_json_error_t;
 #define DTL_JSON_UNEXPECTED_EOB_ERROR     ((dtl_json_error_t) 3) //EOB: End Of Buffer
 #define DTL_JSON_EMPTY_KEY_ERROR          ((dtl_json_error_t) 4)
 #define DTL_JSON_UNMATCHED_STRING_LITERAL ((dtl_json_error_t) 5)
+#define DTL_JSON_TYPE_ERROR               ((dtl_json_error_t) 6)
+#define DTL_JSON_INVALID_ESCAPE_ERROR     ((dtl_json_error_t) 7)
+#define DTL_JSON_INVALID_UTF8_ERROR       ((dtl_json_error_t) 8)
+#define DTL_JSON_LIMIT_ERROR              ((dtl_json_error_t) 9)
+#define DTL_JSON_INVALID_ARGUMENT_ERROR   ((dtl_json_error_t) 10) //NULL pointer or empty range passed to a function
+
+/**
+ * Location of the first error found by dtl_json_validate.
+ */
+typedef struct dtl_json_error_info_tag
+{
+   dtl_json_error_t errorCode;
+   size_t offset; //byte offset from beginning of buffer
+   uint32_t lineNumber; //first line is 1
+   uint32_t column; //byte position within line, first column is 1
+} dtl_json_error_info_t;
+
+/**
+ * Limits on the documents accepted by a reader or parser, see dtl_json_reader_set_limits. A limit set to 0 is not checked.
+ */
+typedef struct dtl_json_limits_tag
+{
+   uint32_t maxDepth; //nesting levels of arrays and objects
+   uint32_t maxStringLength; //bytes between the quotes of a string or key, as written in the document
+   uint32_t maxElements; //values in the document, counting arrays, objects and scalars
+   size_t maxBytes; //estimated bytes allocated for the document
+} dtl_json_limits_t;
+
+typedef int32_t dtl_json_parser_status_t;
+
+#define DTL_JSON_PARSER_NEED_MORE         ((dtl_json_parser_status_t) 0)
+#define DTL_JSON_PARSER_DONE              ((dtl_json_parser_status_t) 1)
+#define DTL_JSON_PARSER_ERROR             ((dtl_json_parser_status_t) 2)
+
+typedef struct dtl_json_parser_tag dtl_json_parser_t;
+
+/**
+ * Reusable reader, keeps its buffers between documents.
+ */
+typedef struct dtl_json_reader_tag dtl_json_reader_t;
+
+/**
+ * Key pool, stores each distinct object key once. A pool shared between readers must only be used by one of them at a time.
+ */
+typedef struct dtl_json_intern_tag dtl_json_intern_t;
+
+typedef uint8_t dtl_json_engine_t;
+
+#define DTL_JSON_ENGINE_STATE_MACHINE     ((dtl_json_engine_t) 0) //character-by-character state machine (default, reference implementation)
+#define DTL_JSON_ENGINE_STRUCTURAL_INDEX  ((dtl_json_engine_t) 1) //SIMD structural index followed by a walk over the index
+
+/**
+ * Event callbacks used by dtl_json_parse. Callbacks that are NULL are skipped.
+ * String and key slices point into the input (or into an internal buffer when the string contains escape sequences).
+ * They are not null-terminated and are only valid for the duration of the callback.
+ * The exception is a key held by the pool of a reader passed to dtl_json_reader_parse_bstr, which points into the pool.
+ */
+typedef struct dtl_json_handler_tag
+{
+   void (*on_begin_object)(void *arg);
+   void (*on_end_object)(void *arg);
+   void (*on_begin_array)(void *arg);
+   void (*on_end_array)(void *arg);
+   void (*on_key)(void *arg, const char *pKey, uint32_t keyLen);
+   void (*on_string)(void *arg, const char *pStr, uint32_t strLen);
+   void (*on_int)(void *arg, int64_t value);
+   void (*on_bool)(void *arg, bool value);
+   void (*on_null)(void *arg);
+   void (*on_double)(void *arg, double value); //numbers with fraction or exponent part
+   void (*on_uint)(void *arg, uint64_t value); //integers above INT64_MAX, sent to on_double when NULL
+} dtl_json_handler_t;
+
+/**
+ * Called by dtl_json_load_lines for each record. For a malformed line dv is NULL and errorCode tells why.
+ * dv is released when the callback returns, call dtl_dv_inc_ref to keep it.
+ * Return false to stop loading. Returning true for a malformed line skips it.
+ */
+typedef bool (*dtl_json_line_func_t)(void *arg, uint32_t lineNumber, dtl_dv_t *dv, dtl_json_error_t errorCode);
+
+typedef uint8_t dtl_json_token_t;
+
+#define DTL_JSON_TOKEN_NONE               ((dtl_json_token_t) 0)
+#define DTL_JSON_TOKEN_ERROR              ((dtl_json_token_t) 1)
+#define DTL_JSON_TOKEN_END                ((dtl_json_token_t) 2) //End of document
+#define DTL_JSON_TOKEN_BEGIN_OBJECT       ((dtl_json_token_t) 3)
+#define DTL_JSON_TOKEN_END_OBJECT         ((dtl_json_token_t) 4)
+#define DTL_JSON_TOKEN_BEGIN_ARRAY        ((dtl_json_token_t) 5)
+#define DTL_JSON_TOKEN_END_ARRAY          ((dtl_json_token_t) 6)
+#define DTL_JSON_TOKEN_KEY                ((dtl_json_token_t) 7)
+#define DTL_JSON_TOKEN_STRING             ((dtl_json_token_t) 8)
+#define DTL_JSON_TOKEN_NUMBER             ((dtl_json_token_t) 9)
+#define DTL_JSON_TOKEN_TRUE               ((dtl_json_token_t) 10)
+#define DTL_JSON_TOKEN_FALSE              ((dtl_json_token_t) 11)
+#define DTL_JSON_TOKEN_NULL               ((dtl_json_token_t) 12)
+
+#define DTL_JSON_CURSOR_MAX_DEPTH         512 //deeper nesting gives DTL_JSON_LIMIT_ERROR, also in dtl_json_validate and dtl_json_load_into
+
+/**
+ * Pull-based tokenizer over a JSON buffer. The buffer must remain valid while the cursor is in use.
+ */
+typedef struct dtl_json_cursor_tag
+{
+   const uint8_t *pNext;
+   const uint8_t *pEnd;
+   const uint8_t *pTokenBegin;
+   const uint8_t *pTokenEnd;
+   dtl_json_token_t token;
+   uint8_t state;
+   int32_t depth;
+   uint8_t containerStack[DTL_JSON_CURSOR_MAX_DEPTH / 8]; //one bit per nesting level, set for objects
+   dtl_json_error_t lastError;
+   uint32_t lineNumber;
+   bool isPlainString; //current string or key token has no escape sequences or control characters
+   adt_str_t tmpStr; //holds unescaped strings
+} dtl_json_cursor_t;
+
+/**
+ * Document indexed by dtl_json_load_lazy. Values are decoded only when accessed.
+ */
+typedef struct dtl_json_lazy_tag dtl_json_lazy_t;
+typedef uint32_t dtl_json_lazy_node_t; //position of value in the structural index
+
+/**
+ * Compiled set of JSON Pointers used by dtl_json_load_projected.
+ */
+typedef struct dtl_json_projection_tag dtl_json_projection_t;
+
+#define DTL_JSON_LAZY_NONE                ((dtl_json_lazy_node_t) UINT32_MAX)
+
+/**
+ * Schema compiled by dtl_json_encoder_new, used to write C structs as JSON.
+ */
+typedef struct dtl_json_encoder_tag dtl_json_encoder_t;
+
+typedef uint8_t dtl_json_field_type_t;
+
+#define DTL_JSON_FIELD_BOOL               ((dtl_json_field_type_t) 0) //bool
+#define DTL_JSON_FIELD_I32                ((dtl_json_field_type_t) 1) //int32_t
+#define DTL_JSON_FIELD_U32                ((dtl_json_field_type_t) 2) //uint32_t
+#define DTL_JSON_FIELD_I64                ((dtl_json_field_type_t) 3) //int64_t
+#define DTL_JSON_FIELD_U64                ((dtl_json_field_type_t) 4) //uint64_t
+#define DTL_JSON_FIELD_DOUBLE             ((dtl_json_field_type_t) 5) //double
+#define DTL_JSON_FIELD_STRING             ((dtl_json_field_type_t) 6) //char array of elemSize bytes, null-terminated
+#define DTL_JSON_FIELD_STRUCT             ((dtl_json_field_type_t) 7) //nested struct of elemSize bytes described by schema
+
+struct dtl_json_schema_tag;
+
+/**
+ * Describes one member of a C struct. A field with maxCount above 0 is a C array of up to maxCount elements,
+ * the number of elements used is stored in the uint32_t member at countOffset.
+ */
+typedef struct dtl_json_field_tag
+{
+   const char *name; //JSON key
+   size_t offset; //offsetof the member
+   dtl_json_field_type_t type;
+   size_t elemSize; //sizeof one element, required for DTL_JSON_FIELD_STRING and DTL_JSON_FIELD_STRUCT
+   const struct dtl_json_schema_tag *schema; //for DTL_JSON_FIELD_STRUCT
+   uint32_t maxCount; //0 for a single value
+   size_t countOffset; //offsetof the uint32_t element count, used when maxCount is above 0
+} dtl_json_field_t;
+
+/**
+ * Descriptor table of a C struct, used by dtl_json_decode and dtl_json_encoder_new.
+ */
+typedef struct dtl_json_schema_tag
+{
+   const dtl_json_field_t *fields;
+   uint32_t numFields;
+} dtl_json_schema_t;
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC FUNCTION PROTOTYPES
@@ -54,8 +224,84 @@ int32_t dtl_json_dump(const dtl_dv_t *dv, FILE *fh, int32_t indent, bool sortKey
 adt_str_t* dtl_json_dumps(const dtl_dv_t *dv, int32_t indent, bool sortKeys);
 
 dtl_dv_t* dtl_json_load(FILE *fh);
+dtl_dv_t* dtl_json_load_file(const char *path);
 dtl_dv_t* dtl_json_loads(adt_str_t *str);
 dtl_dv_t* dtl_json_load_cstr(const char *str);
 dtl_dv_t* dtl_json_load_bstr(const uint8_t *pBegin, const uint8_t *pEnd);
+dtl_dv_t* dtl_json_load_parallel(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t numThreads);
+dtl_json_error_t dtl_json_load_lines(FILE *fh, dtl_json_line_func_t callback, void *arg);
+dtl_json_error_t dtl_json_load_lines_bstr(const uint8_t *pBegin, const uint8_t *pEnd, dtl_json_line_func_t callback, void *arg);
+dtl_json_error_t dtl_json_load_lines_parallel(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t numThreads, bool isOrdered, dtl_json_line_func_t callback, void *arg);
+dtl_json_error_t dtl_json_load_lines_file(const char *path, uint32_t numThreads, bool isOrdered, dtl_json_line_func_t callback, void *arg);
+dtl_dv_t* dtl_json_extract(const uint8_t *pBegin, const uint8_t *pEnd, const char *pointer);
+dtl_json_projection_t* dtl_json_projection_new(const char **paths, uint32_t numPaths);
+void dtl_json_projection_delete(dtl_json_projection_t *self);
+dtl_dv_t* dtl_json_load_projected(const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_projection_t *projection);
+dtl_json_error_t dtl_json_load_into(dtl_dv_t **ppDv, const uint8_t *pBegin, const uint8_t *pEnd, dtl_av_t *changes);
+dtl_json_error_t dtl_json_decode(const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_schema_t *schema, void *dest);
+dtl_json_encoder_t* dtl_json_encoder_new(const dtl_json_schema_t *schema);
+void dtl_json_encoder_delete(dtl_json_encoder_t *self);
+dtl_json_error_t dtl_json_encoder_write(const dtl_json_encoder_t *self, const void *src, adt_str_t *dest);
+
+dtl_json_error_t dtl_json_parse(FILE *fh, const dtl_json_handler_t *handler, void *arg);
+dtl_json_error_t dtl_json_parse_bstr(const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_handler_t *handler, void *arg);
+dtl_json_error_t dtl_json_validate(const uint8_t *pBegin, const uint8_t *pEnd, dtl_json_error_info_t *errInfo);
+dtl_json_error_t dtl_json_validate_utf8(const uint8_t *pBegin, const uint8_t *pEnd, dtl_json_error_info_t *errInfo);
+
+dtl_json_parser_t* dtl_json_parser_new(void);
+void dtl_json_parser_delete(dtl_json_parser_t *self);
+dtl_json_parser_status_t dtl_json_parser_feed(dtl_json_parser_t *self, const uint8_t *pData, uint32_t dataLen);
+dtl_json_parser_status_t dtl_json_parser_finish(dtl_json_parser_t *self);
+dtl_dv_t* dtl_json_parser_result(dtl_json_parser_t *self);
+dtl_json_error_t dtl_json_parser_last_error(const dtl_json_parser_t *self);
+uint32_t dtl_json_parser_line_number(const dtl_json_parser_t *self);
+void dtl_json_parser_set_limits(dtl_json_parser_t *self, const dtl_json_limits_t *limits);
+
+dtl_json_reader_t* dtl_json_reader_new(void);
+void dtl_json_reader_delete(dtl_json_reader_t *self);
+dtl_dv_t* dtl_json_reader_load_bstr(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+dtl_dv_t* dtl_json_reader_load_cstr(dtl_json_reader_t *self, const char *str);
+dtl_json_error_t dtl_json_reader_parse_bstr(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_handler_t *handler, void *arg);
+dtl_json_error_t dtl_json_reader_last_error(const dtl_json_reader_t *self);
+uint32_t dtl_json_reader_line_number(const dtl_json_reader_t *self);
+void dtl_json_reader_set_key_pool(dtl_json_reader_t *self, dtl_json_intern_t *pool);
+void dtl_json_reader_set_limits(dtl_json_reader_t *self, const dtl_json_limits_t *limits);
+void dtl_json_reader_set_engine(dtl_json_reader_t *self, dtl_json_engine_t engine);
+dtl_json_engine_t dtl_json_reader_get_engine(const dtl_json_reader_t *self);
+
+dtl_json_intern_t *dtl_json_intern_new(uint32_t maxCount);
+void dtl_json_intern_delete(dtl_json_intern_t *self);
+uint32_t dtl_json_intern_length(const dtl_json_intern_t *self);
+void dtl_json_intern_clear(dtl_json_intern_t *self);
+
+void dtl_json_cursor_create(dtl_json_cursor_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+void dtl_json_cursor_destroy(dtl_json_cursor_t *self);
+dtl_json_token_t dtl_json_cursor_next(dtl_json_cursor_t *self);
+dtl_json_token_t dtl_json_cursor_type(const dtl_json_cursor_t *self);
+int32_t dtl_json_cursor_depth(const dtl_json_cursor_t *self);
+dtl_json_error_t dtl_json_cursor_skip(dtl_json_cursor_t *self);
+dtl_json_error_t dtl_json_cursor_get_i64(dtl_json_cursor_t *self, int64_t *value);
+dtl_json_error_t dtl_json_cursor_get_u64(dtl_json_cursor_t *self, uint64_t *value);
+dtl_json_error_t dtl_json_cursor_get_double(dtl_json_cursor_t *self, double *value);
+dtl_json_error_t dtl_json_cursor_get_bool(dtl_json_cursor_t *self, bool *value);
+dtl_json_error_t dtl_json_cursor_get_string_slice(dtl_json_cursor_t *self, const char **ppStr, uint32_t *pStrLen);
+dtl_json_error_t dtl_json_cursor_last_error(const dtl_json_cursor_t *self);
+
+dtl_json_lazy_t* dtl_json_load_lazy(const uint8_t *pBegin, const uint8_t *pEnd);
+void dtl_json_lazy_delete(dtl_json_lazy_t *self);
+dtl_json_lazy_node_t dtl_json_lazy_root(const dtl_json_lazy_t *self);
+dtl_json_token_t dtl_json_lazy_type(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node);
+dtl_json_lazy_node_t dtl_json_lazy_get(dtl_json_lazy_t *self, dtl_json_lazy_node_t node, const char *key);
+dtl_json_lazy_node_t dtl_json_lazy_at(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, uint32_t index);
+dtl_json_lazy_node_t dtl_json_lazy_first(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node);
+dtl_json_lazy_node_t dtl_json_lazy_next(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node);
+int32_t dtl_json_lazy_length(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node);
+dtl_json_error_t dtl_json_lazy_get_key(dtl_json_lazy_t *self, dtl_json_lazy_node_t node, const char **ppKey, uint32_t *pKeyLen);
+dtl_json_error_t dtl_json_lazy_get_i64(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, int64_t *value);
+dtl_json_error_t dtl_json_lazy_get_u64(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, uint64_t *value);
+dtl_json_error_t dtl_json_lazy_get_double(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, double *value);
+dtl_json_error_t dtl_json_lazy_get_bool(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, bool *value);
+dtl_json_error_t dtl_json_lazy_get_string_slice(dtl_json_lazy_t *self, dtl_json_lazy_node_t node, const char **ppStr, uint32_t *pStrLen);
+dtl_dv_t* dtl_json_lazy_value(dtl_json_lazy_t *self, dtl_json_lazy_node_t node);
 
 #endif //DTL_JSON_H
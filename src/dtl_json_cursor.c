@@ -0,0 +1,539 @@
+/*****************************************************************************
+* \file      dtl_json_cursor.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Pull-based JSON tokenizer
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <string.h>
+#include <stdbool.h>
+#include "bstr.h"
+#include "dtl_json.h"
+#include "dtl_json_scan.h"
+#include "dtl_json_number.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+typedef uint8_t cursorState_t;
+
+#define CURSOR_STATE_VALUE         ((cursorState_t) 0u) //expects a value
+#define CURSOR_STATE_ARRAY_FIRST   ((cursorState_t) 1u) //expects first array element or ']'
+#define CURSOR_STATE_OBJECT_FIRST  ((cursorState_t) 2u) //expects first object key or '}'
+#define CURSOR_STATE_KEY           ((cursorState_t) 3u) //expects object key
+#define CURSOR_STATE_SEP           ((cursorState_t) 4u) //expects ':'
+#define CURSOR_STATE_NEXT          ((cursorState_t) 5u) //expects ',' or end of container
+#define CURSOR_STATE_END           ((cursorState_t) 6u)
+#define CURSOR_STATE_ERROR         ((cursorState_t) 7u)
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static dtl_json_token_t dtl_json_cursor_read_value(dtl_json_cursor_t *self);
+static dtl_json_token_t dtl_json_cursor_read_key(dtl_json_cursor_t *self);
+static dtl_json_token_t dtl_json_cursor_begin_container(dtl_json_cursor_t *self, bool isObject);
+static dtl_json_token_t dtl_json_cursor_end_container(dtl_json_cursor_t *self, bool isObject);
+static dtl_json_token_t dtl_json_cursor_set_error(dtl_json_cursor_t *self, dtl_json_error_t errorCode);
+static bool dtl_json_cursor_top_is_object(const dtl_json_cursor_t *self);
+static const uint8_t *dtl_json_cursor_lstrip(dtl_json_cursor_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+static const uint8_t *dtl_json_cursor_find_string_end(const uint8_t *pBegin, const uint8_t *pEnd, bool *pIsPlain);
+static bool dtl_json_cursor_parse_number(const dtl_json_cursor_t *self, dtl_json_number_t *number);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+void dtl_json_cursor_create(dtl_json_cursor_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   if (self != 0)
+   {
+      self->pNext = pBegin;
+      self->pEnd = pEnd;
+      self->pTokenBegin = (const uint8_t*) 0;
+      self->pTokenEnd = (const uint8_t*) 0;
+      self->token = DTL_JSON_TOKEN_NONE;
+      self->state = CURSOR_STATE_VALUE;
+      self->depth = 0;
+      memset(self->containerStack, 0, sizeof(self->containerStack));
+      self->lastError = DTL_JSON_NO_ERROR;
+      self->lineNumber = 1u;
+      self->isPlainString = false;
+      adt_str_create(&self->tmpStr);
+   }
+}
+
+void dtl_json_cursor_destroy(dtl_json_cursor_t *self)
+{
+   if (self != 0)
+   {
+      adt_str_destroy(&self->tmpStr);
+   }
+}
+
+/**
+ * Advances the cursor to the next token in the document.
+ * Separators (',' and ':') are consumed silently and are never returned as tokens.
+ */
+dtl_json_token_t dtl_json_cursor_next(dtl_json_cursor_t *self)
+{
+   if (self == 0)
+   {
+      return DTL_JSON_TOKEN_ERROR;
+   }
+   for(;;)
+   {
+      uint8_t c;
+      if (self->state == CURSOR_STATE_END)
+      {
+         self->token = DTL_JSON_TOKEN_END;
+         return self->token;
+      }
+      else if (self->state == CURSOR_STATE_ERROR)
+      {
+         return self->token;
+      }
+      self->pNext = dtl_json_cursor_lstrip(self, self->pNext, self->pEnd);
+      if (self->pNext >= self->pEnd)
+      {
+         if ( (self->state == CURSOR_STATE_NEXT) && (self->depth == 0) )
+         {
+            self->state = CURSOR_STATE_END;
+            continue;
+         }
+         return dtl_json_cursor_set_error(self, DTL_JSON_UNEXPECTED_EOB_ERROR);
+      }
+      c = *self->pNext;
+      switch(self->state)
+      {
+      case CURSOR_STATE_VALUE:
+         return dtl_json_cursor_read_value(self);
+      case CURSOR_STATE_ARRAY_FIRST:
+         if (c == ']')
+         {
+            return dtl_json_cursor_end_container(self, false);
+         }
+         return dtl_json_cursor_read_value(self);
+      case CURSOR_STATE_OBJECT_FIRST:
+         if (c == '}')
+         {
+            return dtl_json_cursor_end_container(self, true);
+         }
+         return dtl_json_cursor_read_key(self);
+      case CURSOR_STATE_KEY:
+         return dtl_json_cursor_read_key(self);
+      case CURSOR_STATE_SEP:
+         if (c != ':')
+         {
+            return dtl_json_cursor_set_error(self, DTL_JSON_UNEXPECTED_CHAR_ERROR);
+         }
+         self->pNext++;
+         self->state = CURSOR_STATE_VALUE;
+         break;
+      case CURSOR_STATE_NEXT:
+         if (self->depth == 0)
+         {
+            //only whitespace is allowed after the top-level value
+            return dtl_json_cursor_set_error(self, DTL_JSON_UNEXPECTED_CHAR_ERROR);
+         }
+         else
+         {
+            bool isObject = dtl_json_cursor_top_is_object(self);
+            if (c == ',')
+            {
+               self->pNext++;
+               self->state = isObject? CURSOR_STATE_KEY : CURSOR_STATE_VALUE;
+            }
+            else if (c == (isObject? '}' : ']'))
+            {
+               return dtl_json_cursor_end_container(self, isObject);
+            }
+            else
+            {
+               return dtl_json_cursor_set_error(self, DTL_JSON_UNEXPECTED_CHAR_ERROR);
+            }
+         }
+         break;
+      default:
+         assert(0);
+      }
+   }
+}
+
+dtl_json_token_t dtl_json_cursor_type(const dtl_json_cursor_t *self)
+{
+   if (self != 0)
+   {
+      return self->token;
+   }
+   return DTL_JSON_TOKEN_ERROR;
+}
+
+/**
+ * Returns number of containers (arrays and objects) that the cursor is currently inside of.
+ */
+int32_t dtl_json_cursor_depth(const dtl_json_cursor_t *self)
+{
+   if (self != 0)
+   {
+      return self->depth;
+   }
+   return 0;
+}
+
+/**
+ * Skips the value at the current token.
+ * When the current token is a key, the value belonging to the key is skipped.
+ * When the current token begins an array or object, the cursor moves to its matching end token.
+ * Skipped content is only checked for balanced brackets and terminated strings, it is otherwise not validated.
+ */
+dtl_json_error_t dtl_json_cursor_skip(dtl_json_cursor_t *self)
+{
+   if (self == 0)
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if (self->token == DTL_JSON_TOKEN_KEY)
+   {
+      if (dtl_json_cursor_next(self) == DTL_JSON_TOKEN_ERROR)
+      {
+         return self->lastError;
+      }
+   }
+   if ( (self->token == DTL_JSON_TOKEN_BEGIN_OBJECT) || (self->token == DTL_JSON_TOKEN_BEGIN_ARRAY) )
+   {
+      const uint8_t *pNext = self->pNext;
+      const uint8_t *pEnd = self->pEnd;
+      int32_t level = 1;
+      while (pNext < pEnd)
+      {
+         uint8_t c;
+         pNext = dtl_json_scan_bracket(pNext, pEnd, &self->lineNumber);
+         if (pNext >= pEnd)
+         {
+            break;
+         }
+         c = *pNext++;
+         if (c == '"')
+         {
+            bool isPlain;
+            pNext = dtl_json_cursor_find_string_end(pNext - 1, pEnd, &isPlain);
+            if (pNext == 0)
+            {
+               dtl_json_cursor_set_error(self, DTL_JSON_UNMATCHED_STRING_LITERAL);
+               return self->lastError;
+            }
+         }
+         else if ( (c == '{') || (c == '[') )
+         {
+            level++;
+         }
+         else if ( (c == '}') || (c == ']') )
+         {
+            if (--level == 0)
+            {
+               break;
+            }
+         }
+      }
+      if (level != 0)
+      {
+         dtl_json_cursor_set_error(self, DTL_JSON_UNEXPECTED_EOB_ERROR);
+         return self->lastError;
+      }
+      self->pNext = pNext - 1;
+      dtl_json_cursor_end_container(self, (self->token == DTL_JSON_TOKEN_BEGIN_OBJECT));
+   }
+   return self->lastError;
+}
+
+dtl_json_error_t dtl_json_cursor_get_i64(dtl_json_cursor_t *self, int64_t *value)
+{
+   dtl_json_number_t number;
+   if ( (self == 0) || (value == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if ( (!dtl_json_cursor_parse_number(self, &number)) ||
+        (!dtl_json_number_to_i64(&number, value)) )
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+dtl_json_error_t dtl_json_cursor_get_u64(dtl_json_cursor_t *self, uint64_t *value)
+{
+   dtl_json_number_t number;
+   if ( (self == 0) || (value == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if ( (!dtl_json_cursor_parse_number(self, &number)) ||
+        (!dtl_json_number_to_u64(&number, value)) )
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+/**
+ * Converts current number token to the nearest double. Integers are accepted as well.
+ */
+dtl_json_error_t dtl_json_cursor_get_double(dtl_json_cursor_t *self, double *value)
+{
+   dtl_json_number_t number;
+   if ( (self == 0) || (value == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if (!dtl_json_cursor_parse_number(self, &number))
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   *value = dtl_json_number_to_double(&number);
+   return DTL_JSON_NO_ERROR;
+}
+
+dtl_json_error_t dtl_json_cursor_get_bool(dtl_json_cursor_t *self, bool *value)
+{
+   if ( (self == 0) || (value == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if ( (self->token != DTL_JSON_TOKEN_TRUE) && (self->token != DTL_JSON_TOKEN_FALSE) )
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   *value = (self->token == DTL_JSON_TOKEN_TRUE);
+   return DTL_JSON_NO_ERROR;
+}
+
+/**
+ * Returns content of current string or key token as a (pointer, length) slice.
+ * Strings without escape sequences or control characters point directly into the input buffer.
+ * Other strings are unescaped into an internal buffer which is valid until the next call to this function.
+ */
+dtl_json_error_t dtl_json_cursor_get_string_slice(dtl_json_cursor_t *self, const char **ppStr, uint32_t *pStrLen)
+{
+   const uint8_t *pContentBegin;
+   const uint8_t *pContentEnd;
+   if ( (self == 0) || (ppStr == 0) || (pStrLen == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if ( (self->token != DTL_JSON_TOKEN_STRING) && (self->token != DTL_JSON_TOKEN_KEY) )
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   pContentBegin = self->pTokenBegin + 1;
+   pContentEnd = self->pTokenEnd - 1;
+   if (self->isPlainString)
+   {
+      *ppStr = (const char*) pContentBegin;
+      *pStrLen = (uint32_t) (pContentEnd - pContentBegin);
+   }
+   else
+   {
+      bstr_context_t ctx;
+      bstr_context_create(&ctx);
+      adt_str_clear(&self->tmpStr);
+      if (bstr_parse_json_string_literal(&ctx, self->pTokenBegin, self->pTokenEnd, &self->tmpStr) != self->pTokenEnd)
+      {
+         return DTL_JSON_UNMATCHED_STRING_LITERAL;
+      }
+      *ppStr = adt_str_cstr(&self->tmpStr);
+      *pStrLen = (uint32_t) adt_str_size(&self->tmpStr); //byte size, may contain \u0000
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+dtl_json_error_t dtl_json_cursor_last_error(const dtl_json_cursor_t *self)
+{
+   if (self != 0)
+   {
+      return self->lastError;
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static dtl_json_token_t dtl_json_cursor_read_value(dtl_json_cursor_t *self)
+{
+   const uint8_t *pBegin = self->pNext;
+   const uint8_t *pResult = (const uint8_t*) 0;
+   dtl_json_token_t token = DTL_JSON_TOKEN_NONE;
+   int c = (int) *pBegin;
+
+   if (bstr_pred_is_digit(c) || (c == '-') )
+   {
+      dtl_json_number_t number;
+      pResult = dtl_json_number_parse(pBegin, self->pEnd, &number);
+      token = DTL_JSON_TOKEN_NUMBER;
+   }
+   else
+   {
+      switch(c)
+      {
+      case '{':
+         return dtl_json_cursor_begin_container(self, true);
+      case '[':
+         return dtl_json_cursor_begin_container(self, false);
+      case '"':
+         pResult = dtl_json_cursor_find_string_end(pBegin, self->pEnd, &self->isPlainString);
+         if (pResult == 0)
+         {
+            return dtl_json_cursor_set_error(self, DTL_JSON_UNMATCHED_STRING_LITERAL);
+         }
+         token = DTL_JSON_TOKEN_STRING;
+         break;
+      case 't':
+         pResult = bstr_match_cstr(pBegin, self->pEnd, "true");
+         token = DTL_JSON_TOKEN_TRUE;
+         break;
+      case 'f':
+         pResult = bstr_match_cstr(pBegin, self->pEnd, "false");
+         token = DTL_JSON_TOKEN_FALSE;
+         break;
+      case 'n':
+         pResult = bstr_match_cstr(pBegin, self->pEnd, "null");
+         token = DTL_JSON_TOKEN_NULL;
+         break;
+      default:
+         break;
+      }
+   }
+   if ( (pResult == 0) || (pResult <= pBegin) )
+   {
+      return dtl_json_cursor_set_error(self, DTL_JSON_UNEXPECTED_CHAR_ERROR);
+   }
+   self->pTokenBegin = pBegin;
+   self->pTokenEnd = pResult;
+   self->pNext = pResult;
+   self->token = token;
+   self->state = CURSOR_STATE_NEXT;
+   return token;
+}
+
+static dtl_json_token_t dtl_json_cursor_read_key(dtl_json_cursor_t *self)
+{
+   const uint8_t *pBegin = self->pNext;
+   const uint8_t *pResult;
+   if (*pBegin != '"')
+   {
+      return dtl_json_cursor_set_error(self, DTL_JSON_UNEXPECTED_CHAR_ERROR);
+   }
+   pResult = dtl_json_cursor_find_string_end(pBegin, self->pEnd, &self->isPlainString);
+   if (pResult == 0)
+   {
+      return dtl_json_cursor_set_error(self, DTL_JSON_UNMATCHED_STRING_LITERAL);
+   }
+   if (pResult == (pBegin + 2))
+   {
+      return dtl_json_cursor_set_error(self, DTL_JSON_EMPTY_KEY_ERROR);
+   }
+   self->pTokenBegin = pBegin;
+   self->pTokenEnd = pResult;
+   self->pNext = pResult;
+   self->token = DTL_JSON_TOKEN_KEY;
+   self->state = CURSOR_STATE_SEP;
+   return self->token;
+}
+
+static dtl_json_token_t dtl_json_cursor_begin_container(dtl_json_cursor_t *self, bool isObject)
+{
+   uint8_t mask;
+   if (self->depth >= DTL_JSON_CURSOR_MAX_DEPTH)
+   {
+      return dtl_json_cursor_set_error(self, DTL_JSON_LIMIT_ERROR);
+   }
+   mask = (uint8_t) (1u << (self->depth & 7));
+   if (isObject)
+   {
+      self->containerStack[self->depth >> 3] |= mask;
+   }
+   else
+   {
+      self->containerStack[self->depth >> 3] &= (uint8_t) ~mask;
+   }
+   self->depth++;
+   self->pTokenBegin = self->pNext;
+   self->pTokenEnd = ++self->pNext;
+   self->token = isObject? DTL_JSON_TOKEN_BEGIN_OBJECT : DTL_JSON_TOKEN_BEGIN_ARRAY;
+   self->state = isObject? CURSOR_STATE_OBJECT_FIRST : CURSOR_STATE_ARRAY_FIRST;
+   return self->token;
+}
+
+static dtl_json_token_t dtl_json_cursor_end_container(dtl_json_cursor_t *self, bool isObject)
+{
+   assert(self->depth > 0);
+   self->depth--;
+   self->pTokenBegin = self->pNext;
+   self->pTokenEnd = ++self->pNext;
+   self->token = isObject? DTL_JSON_TOKEN_END_OBJECT : DTL_JSON_TOKEN_END_ARRAY;
+   self->state = CURSOR_STATE_NEXT;
+   return self->token;
+}
+
+static dtl_json_token_t dtl_json_cursor_set_error(dtl_json_cursor_t *self, dtl_json_error_t errorCode)
+{
+   self->lastError = errorCode;
+   self->state = CURSOR_STATE_ERROR;
+   self->token = DTL_JSON_TOKEN_ERROR;
+   return self->token;
+}
+
+static bool dtl_json_cursor_top_is_object(const dtl_json_cursor_t *self)
+{
+   int32_t top = self->depth - 1;
+   assert(top >= 0);
+   return ( (self->containerStack[top >> 3] & (1u << (top & 7)) ) != 0u );
+}
+
+static const uint8_t *dtl_json_cursor_lstrip(dtl_json_cursor_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   return dtl_json_scan_whitespace(pBegin, pEnd, &self->lineNumber);
+}
+
+/**
+ * Returns pointer to the character after the closing quote or NULL if the closing quote was not found before pEnd.
+ * pBegin must point to the opening quote. *pIsPlain is set as by dtl_json_scan_string_end.
+ */
+static const uint8_t *dtl_json_cursor_find_string_end(const uint8_t *pBegin, const uint8_t *pEnd, bool *pIsPlain)
+{
+   return dtl_json_scan_string_end(pBegin, pEnd, pIsPlain);
+}
+
+/**
+ * Lexes the current token into number. Returns false if the current token is not a number.
+ */
+static bool dtl_json_cursor_parse_number(const dtl_json_cursor_t *self, dtl_json_number_t *number)
+{
+   return ( (self->token == DTL_JSON_TOKEN_NUMBER) &&
+            (dtl_json_number_parse(self->pTokenBegin, self->pTokenEnd, number) == self->pTokenEnd) );
+}
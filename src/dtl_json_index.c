@@ -0,0 +1,396 @@
+/*****************************************************************************
+* \file      dtl_json_index.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Structural index of a JSON buffer (stage 1 of the indexed reader)
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dtl_json_index.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define DTL_JSON_INDEX_HAS_SSE2 1
+#define DTL_JSON_INDEX_HAS_AVX2 1
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#include <emmintrin.h>
+#define DTL_JSON_INDEX_HAS_SSE2 1
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define INDEX_EVEN_BITS UINT64_C(0x5555555555555555)
+#define INDEX_ODD_BITS  UINT64_C(0xAAAAAAAAAAAAAAAA)
+
+/**
+ * One bit per byte of a 64-byte block, bit 0 is the first byte.
+ */
+typedef struct dtl_json_blockMasks_tag
+{
+   uint64_t backslash;
+   uint64_t quote;
+   uint64_t op; //one of {}[]:,
+   uint64_t whitespace;
+} dtl_json_blockMasks_t;
+
+typedef void (classifyFunc_t)(const uint8_t *pBlock, dtl_json_blockMasks_t *masks);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static classifyFunc_t *dtl_json_index_select_classify(dtl_json_simd_t simdLevel);
+static void dtl_json_index_classify_scalar(const uint8_t *pBlock, dtl_json_blockMasks_t *masks);
+#ifdef DTL_JSON_INDEX_HAS_SSE2
+static void dtl_json_index_classify_sse2(const uint8_t *pBlock, dtl_json_blockMasks_t *masks);
+#endif
+#ifdef DTL_JSON_INDEX_HAS_AVX2
+static void dtl_json_index_classify_avx2(const uint8_t *pBlock, dtl_json_blockMasks_t *masks);
+#endif
+static uint64_t dtl_json_index_find_escaped(uint64_t backslash, uint64_t *prevEndsOddBackslash);
+static uint64_t dtl_json_index_prefix_xor(uint64_t value);
+static uint32_t dtl_json_index_ctz64(uint64_t value);
+static bool dtl_json_index_reserve(dtl_json_index_t *self, uint32_t minFree, size_t docLen);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+void dtl_json_index_create(dtl_json_index_t *self)
+{
+   if (self != 0)
+   {
+      self->positions = (uint32_t*) 0;
+      self->count = 0u;
+      self->capacity = 0u;
+   }
+}
+
+void dtl_json_index_destroy(dtl_json_index_t *self)
+{
+   if ( (self != 0) && (self->positions != 0) )
+   {
+      free(self->positions);
+      self->positions = (uint32_t*) 0;
+      self->count = 0u;
+      self->capacity = 0u;
+   }
+}
+
+dtl_json_error_t dtl_json_index_build(dtl_json_index_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   return dtl_json_index_build_with(self, pBegin, pEnd, dtl_json_scan_simd_level());
+}
+
+/**
+ * Builds the index using the given instruction set (capped to what the build supports).
+ * The buffer is processed in blocks of 64 bytes. Each block is first classified into bit masks, then quotes,
+ * escapes and string interiors are resolved with carry-less bit arithmetic so that no byte is visited twice.
+ * Returns DTL_JSON_UNMATCHED_STRING_LITERAL when the buffer ends inside a string.
+ * Buffers of 4 GB or more cannot be indexed and give DTL_JSON_MEM_ERROR.
+ */
+dtl_json_error_t dtl_json_index_build_with(dtl_json_index_t *self, const uint8_t *pBegin, const uint8_t *pEnd, dtl_json_simd_t simdLevel)
+{
+   classifyFunc_t *classify = dtl_json_index_select_classify(simdLevel);
+   size_t docLen;
+   size_t offset = 0u;
+   uint64_t prevEndsOddBackslash = 0u;
+   uint64_t prevInString = 0u;
+   uint64_t prevScalar = 0u;
+   if ( (self == 0) || (pBegin == 0) || (pEnd < pBegin) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   self->count = 0u;
+   docLen = (size_t) (pEnd - pBegin);
+   if (docLen >= (size_t) UINT32_MAX)
+   {
+      return DTL_JSON_MEM_ERROR;
+   }
+   while (offset < docLen)
+   {
+      uint8_t tail[DTL_JSON_INDEX_BLOCK_SIZE];
+      const uint8_t *pBlock = pBegin + offset;
+      dtl_json_blockMasks_t masks;
+      uint64_t escaped;
+      uint64_t quotes;
+      uint64_t inString;
+      uint64_t scalar;
+      uint64_t structurals;
+      if ( (docLen - offset) < DTL_JSON_INDEX_BLOCK_SIZE)
+      {
+         //pad the last block with whitespace
+         memset(tail, ' ', sizeof(tail));
+         memcpy(tail, pBlock, docLen - offset);
+         pBlock = tail;
+      }
+      if (!dtl_json_index_reserve(self, DTL_JSON_INDEX_BLOCK_SIZE, docLen))
+      {
+         return DTL_JSON_MEM_ERROR;
+      }
+      classify(pBlock, &masks);
+      escaped = dtl_json_index_find_escaped(masks.backslash, &prevEndsOddBackslash);
+      quotes = masks.quote & ~escaped;
+      //bits from an opening quote up to (not including) its closing quote
+      inString = dtl_json_index_prefix_xor(quotes) ^ prevInString;
+      prevInString = (uint64_t) 0u - (inString >> 63);
+      //a scalar starts at a byte outside of strings that is neither whitespace, operator nor quote and follows one of them
+      scalar = ~(masks.whitespace | masks.op | quotes | inString);
+      structurals = (masks.op & ~inString) | quotes | (scalar & ~( (scalar << 1) | prevScalar));
+      prevScalar = scalar >> 63;
+      while (structurals != 0u)
+      {
+         self->positions[self->count++] = (uint32_t) offset + dtl_json_index_ctz64(structurals);
+         structurals &= structurals - 1u;
+      }
+      offset += DTL_JSON_INDEX_BLOCK_SIZE;
+   }
+   if (prevInString != 0u)
+   {
+      return DTL_JSON_UNMATCHED_STRING_LITERAL;
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static classifyFunc_t *dtl_json_index_select_classify(dtl_json_simd_t simdLevel)
+{
+   switch(simdLevel)
+   {
+#ifdef DTL_JSON_INDEX_HAS_AVX2
+   case DTL_JSON_SIMD_AVX2:
+      return dtl_json_index_classify_avx2;
+#endif
+#ifdef DTL_JSON_INDEX_HAS_SSE2
+   case DTL_JSON_SIMD_SSE2:
+      return dtl_json_index_classify_sse2;
+#endif
+   default:
+      break;
+   }
+   return dtl_json_index_classify_scalar;
+}
+
+static void dtl_json_index_classify_scalar(const uint8_t *pBlock, dtl_json_blockMasks_t *masks)
+{
+   int i;
+   masks->backslash = 0u;
+   masks->quote = 0u;
+   masks->op = 0u;
+   masks->whitespace = 0u;
+   for (i = 0; i < DTL_JSON_INDEX_BLOCK_SIZE; i++)
+   {
+      uint64_t bit = UINT64_C(1) << i;
+      switch(pBlock[i])
+      {
+      case '\\':
+         masks->backslash |= bit;
+         break;
+      case '"':
+         masks->quote |= bit;
+         break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+         masks->op |= bit;
+         break;
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+         masks->whitespace |= bit;
+         break;
+      default:
+         break;
+      }
+   }
+}
+
+#ifdef DTL_JSON_INDEX_HAS_SSE2
+static void dtl_json_index_classify_sse2(const uint8_t *pBlock, dtl_json_blockMasks_t *masks)
+{
+   const __m128i backslash = _mm_set1_epi8('\\');
+   const __m128i quote = _mm_set1_epi8('"');
+   const __m128i space = _mm_set1_epi8(' ');
+   const __m128i tab = _mm_set1_epi8('\t');
+   const __m128i newLine = _mm_set1_epi8('\n');
+   const __m128i carriageReturn = _mm_set1_epi8('\r');
+   const __m128i comma = _mm_set1_epi8(',');
+   const __m128i colon = _mm_set1_epi8(':');
+   //setting bit 5 (0x20) maps '[' to '{' and ']' to '}'
+   const __m128i bracketBit = _mm_set1_epi8(0x20);
+   const __m128i openBracket = _mm_set1_epi8('{');
+   const __m128i closeBracket = _mm_set1_epi8('}');
+   int i;
+   masks->backslash = 0u;
+   masks->quote = 0u;
+   masks->op = 0u;
+   masks->whitespace = 0u;
+   for (i = 0; i < DTL_JSON_INDEX_BLOCK_SIZE; i += 16)
+   {
+      __m128i chunk = _mm_loadu_si128((const __m128i*) (pBlock + i));
+      __m128i folded = _mm_or_si128(chunk, bracketBit);
+      __m128i isOp = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, openBracket), _mm_cmpeq_epi8(folded, closeBracket)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(chunk, comma), _mm_cmpeq_epi8(chunk, colon)));
+      __m128i isWhitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, newLine), _mm_cmpeq_epi8(chunk, carriageReturn)));
+      masks->backslash |= ( (uint64_t) (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)) ) << i;
+      masks->quote |= ( (uint64_t) (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)) ) << i;
+      masks->op |= ( (uint64_t) (uint32_t) _mm_movemask_epi8(isOp) ) << i;
+      masks->whitespace |= ( (uint64_t) (uint32_t) _mm_movemask_epi8(isWhitespace) ) << i;
+   }
+}
+#endif
+
+#ifdef DTL_JSON_INDEX_HAS_AVX2
+__attribute__((target("avx2")))
+static void dtl_json_index_classify_avx2(const uint8_t *pBlock, dtl_json_blockMasks_t *masks)
+{
+   const __m256i backslash = _mm256_set1_epi8('\\');
+   const __m256i quote = _mm256_set1_epi8('"');
+   const __m256i space = _mm256_set1_epi8(' ');
+   const __m256i tab = _mm256_set1_epi8('\t');
+   const __m256i newLine = _mm256_set1_epi8('\n');
+   const __m256i carriageReturn = _mm256_set1_epi8('\r');
+   const __m256i comma = _mm256_set1_epi8(',');
+   const __m256i colon = _mm256_set1_epi8(':');
+   const __m256i bracketBit = _mm256_set1_epi8(0x20);
+   const __m256i openBracket = _mm256_set1_epi8('{');
+   const __m256i closeBracket = _mm256_set1_epi8('}');
+   int i;
+   masks->backslash = 0u;
+   masks->quote = 0u;
+   masks->op = 0u;
+   masks->whitespace = 0u;
+   for (i = 0; i < DTL_JSON_INDEX_BLOCK_SIZE; i += 32)
+   {
+      __m256i chunk = _mm256_loadu_si256((const __m256i*) (pBlock + i));
+      __m256i folded = _mm256_or_si256(chunk, bracketBit);
+      __m256i isOp = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, openBracket), _mm256_cmpeq_epi8(folded, closeBracket)),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(chunk, comma), _mm256_cmpeq_epi8(chunk, colon)));
+      __m256i isWhitespace = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+                                             _mm256_or_si256(_mm256_cmpeq_epi8(chunk, newLine), _mm256_cmpeq_epi8(chunk, carriageReturn)));
+      masks->backslash |= ( (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash)) ) << i;
+      masks->quote |= ( (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)) ) << i;
+      masks->op |= ( (uint64_t) (uint32_t) _mm256_movemask_epi8(isOp) ) << i;
+      masks->whitespace |= ( (uint64_t) (uint32_t) _mm256_movemask_epi8(isWhitespace) ) << i;
+   }
+}
+#endif
+
+/**
+ * Returns mask of characters preceded by an odd number of backslashes, i.e. the characters that are escaped.
+ * Runs of backslashes are found with an addition: adding the start of a run to the run carries to the first
+ * byte after it, and the parity of that position relative to the start tells whether the run length is odd.
+ * *prevEndsOddBackslash carries an unfinished run into the next block.
+ */
+static uint64_t dtl_json_index_find_escaped(uint64_t backslash, uint64_t *prevEndsOddBackslash)
+{
+   uint64_t startEdges = backslash & ~(backslash << 1);
+   uint64_t evenStartMask = INDEX_EVEN_BITS ^ *prevEndsOddBackslash;
+   uint64_t evenStarts = startEdges & evenStartMask;
+   uint64_t oddStarts = startEdges & ~evenStartMask;
+   uint64_t evenCarries = backslash + evenStarts;
+   uint64_t oddCarries = backslash + oddStarts;
+   uint64_t oddEnds;
+   bool endsOddBackslash = (oddCarries < backslash);
+   oddCarries |= *prevEndsOddBackslash;
+   *prevEndsOddBackslash = endsOddBackslash? 1u : 0u;
+   oddEnds = ( (evenCarries & ~backslash) & INDEX_ODD_BITS) | ( (oddCarries & ~backslash) & INDEX_EVEN_BITS);
+   return oddEnds;
+}
+
+/**
+ * Bit i of the result is the XOR of bits 0..i of value.
+ */
+static uint64_t dtl_json_index_prefix_xor(uint64_t value)
+{
+   value ^= value << 1;
+   value ^= value << 2;
+   value ^= value << 4;
+   value ^= value << 8;
+   value ^= value << 16;
+   value ^= value << 32;
+   return value;
+}
+
+/**
+ * Returns number of trailing zero bits. value must not be 0.
+ */
+static uint32_t dtl_json_index_ctz64(uint64_t value)
+{
+#ifdef __GNUC__
+   return (uint32_t) __builtin_ctzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+   unsigned long index;
+   _BitScanForward64(&index, value);
+   return (uint32_t) index;
+#else
+   uint32_t count = 0u;
+   while ( (value & 1u) == 0u )
+   {
+      value >>= 1;
+      count++;
+   }
+   return count;
+#endif
+}
+
+/**
+ * Makes room for at least minFree more positions.
+ * The first allocation assumes one position per four bytes, which is enough for most documents without growing.
+ */
+static bool dtl_json_index_reserve(dtl_json_index_t *self, uint32_t minFree, size_t docLen)
+{
+   if ( (self->capacity - self->count) < minFree)
+   {
+      uint32_t *positions;
+      size_t newCapacity = (self->capacity == 0u)? ( (docLen / 4u) + minFree) : ( (size_t) self->capacity * 2u);
+      if (newCapacity < ( (size_t) self->count + minFree) )
+      {
+         newCapacity = (size_t) self->count + minFree;
+      }
+      if (newCapacity > ( (size_t) UINT32_MAX / sizeof(uint32_t)) )
+      {
+         return false;
+      }
+      positions = (uint32_t*) realloc(self->positions, newCapacity * sizeof(uint32_t));
+      if (positions == 0)
+      {
+         return false;
+      }
+      self->positions = positions;
+      self->capacity = (uint32_t) newCapacity;
+   }
+   return true;
+}
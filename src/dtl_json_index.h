@@ -0,0 +1,62 @@
+/*****************************************************************************
+* \file      dtl_json_index.h
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Structural index of a JSON buffer (stage 1 of the indexed reader)
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef DTL_JSON_INDEX_H
+#define DTL_JSON_INDEX_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include "dtl_json.h"
+#include "dtl_json_scan.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define DTL_JSON_INDEX_BLOCK_SIZE 64
+
+/**
+ * Offsets of all structural characters in a JSON buffer, in document order.
+ * Recorded are the characters {}[]:, outside of strings, every unescaped quote (both opening and closing)
+ * and the first character of each scalar (number, true, false, null or any other stray character).
+ * Whitespace and string content are never recorded, which lets the parser step from token to token.
+ */
+typedef struct dtl_json_index_tag
+{
+   uint32_t *positions;
+   uint32_t count;
+   uint32_t capacity;
+} dtl_json_index_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+void dtl_json_index_create(dtl_json_index_t *self);
+void dtl_json_index_destroy(dtl_json_index_t *self);
+dtl_json_error_t dtl_json_index_build(dtl_json_index_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+dtl_json_error_t dtl_json_index_build_with(dtl_json_index_t *self, const uint8_t *pBegin, const uint8_t *pEnd, dtl_json_simd_t simdLevel);
+
+#endif //DTL_JSON_INDEX_H
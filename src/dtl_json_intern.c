@@ -0,0 +1,298 @@
+/*****************************************************************************
+* \file      dtl_json_intern.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     String intern table for object keys
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "dtl_json_intern.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define INTERN_INITIAL_CAPACITY 64u
+#define INTERN_BLOCK_SIZE 4096u
+
+typedef struct dtl_json_internBlock_tag
+{
+   struct dtl_json_internBlock_tag *next;
+} dtl_json_internBlock_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static uint32_t dtl_json_intern_hash(const uint8_t *pBegin, const uint8_t *pEnd);
+static int dtl_json_intern_grow(dtl_json_intern_t *self);
+static char *dtl_json_intern_store(dtl_json_intern_t *self, const uint8_t *pBegin, uint32_t length);
+static void dtl_json_intern_free_blocks(dtl_json_internBlock_t *block);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+void dtl_json_intern_create(dtl_json_intern_t *self, uint32_t maxCount)
+{
+   if (self != 0)
+   {
+      self->pBlocks = (dtl_json_internBlock_t*) 0;
+      self->pNext = (char*) 0;
+      self->pEnd = (char*) 0;
+      self->entries = (dtl_json_internEntry_t*) 0;
+      self->capacity = 0u;
+      self->count = 0u;
+      self->maxCount = maxCount;
+   }
+}
+
+void dtl_json_intern_destroy(dtl_json_intern_t *self)
+{
+   if (self != 0)
+   {
+      if (self->entries != 0)
+      {
+         free(self->entries);
+         self->entries = (dtl_json_internEntry_t*) 0;
+      }
+      self->capacity = 0u;
+      self->count = 0u;
+      dtl_json_intern_free_blocks(self->pBlocks);
+      self->pBlocks = (dtl_json_internBlock_t*) 0;
+      self->pNext = (char*) 0;
+      self->pEnd = (char*) 0;
+   }
+}
+
+dtl_json_intern_t *dtl_json_intern_new(uint32_t maxCount)
+{
+   dtl_json_intern_t *self = (dtl_json_intern_t*) malloc(sizeof(dtl_json_intern_t));
+   if (self != 0)
+   {
+      dtl_json_intern_create(self, maxCount);
+   }
+   return self;
+}
+
+void dtl_json_intern_delete(dtl_json_intern_t *self)
+{
+   if (self != 0)
+   {
+      dtl_json_intern_destroy(self);
+      free(self);
+   }
+}
+
+/**
+ * Returns the interned copy of the string in [pBegin, pEnd).
+ * Returns NULL on allocation failure or if the string is new and the table already holds maxCount strings.
+ */
+const char *dtl_json_intern_bstr(dtl_json_intern_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   uint32_t hash;
+   uint32_t length;
+   uint32_t i;
+   char *str;
+   if ( (self == 0) || (pBegin == 0) || (pEnd < pBegin) )
+   {
+      return (const char*) 0;
+   }
+   length = (uint32_t) (pEnd - pBegin);
+   hash = dtl_json_intern_hash(pBegin, pEnd);
+   if (self->capacity > 0u)
+   {
+      for (i = hash & (self->capacity - 1u); self->entries[i].str != 0; i = (i + 1u) & (self->capacity - 1u))
+      {
+         dtl_json_internEntry_t *entry = &self->entries[i];
+         if ( (entry->hash == hash) && (entry->length == length) && (memcmp(entry->str, pBegin, length) == 0) )
+         {
+            return entry->str;
+         }
+      }
+   }
+   if ( (self->maxCount != 0u) && (self->count >= self->maxCount) )
+   {
+      return (const char*) 0;
+   }
+   if ( ((self->count + 1u) * 4u > self->capacity * 3u) && (dtl_json_intern_grow(self) != 0) )
+   {
+      return (const char*) 0;
+   }
+   str = dtl_json_intern_store(self, pBegin, length);
+   if (str == 0)
+   {
+      return (const char*) 0;
+   }
+   for (i = hash & (self->capacity - 1u); self->entries[i].str != 0; i = (i + 1u) & (self->capacity - 1u))
+   {
+   }
+   self->entries[i].hash = hash;
+   self->entries[i].length = length;
+   self->entries[i].str = str;
+   self->count++;
+   return str;
+}
+
+const char *dtl_json_intern_cstr(dtl_json_intern_t *self, const char *cstr)
+{
+   if (cstr == 0)
+   {
+      return (const char*) 0;
+   }
+   return dtl_json_intern_bstr(self, (const uint8_t*) cstr, (const uint8_t*) cstr + strlen(cstr));
+}
+
+uint32_t dtl_json_intern_length(const dtl_json_intern_t *self)
+{
+   if (self != 0)
+   {
+      return self->count;
+   }
+   return 0u;
+}
+
+/**
+ * Removes all strings. Previously returned pointers become invalid.
+ */
+void dtl_json_intern_clear(dtl_json_intern_t *self)
+{
+   if (self != 0)
+   {
+      if (self->entries != 0)
+      {
+         memset(self->entries, 0, sizeof(dtl_json_internEntry_t) * self->capacity);
+      }
+      self->count = 0u;
+      if (self->pBlocks != 0)
+      {
+         //keep the most recent block for reuse
+         dtl_json_intern_free_blocks(self->pBlocks->next);
+         self->pBlocks->next = (dtl_json_internBlock_t*) 0;
+         self->pNext = (char*) (self->pBlocks + 1);
+         self->pEnd = self->pNext + INTERN_BLOCK_SIZE;
+      }
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * FNV-1a
+ */
+static uint32_t dtl_json_intern_hash(const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   uint32_t hash = 2166136261u;
+   const uint8_t *pNext;
+   for (pNext = pBegin; pNext < pEnd; pNext++)
+   {
+      hash ^= (uint32_t) *pNext;
+      hash *= 16777619u;
+   }
+   return hash;
+}
+
+/**
+ * Doubles the table capacity. Returns 0 on success, -1 on allocation failure.
+ */
+static int dtl_json_intern_grow(dtl_json_intern_t *self)
+{
+   uint32_t newCapacity = (self->capacity == 0u)? INTERN_INITIAL_CAPACITY : (self->capacity * 2u);
+   uint32_t i;
+   dtl_json_internEntry_t *entries = (dtl_json_internEntry_t*) calloc(newCapacity, sizeof(dtl_json_internEntry_t));
+   if (entries == 0)
+   {
+      return -1;
+   }
+   for (i = 0u; i < self->capacity; i++)
+   {
+      if (self->entries[i].str != 0)
+      {
+         uint32_t j;
+         for (j = self->entries[i].hash & (newCapacity - 1u); entries[j].str != 0; j = (j + 1u) & (newCapacity - 1u))
+         {
+         }
+         entries[j] = self->entries[i];
+      }
+   }
+   if (self->entries != 0)
+   {
+      free(self->entries);
+   }
+   self->entries = entries;
+   self->capacity = newCapacity;
+   return 0;
+}
+
+/**
+ * Copies the string into the current block and null-terminates it. Strings are never freed one by one,
+ * only all at once by dtl_json_intern_clear or dtl_json_intern_destroy.
+ * Strings longer than a quarter of a block get a block of their own so that the current block is not abandoned.
+ */
+static char *dtl_json_intern_store(dtl_json_intern_t *self, const uint8_t *pBegin, uint32_t length)
+{
+   char *str;
+   size_t size = (size_t) length + 1u;
+   if (size > (size_t) (self->pEnd - self->pNext))
+   {
+      bool isDedicated = (size > (INTERN_BLOCK_SIZE / 4u)) && (self->pBlocks != 0);
+      dtl_json_internBlock_t *block = (dtl_json_internBlock_t*) malloc(sizeof(dtl_json_internBlock_t) + (isDedicated? size : INTERN_BLOCK_SIZE));
+      if (block == 0)
+      {
+         return (char*) 0;
+      }
+      if (isDedicated)
+      {
+         block->next = self->pBlocks->next;
+         self->pBlocks->next = block;
+         str = (char*) (block + 1);
+         memcpy(str, pBegin, length);
+         str[length] = '\0';
+         return str;
+      }
+      block->next = self->pBlocks;
+      self->pBlocks = block;
+      self->pNext = (char*) (block + 1);
+      self->pEnd = self->pNext + INTERN_BLOCK_SIZE;
+   }
+   str = self->pNext;
+   memcpy(str, pBegin, length);
+   str[length] = '\0';
+   self->pNext += size;
+   return str;
+}
+
+static void dtl_json_intern_free_blocks(dtl_json_internBlock_t *block)
+{
+   while (block != 0)
+   {
+      dtl_json_internBlock_t *next = block->next;
+      free(block);
+      block = next;
+   }
+}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+* \file      dtl_json_intern.h
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     String intern table for object keys
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef DTL_JSON_INTERN_H
+#define DTL_JSON_INTERN_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include "dtl_json.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+struct dtl_json_internBlock_tag;
+
+typedef struct dtl_json_internEntry_tag
+{
+   uint32_t hash;
+   uint32_t length;
+   const char *str; //NULL for unused slot
+} dtl_json_internEntry_t;
+
+/**
+ * Stores each distinct string once. Interned strings are null-terminated, immutable and remain valid until the table is cleared or destroyed.
+ * The table is not thread-safe, a table shared between parsers must only be used by one thread at a time.
+ */
+struct dtl_json_intern_tag
+{
+   struct dtl_json_internBlock_tag *pBlocks; //string storage, most recently allocated block first
+   char *pNext;
+   char *pEnd;
+   dtl_json_internEntry_t *entries; //open addressing with linear probing
+   uint32_t capacity; //always a power of 2
+   uint32_t count;
+   uint32_t maxCount; //0 means no limit
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+void dtl_json_intern_create(dtl_json_intern_t *self, uint32_t maxCount);
+void dtl_json_intern_destroy(dtl_json_intern_t *self);
+const char *dtl_json_intern_bstr(dtl_json_intern_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+const char *dtl_json_intern_cstr(dtl_json_intern_t *self, const char *cstr);
+
+#endif //DTL_JSON_INTERN_H
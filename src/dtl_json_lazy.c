@@ -0,0 +1,610 @@
+/*****************************************************************************
+* \file      dtl_json_lazy.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     On-demand access to JSON documents through a structural index
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bstr.h"
+#include "dtl_json.h"
+#include "dtl_json_index.h"
+#include "dtl_json_number.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+typedef uint8_t lazyState_t;
+
+#define LAZY_STATE_VALUE         ((lazyState_t) 0u) //expects a value
+#define LAZY_STATE_ARRAY_FIRST   ((lazyState_t) 1u) //expects first array element or ']'
+#define LAZY_STATE_OBJECT_FIRST  ((lazyState_t) 2u) //expects first object key or '}'
+#define LAZY_STATE_KEY           ((lazyState_t) 3u) //expects object key followed by ':'
+#define LAZY_STATE_NEXT          ((lazyState_t) 4u) //expects ',' or end of container
+
+struct dtl_json_lazy_tag
+{
+   const uint8_t *pBegin;
+   const uint8_t *pEnd;
+   dtl_json_index_t index;
+   adt_str_t tmpStr; //holds unescaped strings
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static bool dtl_json_lazy_validate(const dtl_json_lazy_t *self);
+static uint8_t dtl_json_lazy_char_at(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node);
+static dtl_json_lazy_node_t dtl_json_lazy_skip(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node);
+static const uint8_t *dtl_json_lazy_scalar_end(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node);
+static bool dtl_json_lazy_parse_number(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, dtl_json_number_t *number);
+static dtl_json_error_t dtl_json_lazy_string_at(dtl_json_lazy_t *self, dtl_json_lazy_node_t node, const char **ppStr, uint32_t *pStrLen);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Indexes the document without creating any values. The buffer must remain valid until dtl_json_lazy_delete is called.
+ * Brackets, separators and key positions are checked here; numbers, literals and escape sequences are checked when accessed.
+ * Returns NULL if the document is malformed or memory could not be allocated.
+ */
+dtl_json_lazy_t* dtl_json_load_lazy(const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   dtl_json_lazy_t *self;
+   if ( (pBegin == 0) || (pEnd < pBegin) )
+   {
+      return (dtl_json_lazy_t*) 0;
+   }
+   self = (dtl_json_lazy_t*) malloc(sizeof(dtl_json_lazy_t));
+   if (self != 0)
+   {
+      self->pBegin = pBegin;
+      self->pEnd = pEnd;
+      dtl_json_index_create(&self->index);
+      adt_str_create(&self->tmpStr);
+      if ( (dtl_json_index_build(&self->index, pBegin, pEnd) != DTL_JSON_NO_ERROR) || (!dtl_json_lazy_validate(self)) )
+      {
+         dtl_json_lazy_delete(self);
+         self = (dtl_json_lazy_t*) 0;
+      }
+   }
+   return self;
+}
+
+void dtl_json_lazy_delete(dtl_json_lazy_t *self)
+{
+   if (self != 0)
+   {
+      dtl_json_index_destroy(&self->index);
+      adt_str_destroy(&self->tmpStr);
+      free(self);
+   }
+}
+
+dtl_json_lazy_node_t dtl_json_lazy_root(const dtl_json_lazy_t *self)
+{
+   return (self != 0)? 0u : DTL_JSON_LAZY_NONE;
+}
+
+/**
+ * Returns DTL_JSON_TOKEN_BEGIN_OBJECT, DTL_JSON_TOKEN_BEGIN_ARRAY, DTL_JSON_TOKEN_STRING, DTL_JSON_TOKEN_NUMBER,
+ * DTL_JSON_TOKEN_TRUE, DTL_JSON_TOKEN_FALSE or DTL_JSON_TOKEN_NULL.
+ * Returns DTL_JSON_TOKEN_ERROR for DTL_JSON_LAZY_NONE and for misspelled literals.
+ */
+dtl_json_token_t dtl_json_lazy_type(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node)
+{
+   const uint8_t *pToken;
+   const uint8_t *pTokenEnd;
+   if ( (self == 0) || (node >= self->index.count) )
+   {
+      return DTL_JSON_TOKEN_ERROR;
+   }
+   pToken = self->pBegin + self->index.positions[node];
+   switch(*pToken)
+   {
+   case '{':
+      return DTL_JSON_TOKEN_BEGIN_OBJECT;
+   case '[':
+      return DTL_JSON_TOKEN_BEGIN_ARRAY;
+   case '"':
+      return DTL_JSON_TOKEN_STRING;
+   default:
+      break;
+   }
+   if (bstr_pred_is_digit((int) *pToken) || (*pToken == '-') )
+   {
+      return DTL_JSON_TOKEN_NUMBER;
+   }
+   pTokenEnd = dtl_json_lazy_scalar_end(self, node);
+   if (bstr_match_cstr(pToken, pTokenEnd, "true") == pTokenEnd)
+   {
+      return DTL_JSON_TOKEN_TRUE;
+   }
+   else if (bstr_match_cstr(pToken, pTokenEnd, "false") == pTokenEnd)
+   {
+      return DTL_JSON_TOKEN_FALSE;
+   }
+   else if (bstr_match_cstr(pToken, pTokenEnd, "null") == pTokenEnd)
+   {
+      return DTL_JSON_TOKEN_NULL;
+   }
+   return DTL_JSON_TOKEN_ERROR;
+}
+
+/**
+ * Returns the value stored under key in the object node, or DTL_JSON_LAZY_NONE if there is no such key.
+ * Members before the match are stepped over without being decoded.
+ */
+dtl_json_lazy_node_t dtl_json_lazy_get(dtl_json_lazy_t *self, dtl_json_lazy_node_t node, const char *key)
+{
+   dtl_json_lazy_node_t member;
+   size_t keyLen;
+   if ( (key == 0) || (dtl_json_lazy_type(self, node) != DTL_JSON_TOKEN_BEGIN_OBJECT) )
+   {
+      return DTL_JSON_LAZY_NONE;
+   }
+   keyLen = strlen(key);
+   for (member = dtl_json_lazy_first(self, node); member != DTL_JSON_LAZY_NONE; member = dtl_json_lazy_next(self, member))
+   {
+      const char *pKey = (const char*) 0;
+      uint32_t len = 0u;
+      if ( (dtl_json_lazy_get_key(self, member, &pKey, &len) == DTL_JSON_NO_ERROR) &&
+           ( (size_t) len == keyLen) && (memcmp(pKey, key, keyLen) == 0) )
+      {
+         return member;
+      }
+   }
+   return DTL_JSON_LAZY_NONE;
+}
+
+/**
+ * Returns element at position index of the array node, or DTL_JSON_LAZY_NONE if the array is shorter.
+ */
+dtl_json_lazy_node_t dtl_json_lazy_at(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, uint32_t index)
+{
+   dtl_json_lazy_node_t element;
+   if (dtl_json_lazy_type(self, node) != DTL_JSON_TOKEN_BEGIN_ARRAY)
+   {
+      return DTL_JSON_LAZY_NONE;
+   }
+   element = dtl_json_lazy_first(self, node);
+   while ( (element != DTL_JSON_LAZY_NONE) && (index > 0u) )
+   {
+      element = dtl_json_lazy_next(self, element);
+      index--;
+   }
+   return element;
+}
+
+/**
+ * Returns first element of an array or value of the first member of an object.
+ * Returns DTL_JSON_LAZY_NONE for empty containers and for scalars.
+ */
+dtl_json_lazy_node_t dtl_json_lazy_first(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node)
+{
+   dtl_json_token_t type = dtl_json_lazy_type(self, node);
+   if ( (type == DTL_JSON_TOKEN_BEGIN_ARRAY) && (dtl_json_lazy_char_at(self, node + 1u) != ']') )
+   {
+      return node + 1u;
+   }
+   else if ( (type == DTL_JSON_TOKEN_BEGIN_OBJECT) && (dtl_json_lazy_char_at(self, node + 1u) != '}') )
+   {
+      //skip key (opening and closing quote) and ':'
+      return node + 4u;
+   }
+   return DTL_JSON_LAZY_NONE;
+}
+
+/**
+ * Returns the array element or object member value following node, or DTL_JSON_LAZY_NONE when node is the last one.
+ */
+dtl_json_lazy_node_t dtl_json_lazy_next(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node)
+{
+   dtl_json_lazy_node_t next;
+   if ( (self == 0) || (node == 0u) || (node >= self->index.count) )
+   {
+      return DTL_JSON_LAZY_NONE;
+   }
+   next = dtl_json_lazy_skip(self, node);
+   if (dtl_json_lazy_char_at(self, next) != ',')
+   {
+      return DTL_JSON_LAZY_NONE;
+   }
+   //object member values are always preceded by ':'
+   return (dtl_json_lazy_char_at(self, node - 1u) == ':')? next + 4u : next + 1u;
+}
+
+/**
+ * Returns number of elements in array or members in object. Returns -1 if node is not a container.
+ */
+int32_t dtl_json_lazy_length(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node)
+{
+   int32_t retval = 0;
+   dtl_json_lazy_node_t child;
+   dtl_json_token_t type = dtl_json_lazy_type(self, node);
+   if ( (type != DTL_JSON_TOKEN_BEGIN_ARRAY) && (type != DTL_JSON_TOKEN_BEGIN_OBJECT) )
+   {
+      return -1;
+   }
+   for (child = dtl_json_lazy_first(self, node); child != DTL_JSON_LAZY_NONE; child = dtl_json_lazy_next(self, child))
+   {
+      retval++;
+   }
+   return retval;
+}
+
+/**
+ * Returns the key of an object member, node being the member value as returned by dtl_json_lazy_first or dtl_json_lazy_next.
+ * Keys with escape sequences are unescaped into an internal buffer which is valid until the next call that decodes a string.
+ */
+dtl_json_error_t dtl_json_lazy_get_key(dtl_json_lazy_t *self, dtl_json_lazy_node_t node, const char **ppKey, uint32_t *pKeyLen)
+{
+   if ( (self == 0) || (ppKey == 0) || (pKeyLen == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if ( (node < 4u) || (node >= self->index.count) ||
+        (dtl_json_lazy_char_at(self, node - 1u) != ':') )
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   return dtl_json_lazy_string_at(self, node - 3u, ppKey, pKeyLen);
+}
+
+dtl_json_error_t dtl_json_lazy_get_i64(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, int64_t *value)
+{
+   dtl_json_number_t number;
+   if (value == 0)
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if ( (!dtl_json_lazy_parse_number(self, node, &number)) || (!dtl_json_number_to_i64(&number, value)) )
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+dtl_json_error_t dtl_json_lazy_get_u64(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, uint64_t *value)
+{
+   dtl_json_number_t number;
+   if (value == 0)
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if ( (!dtl_json_lazy_parse_number(self, node, &number)) || (!dtl_json_number_to_u64(&number, value)) )
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+dtl_json_error_t dtl_json_lazy_get_double(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, double *value)
+{
+   dtl_json_number_t number;
+   if (value == 0)
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if (!dtl_json_lazy_parse_number(self, node, &number))
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   *value = dtl_json_number_to_double(&number);
+   return DTL_JSON_NO_ERROR;
+}
+
+dtl_json_error_t dtl_json_lazy_get_bool(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, bool *value)
+{
+   dtl_json_token_t type = dtl_json_lazy_type(self, node);
+   if (value == 0)
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if ( (type != DTL_JSON_TOKEN_TRUE) && (type != DTL_JSON_TOKEN_FALSE) )
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   *value = (type == DTL_JSON_TOKEN_TRUE);
+   return DTL_JSON_NO_ERROR;
+}
+
+/**
+ * Returns content of a string value as a (pointer, length) slice.
+ * Strings without escape sequences point directly into the input buffer.
+ * Other strings are unescaped into an internal buffer which is valid until the next call that decodes a string.
+ */
+dtl_json_error_t dtl_json_lazy_get_string_slice(dtl_json_lazy_t *self, dtl_json_lazy_node_t node, const char **ppStr, uint32_t *pStrLen)
+{
+   if ( (ppStr == 0) || (pStrLen == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if (dtl_json_lazy_type(self, node) != DTL_JSON_TOKEN_STRING)
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   return dtl_json_lazy_string_at(self, node, ppStr, pStrLen);
+}
+
+/**
+ * Materializes node and everything below it as a dtl value. The caller is responsible for calling dtl_dec_ref on the returned value.
+ * Every call creates a new value.
+ */
+dtl_dv_t* dtl_json_lazy_value(dtl_json_lazy_t *self, dtl_json_lazy_node_t node)
+{
+   const uint8_t *pValueBegin;
+   const uint8_t *pValueEnd;
+   if ( (self == 0) || (node >= self->index.count) )
+   {
+      return (dtl_dv_t*) 0;
+   }
+   pValueBegin = self->pBegin + self->index.positions[node];
+   switch(*pValueBegin)
+   {
+   case '{':
+   case '[':
+   case '"':
+      pValueEnd = self->pBegin + self->index.positions[dtl_json_lazy_skip(self, node) - 1u] + 1;
+      break;
+   default:
+      pValueEnd = dtl_json_lazy_scalar_end(self, node);
+   }
+   return dtl_json_load_bstr(pValueBegin, pValueEnd);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Checks that the tokens form exactly one JSON value, tracking the open containers in a bit stack.
+ * After this has passed, navigation can rely on matched brackets and on keys being followed by ':'.
+ */
+static bool dtl_json_lazy_validate(const dtl_json_lazy_t *self)
+{
+   uint8_t fixedStack[64];
+   uint8_t *containerStack = fixedStack; //one bit per nesting level, set for objects
+   size_t stackCapacity = sizeof(fixedStack) * 8u;
+   size_t depth = 0u;
+   lazyState_t state = LAZY_STATE_VALUE;
+   uint32_t i = 0u;
+   bool isValid = false;
+   while (i < self->index.count)
+   {
+      uint8_t c = dtl_json_lazy_char_at(self, i);
+      bool isObject = (depth > 0u) && ( (containerStack[(depth - 1u) / 8u] & (1u << ( (depth - 1u) % 8u))) != 0u);
+      if ( (state == LAZY_STATE_NEXT) && (depth == 0u) )
+      {
+         //trailing tokens after top-level value
+         break;
+      }
+      if ( (state == LAZY_STATE_ARRAY_FIRST) && (c == ']') )
+      {
+         state = LAZY_STATE_NEXT;
+         depth--;
+         i++;
+         continue;
+      }
+      else if ( (state == LAZY_STATE_OBJECT_FIRST) && (c == '}') )
+      {
+         state = LAZY_STATE_NEXT;
+         depth--;
+         i++;
+         continue;
+      }
+      else if (state == LAZY_STATE_ARRAY_FIRST)
+      {
+         state = LAZY_STATE_VALUE;
+      }
+      else if (state == LAZY_STATE_OBJECT_FIRST)
+      {
+         state = LAZY_STATE_KEY;
+      }
+      if (state == LAZY_STATE_VALUE)
+      {
+         if ( (c == '[') || (c == '{') )
+         {
+            if (depth == stackCapacity)
+            {
+               uint8_t *newStack = (uint8_t*) malloc(stackCapacity / 4u);
+               if (newStack == 0)
+               {
+                  break;
+               }
+               memcpy(newStack, containerStack, stackCapacity / 8u);
+               if (containerStack != fixedStack)
+               {
+                  free(containerStack);
+               }
+               containerStack = newStack;
+               stackCapacity *= 2u;
+            }
+            if (c == '{')
+            {
+               containerStack[depth / 8u] |= (uint8_t) (1u << (depth % 8u));
+               state = LAZY_STATE_OBJECT_FIRST;
+            }
+            else
+            {
+               containerStack[depth / 8u] &= (uint8_t) ~(1u << (depth % 8u));
+               state = LAZY_STATE_ARRAY_FIRST;
+            }
+            depth++;
+            i++;
+         }
+         else if (c == '"')
+         {
+            //closing quote is always present in a successfully built index
+            state = LAZY_STATE_NEXT;
+            i += 2u;
+         }
+         else if ( (c == ']') || (c == '}') || (c == ',') || (c == ':') )
+         {
+            break;
+         }
+         else
+         {
+            state = LAZY_STATE_NEXT;
+            i++;
+         }
+      }
+      else if (state == LAZY_STATE_KEY)
+      {
+         if ( (c != '"') || (dtl_json_lazy_char_at(self, i + 2u) != ':') )
+         {
+            break;
+         }
+         state = LAZY_STATE_VALUE;
+         i += 3u;
+      }
+      else if (c == ',')
+      {
+         state = isObject? LAZY_STATE_KEY : LAZY_STATE_VALUE;
+         i++;
+      }
+      else if ( (c == (isObject? '}' : ']')) )
+      {
+         depth--;
+         i++;
+      }
+      else
+      {
+         break;
+      }
+   }
+   if ( (i == self->index.count) && (state == LAZY_STATE_NEXT) && (depth == 0u) )
+   {
+      isValid = true;
+   }
+   if (containerStack != fixedStack)
+   {
+      free(containerStack);
+   }
+   return isValid;
+}
+
+/**
+ * Returns first character of token, or 0 when node is outside of the index.
+ */
+static uint8_t dtl_json_lazy_char_at(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node)
+{
+   return (node < self->index.count)? self->pBegin[self->index.positions[node]] : 0u;
+}
+
+/**
+ * Returns the token following the value at node. Containers are stepped over by counting brackets in the index
+ * without looking at any of the values inside.
+ */
+static dtl_json_lazy_node_t dtl_json_lazy_skip(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node)
+{
+   uint8_t c = dtl_json_lazy_char_at(self, node);
+   if (c == '"')
+   {
+      return node + 2u;
+   }
+   else if ( (c == '[') || (c == '{') )
+   {
+      uint32_t level = 1u;
+      const uint32_t *positions = self->index.positions;
+      dtl_json_lazy_node_t next = node + 1u;
+      while (next < self->index.count)
+      {
+         c = self->pBegin[positions[next++]];
+         if (c == '"')
+         {
+            next++;
+         }
+         else if ( (c == '[') || (c == '{') )
+         {
+            level++;
+         }
+         else if ( ( (c == ']') || (c == '}') ) && (--level == 0u) )
+         {
+            break;
+         }
+      }
+      return next;
+   }
+   return node + 1u;
+}
+
+/**
+ * Returns end of the scalar at node, excluding any trailing whitespace.
+ */
+static const uint8_t *dtl_json_lazy_scalar_end(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node)
+{
+   const uint8_t *pToken = self->pBegin + self->index.positions[node];
+   const uint8_t *pTokenEnd = (node + 1u < self->index.count)? self->pBegin + self->index.positions[node + 1u] : self->pEnd;
+   while ( (pTokenEnd > pToken) &&
+           ( (pTokenEnd[-1] == ' ') || (pTokenEnd[-1] == '\n') || (pTokenEnd[-1] == '\r') || (pTokenEnd[-1] == '\t') ) )
+   {
+      pTokenEnd--;
+   }
+   return pTokenEnd;
+}
+
+static bool dtl_json_lazy_parse_number(const dtl_json_lazy_t *self, dtl_json_lazy_node_t node, dtl_json_number_t *number)
+{
+   const uint8_t *pTokenEnd;
+   if (dtl_json_lazy_type(self, node) != DTL_JSON_TOKEN_NUMBER)
+   {
+      return false;
+   }
+   pTokenEnd = dtl_json_lazy_scalar_end(self, node);
+   return (dtl_json_number_parse(self->pBegin + self->index.positions[node], pTokenEnd, number) == pTokenEnd);
+}
+
+static dtl_json_error_t dtl_json_lazy_string_at(dtl_json_lazy_t *self, dtl_json_lazy_node_t node, const char **ppStr, uint32_t *pStrLen)
+{
+   const uint8_t *pToken = self->pBegin + self->index.positions[node];
+   const uint8_t *pTokenEnd = self->pBegin + self->index.positions[node + 1u] + 1;
+   const uint8_t *pContentBegin = pToken + 1;
+   const uint8_t *pContentEnd = pTokenEnd - 1;
+   assert(node + 1u < self->index.count);
+   if (memchr(pContentBegin, '\\', (size_t) (pContentEnd - pContentBegin)) == 0)
+   {
+      *ppStr = (const char*) pContentBegin;
+      *pStrLen = (uint32_t) (pContentEnd - pContentBegin);
+   }
+   else
+   {
+      bstr_context_t ctx;
+      bstr_context_create(&ctx);
+      adt_str_clear(&self->tmpStr);
+      if (bstr_parse_json_string_literal(&ctx, pToken, pTokenEnd, &self->tmpStr) != pTokenEnd)
+      {
+         return DTL_JSON_UNMATCHED_STRING_LITERAL;
+      }
+      *ppStr = adt_str_cstr(&self->tmpStr);
+      *pStrLen = (uint32_t) adt_str_size(&self->tmpStr); //byte size, may contain \u0000
+   }
+   return DTL_JSON_NO_ERROR;
+}
@@ -0,0 +1,67 @@
+/*****************************************************************************
+* \file      dtl_json_number.h
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     JSON number lexer and correctly rounded decimal to binary conversion
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef DTL_JSON_NUMBER_H
+#define DTL_JSON_NUMBER_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define DTL_JSON_NUMBER_MAX_MANTISSA_DIGITS 19
+#define DTL_JSON_NUMBER_FORMAT_BUF_SIZE     32 //enough for "%.17g" of any double
+
+/**
+ * Decimal representation of a JSON number: value = mantissa * 10^exponent.
+ * Leading zeros are not counted. Significant digits are accumulated while the mantissa fits in 64 bits (19 or 20 digits),
+ * the remaining digits are dropped and recorded in isTruncated.
+ * Every integer in range [-UINT64_MAX, UINT64_MAX] is therefore stored exactly, with exponent 0.
+ */
+typedef struct dtl_json_number_tag
+{
+   const uint8_t *pBegin; //first character of number text
+   const uint8_t *pEnd; //one past last character of number text
+   uint64_t mantissa;
+   int32_t exponent;
+   bool isNegative;
+   bool isInteger; //true when the text has neither fraction nor exponent part
+   bool isTruncated; //true when non-zero digits were dropped from mantissa
+} dtl_json_number_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+const uint8_t *dtl_json_number_parse(const uint8_t *pBegin, const uint8_t *pEnd, dtl_json_number_t *number);
+double dtl_json_number_to_double(const dtl_json_number_t *number);
+bool dtl_json_number_to_i64(const dtl_json_number_t *number, int64_t *value);
+bool dtl_json_number_to_u64(const dtl_json_number_t *number, uint64_t *value);
+int32_t dtl_json_number_format_double(double value, char *buf, uint32_t bufSize);
+
+#endif //DTL_JSON_NUMBER_H
@@ -0,0 +1,760 @@
+/*****************************************************************************
+* \file      dtl_json_pointer.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     JSON Pointer (RFC 6901) extraction and projection
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include "dtl_json.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define PROJECTION_NODE_NONE  UINT32_MAX
+#define PROJECTION_NO_INDEX   UINT32_MAX
+
+/**
+ * The paths of a projection are stored as a tree of reference tokens (a trie), node 0 is the document root.
+ */
+typedef struct dtl_json_projection_node_tag
+{
+   char *token;            //decoded reference token, NULL for the root
+   uint32_t tokenLen;
+   uint32_t index;         //token as array index or PROJECTION_NO_INDEX
+   uint32_t firstChild;
+   uint32_t nextSibling;
+   bool isWildcard;        //token is "*"
+   bool isSelected;        //a path ends here, the entire value is kept
+} dtl_json_projection_node_t;
+
+struct dtl_json_projection_tag
+{
+   dtl_json_projection_node_t *nodes;
+   uint32_t numNodes;
+   uint32_t capacity;
+   uint32_t numPaths;
+   uint32_t maxDepth;      //number of reference tokens in the longest path
+};
+
+typedef struct dtl_json_projection_context_tag
+{
+   dtl_json_cursor_t cursor;
+   const dtl_json_projection_t *projection;
+   uint32_t *activeNodes;  //for each depth, the nodes matching the current value (numPaths entries per depth)
+   adt_str_t *keys;        //for each depth, the key of the member being projected
+   bool isError;
+} dtl_json_projection_context_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static bool dtl_json_pointer_find_member(dtl_json_cursor_t *cursor, const char *pToken, const char *pTokenEnd);
+static bool dtl_json_pointer_find_element(dtl_json_cursor_t *cursor, const char *pToken, const char *pTokenEnd);
+static bool dtl_json_pointer_match_key(const char *pToken, const char *pTokenEnd, const char *pKey, uint32_t keyLen);
+static bool dtl_json_pointer_parse_index(const char *pToken, const char *pTokenEnd, uint32_t *index);
+static int32_t dtl_json_pointer_decode_token(const char *pToken, const char *pTokenEnd, char *pDest);
+static bool dtl_json_projection_add_path(dtl_json_projection_t *self, const char *path, char *tokenBuf);
+static uint32_t dtl_json_projection_add_child(dtl_json_projection_t *self, uint32_t parent, const char *pToken, uint32_t tokenLen);
+static uint32_t dtl_json_projection_match(const dtl_json_projection_t *self, const uint32_t *activeNodes, uint32_t numActive,
+                                          const char *pKey, uint32_t keyLen, uint32_t index, uint32_t *childNodes);
+static dtl_dv_t* dtl_json_projection_value(dtl_json_projection_context_t *ctx, uint32_t depth, uint32_t numActive);
+static dtl_dv_t* dtl_json_projection_object(dtl_json_projection_context_t *ctx, uint32_t depth, uint32_t numActive);
+static dtl_dv_t* dtl_json_projection_array(dtl_json_projection_context_t *ctx, uint32_t depth, uint32_t numActive);
+static dtl_dv_t* dtl_json_projection_materialize(dtl_json_projection_context_t *ctx);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns the value addressed by the JSON Pointer (RFC 6901), for example "/a/b/3/c". The empty pointer addresses the whole document.
+ * The document is read with a cursor. Values preceding the addressed one are stepped over by counting brackets and are never
+ * decoded, and the document is not read beyond the addressed value.
+ * Returns NULL if the value does not exist, if the pointer is malformed or if the document is malformed before the value ends.
+ * The caller is responsible for calling dtl_dec_ref on the returned value.
+ */
+dtl_dv_t* dtl_json_extract(const uint8_t *pBegin, const uint8_t *pEnd, const char *pointer)
+{
+   dtl_dv_t *retval = (dtl_dv_t*) 0;
+   dtl_json_cursor_t cursor;
+   const char *pNext = pointer;
+   const uint8_t *pValueBegin;
+   const uint8_t *pValueEnd;
+   dtl_json_token_t token;
+   if ( (pBegin == 0) || (pEnd < pBegin) || (pointer == 0) )
+   {
+      return retval;
+   }
+   if (*pointer == '\0')
+   {
+      return dtl_json_load_bstr(pBegin, pEnd);
+   }
+   dtl_json_cursor_create(&cursor, pBegin, pEnd);
+   token = dtl_json_cursor_next(&cursor);
+   while (*pNext != '\0')
+   {
+      const char *pToken;
+      const char *pTokenEnd;
+      bool isFound = false;
+      if (*pNext != '/')
+      {
+         break;
+      }
+      pToken = pNext + 1;
+      pTokenEnd = strchr(pToken, '/');
+      if (pTokenEnd == 0)
+      {
+         pTokenEnd = pToken + strlen(pToken);
+      }
+      if (token == DTL_JSON_TOKEN_BEGIN_OBJECT)
+      {
+         isFound = dtl_json_pointer_find_member(&cursor, pToken, pTokenEnd);
+      }
+      else if (token == DTL_JSON_TOKEN_BEGIN_ARRAY)
+      {
+         isFound = dtl_json_pointer_find_element(&cursor, pToken, pTokenEnd);
+      }
+      if (!isFound)
+      {
+         break;
+      }
+      token = dtl_json_cursor_type(&cursor);
+      pNext = pTokenEnd;
+   }
+   if ( (*pNext == '\0') && (token != DTL_JSON_TOKEN_ERROR) )
+   {
+      pValueBegin = cursor.pTokenBegin;
+      pValueEnd = cursor.pTokenEnd;
+      if ( (token == DTL_JSON_TOKEN_BEGIN_OBJECT) || (token == DTL_JSON_TOKEN_BEGIN_ARRAY) )
+      {
+         //pTokenEnd is moved to after the matching end bracket
+         if (dtl_json_cursor_skip(&cursor) == DTL_JSON_NO_ERROR)
+         {
+            pValueEnd = cursor.pTokenEnd;
+         }
+         else
+         {
+            pValueEnd = (const uint8_t*) 0;
+         }
+      }
+      if (pValueEnd != 0)
+      {
+         retval = dtl_json_load_bstr(pValueBegin, pValueEnd);
+      }
+   }
+   dtl_json_cursor_destroy(&cursor);
+   return retval;
+}
+
+/**
+ * Compiles a set of JSON Pointers into a projection for dtl_json_load_projected.
+ * In addition to RFC 6901 the reference token "*" matches every member of an object and every element of an array.
+ * Returns NULL if a path is malformed or if memory allocation fails.
+ */
+dtl_json_projection_t* dtl_json_projection_new(const char **paths, uint32_t numPaths)
+{
+   dtl_json_projection_t *self;
+   uint32_t i;
+   if ( (paths == 0) && (numPaths > 0u) )
+   {
+      return (dtl_json_projection_t*) 0;
+   }
+   self = (dtl_json_projection_t*) malloc(sizeof(dtl_json_projection_t));
+   if (self == 0)
+   {
+      return self;
+   }
+   self->nodes = (dtl_json_projection_node_t*) 0;
+   self->numNodes = 0u;
+   self->capacity = 0u;
+   self->numPaths = numPaths;
+   self->maxDepth = 0u;
+   if (dtl_json_projection_add_child(self, PROJECTION_NODE_NONE, (const char*) 0, 0u) == PROJECTION_NODE_NONE)
+   {
+      dtl_json_projection_delete(self);
+      return (dtl_json_projection_t*) 0;
+   }
+   for (i = 0u; i < numPaths; i++)
+   {
+      bool isValid = false;
+      char *tokenBuf = (paths[i] != 0)? (char*) malloc(strlen(paths[i]) + 1u) : (char*) 0;
+      if (tokenBuf != 0)
+      {
+         isValid = dtl_json_projection_add_path(self, paths[i], tokenBuf);
+         free(tokenBuf);
+      }
+      if (!isValid)
+      {
+         dtl_json_projection_delete(self);
+         return (dtl_json_projection_t*) 0;
+      }
+   }
+   return self;
+}
+
+void dtl_json_projection_delete(dtl_json_projection_t *self)
+{
+   if (self != 0)
+   {
+      uint32_t i;
+      for (i = 0u; i < self->numNodes; i++)
+      {
+         if (self->nodes[i].token != 0)
+         {
+            free(self->nodes[i].token);
+         }
+      }
+      if (self->nodes != 0)
+      {
+         free(self->nodes);
+      }
+      free(self);
+   }
+}
+
+/**
+ * Loads only the values selected by the projection into a pruned tree.
+ * Objects and arrays on the way to a selected value are created but contain nothing except selected values (and the
+ * containers leading to them). Array elements keep their relative order but not their index, "/items/3" gives an array
+ * holding one element. Values that are not selected are stepped over by counting brackets, without being decoded,
+ * so they are only checked for balanced brackets and terminated strings.
+ * Returns NULL if the document is malformed, if an allocation fails, or if it is a scalar that is not selected.
+ * The projection is not modified and can be shared by several threads.
+ * The caller is responsible for calling dtl_dec_ref on the returned value.
+ */
+dtl_dv_t* dtl_json_load_projected(const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_projection_t *projection)
+{
+   dtl_dv_t *retval = (dtl_dv_t*) 0;
+   dtl_json_projection_context_t ctx;
+   uint32_t numKeys;
+   uint32_t i;
+   if ( (pBegin == 0) || (pEnd < pBegin) || (projection == 0) )
+   {
+      return retval;
+   }
+   numKeys = projection->maxDepth + 1u;
+   ctx.projection = projection;
+   ctx.isError = false;
+   ctx.activeNodes = (uint32_t*) malloc(sizeof(uint32_t) * numKeys * (projection->numPaths + 1u));
+   ctx.keys = (adt_str_t*) malloc(sizeof(adt_str_t) * numKeys);
+   if ( (ctx.activeNodes == 0) || (ctx.keys == 0) )
+   {
+      if (ctx.activeNodes != 0)
+      {
+         free(ctx.activeNodes);
+      }
+      if (ctx.keys != 0)
+      {
+         free(ctx.keys);
+      }
+      return retval;
+   }
+   for (i = 0u; i < numKeys; i++)
+   {
+      adt_str_create(&ctx.keys[i]);
+   }
+   dtl_json_cursor_create(&ctx.cursor, pBegin, pEnd);
+   ctx.activeNodes[0] = 0u;
+   if (dtl_json_cursor_next(&ctx.cursor) == DTL_JSON_TOKEN_ERROR)
+   {
+      ctx.isError = true;
+   }
+   else
+   {
+      retval = dtl_json_projection_value(&ctx, 0u, 1u);
+      if ( (!ctx.isError) && (dtl_json_cursor_next(&ctx.cursor) != DTL_JSON_TOKEN_END) )
+      {
+         ctx.isError = true;
+      }
+   }
+   if ( (ctx.isError) && (retval != 0) )
+   {
+      dtl_dv_dec_ref(retval);
+      retval = (dtl_dv_t*) 0;
+   }
+   dtl_json_cursor_destroy(&ctx.cursor);
+   for (i = 0u; i < numKeys; i++)
+   {
+      adt_str_destroy(&ctx.keys[i]);
+   }
+   free(ctx.keys);
+   free(ctx.activeNodes);
+   return retval;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Moves cursor from the beginning of an object to the value of the member named by the reference token.
+ */
+static bool dtl_json_pointer_find_member(dtl_json_cursor_t *cursor, const char *pToken, const char *pTokenEnd)
+{
+   while (dtl_json_cursor_next(cursor) == DTL_JSON_TOKEN_KEY)
+   {
+      const char *pKey = (const char*) 0;
+      uint32_t keyLen = 0u;
+      if (dtl_json_cursor_get_string_slice(cursor, &pKey, &keyLen) != DTL_JSON_NO_ERROR)
+      {
+         return false;
+      }
+      if (dtl_json_pointer_match_key(pToken, pTokenEnd, pKey, keyLen))
+      {
+         return (dtl_json_cursor_next(cursor) != DTL_JSON_TOKEN_ERROR);
+      }
+      if (dtl_json_cursor_skip(cursor) != DTL_JSON_NO_ERROR)
+      {
+         return false;
+      }
+   }
+   return false;
+}
+
+/**
+ * Moves cursor from the beginning of an array to the element given by the reference token.
+ * "-" (past the end) never exists.
+ */
+static bool dtl_json_pointer_find_element(dtl_json_cursor_t *cursor, const char *pToken, const char *pTokenEnd)
+{
+   uint32_t index;
+   if (!dtl_json_pointer_parse_index(pToken, pTokenEnd, &index))
+   {
+      return false;
+   }
+   for(;;)
+   {
+      dtl_json_token_t token = dtl_json_cursor_next(cursor);
+      if ( (token == DTL_JSON_TOKEN_END_ARRAY) || (token == DTL_JSON_TOKEN_ERROR) )
+      {
+         return false;
+      }
+      if (index == 0u)
+      {
+         return true;
+      }
+      if (dtl_json_cursor_skip(cursor) != DTL_JSON_NO_ERROR)
+      {
+         return false;
+      }
+      index--;
+   }
+}
+
+/**
+ * Compares reference token with key, decoding the escape sequences "~0" ('~') and "~1" ('/') in the token.
+ */
+static bool dtl_json_pointer_match_key(const char *pToken, const char *pTokenEnd, const char *pKey, uint32_t keyLen)
+{
+   const char *pKeyEnd = pKey + keyLen;
+   while ( (pToken < pTokenEnd) && (pKey < pKeyEnd) )
+   {
+      char c = *pToken++;
+      if (c == '~')
+      {
+         if (pToken == pTokenEnd)
+         {
+            return false;
+         }
+         c = *pToken++;
+         if (c == '0')
+         {
+            c = '~';
+         }
+         else if (c == '1')
+         {
+            c = '/';
+         }
+         else
+         {
+            return false;
+         }
+      }
+      if (c != *pKey++)
+      {
+         return false;
+      }
+   }
+   return ( (pToken == pTokenEnd) && (pKey == pKeyEnd) );
+}
+
+/**
+ * Valid indices are "0" or decimal numbers without leading zeros.
+ */
+static bool dtl_json_pointer_parse_index(const char *pToken, const char *pTokenEnd, uint32_t *index)
+{
+   const char *pNext;
+   uint32_t value = 0u;
+   if ( (pToken == pTokenEnd) || ( (*pToken == '0') && (pTokenEnd - pToken > 1) ) )
+   {
+      return false;
+   }
+   for (pNext = pToken; pNext < pTokenEnd; pNext++)
+   {
+      uint32_t digit = (uint32_t) (*pNext - '0');
+      if ( (digit > 9u) || (value > (UINT32_MAX - digit) / 10u) )
+      {
+         return false;
+      }
+      value = value * 10u + digit;
+   }
+   *index = value;
+   return true;
+}
+
+/**
+ * Writes reference token to pDest with "~0" and "~1" decoded. Returns length of the decoded token or -1 on invalid escape sequence.
+ */
+static int32_t dtl_json_pointer_decode_token(const char *pToken, const char *pTokenEnd, char *pDest)
+{
+   int32_t len = 0;
+   while (pToken < pTokenEnd)
+   {
+      char c = *pToken++;
+      if (c == '~')
+      {
+         c = (pToken < pTokenEnd)? *pToken++ : '\0';
+         if (c == '0')
+         {
+            c = '~';
+         }
+         else if (c == '1')
+         {
+            c = '/';
+         }
+         else
+         {
+            return -1;
+         }
+      }
+      pDest[len++] = c;
+   }
+   return len;
+}
+
+/**
+ * Adds path to the tree. tokenBuf must have room for the longest reference token in path.
+ */
+static bool dtl_json_projection_add_path(dtl_json_projection_t *self, const char *path, char *tokenBuf)
+{
+   uint32_t node = 0u;
+   uint32_t depth = 0u;
+   const char *pNext = path;
+   while (*pNext != '\0')
+   {
+      const char *pToken;
+      const char *pTokenEnd;
+      int32_t tokenLen;
+      if (*pNext != '/')
+      {
+         return false;
+      }
+      pToken = pNext + 1;
+      pTokenEnd = strchr(pToken, '/');
+      if (pTokenEnd == 0)
+      {
+         pTokenEnd = pToken + strlen(pToken);
+      }
+      tokenLen = dtl_json_pointer_decode_token(pToken, pTokenEnd, tokenBuf);
+      if (tokenLen < 0)
+      {
+         return false;
+      }
+      //the undecoded token "*" is the wildcard, a key named "*" can only be selected through a parent path
+      node = dtl_json_projection_add_child(self, node, ( (pTokenEnd - pToken == 1) && (*pToken == '*') )? (const char*) 0 : tokenBuf,
+                                           (uint32_t) tokenLen);
+      if (node == PROJECTION_NODE_NONE)
+      {
+         return false;
+      }
+      depth++;
+      pNext = pTokenEnd;
+   }
+   self->nodes[node].isSelected = true;
+   if (depth > self->maxDepth)
+   {
+      self->maxDepth = depth;
+   }
+   return true;
+}
+
+/**
+ * Returns existing child of parent with the same token or a newly added one. A NULL token adds the wildcard (or the root
+ * when parent is PROJECTION_NODE_NONE). Returns PROJECTION_NODE_NONE on memory allocation failure.
+ */
+static uint32_t dtl_json_projection_add_child(dtl_json_projection_t *self, uint32_t parent, const char *pToken, uint32_t tokenLen)
+{
+   dtl_json_projection_node_t *node;
+   uint32_t child = PROJECTION_NODE_NONE;
+   if (parent != PROJECTION_NODE_NONE)
+   {
+      for (child = self->nodes[parent].firstChild; child != PROJECTION_NODE_NONE; child = self->nodes[child].nextSibling)
+      {
+         node = &self->nodes[child];
+         if (pToken == 0)
+         {
+            if (node->isWildcard)
+            {
+               return child;
+            }
+         }
+         else if ( (!node->isWildcard) && (node->tokenLen == tokenLen) && (memcmp(node->token, pToken, tokenLen) == 0) )
+         {
+            return child;
+         }
+      }
+   }
+   if (self->numNodes == self->capacity)
+   {
+      uint32_t capacity = (self->capacity == 0u)? 8u : self->capacity * 2u;
+      dtl_json_projection_node_t *nodes = (dtl_json_projection_node_t*) realloc(self->nodes, sizeof(dtl_json_projection_node_t) * capacity);
+      if (nodes == 0)
+      {
+         return PROJECTION_NODE_NONE;
+      }
+      self->nodes = nodes;
+      self->capacity = capacity;
+   }
+   child = self->numNodes;
+   node = &self->nodes[child];
+   node->token = (char*) 0;
+   node->tokenLen = 0u;
+   node->index = PROJECTION_NO_INDEX;
+   node->firstChild = PROJECTION_NODE_NONE;
+   node->nextSibling = PROJECTION_NODE_NONE;
+   node->isWildcard = ( (pToken == 0) && (parent != PROJECTION_NODE_NONE) );
+   node->isSelected = false;
+   if (pToken != 0)
+   {
+      uint32_t index;
+      node->token = (char*) malloc(tokenLen + 1u);
+      if (node->token == 0)
+      {
+         return PROJECTION_NODE_NONE;
+      }
+      memcpy(node->token, pToken, tokenLen);
+      node->token[tokenLen] = '\0';
+      node->tokenLen = tokenLen;
+      if (dtl_json_pointer_parse_index(pToken, pToken + tokenLen, &index))
+      {
+         node->index = index;
+      }
+   }
+   if (parent != PROJECTION_NODE_NONE)
+   {
+      node->nextSibling = self->nodes[parent].firstChild;
+      self->nodes[parent].firstChild = child;
+   }
+   self->numNodes++;
+   return child;
+}
+
+/**
+ * Writes the children of the active nodes that match an object member (pKey != NULL) or an array element (pKey == NULL) to childNodes.
+ * Returns number of matching children.
+ */
+static uint32_t dtl_json_projection_match(const dtl_json_projection_t *self, const uint32_t *activeNodes, uint32_t numActive,
+                                          const char *pKey, uint32_t keyLen, uint32_t index, uint32_t *childNodes)
+{
+   uint32_t numChildren = 0u;
+   uint32_t i;
+   for (i = 0u; i < numActive; i++)
+   {
+      uint32_t child;
+      for (child = self->nodes[activeNodes[i]].firstChild; child != PROJECTION_NODE_NONE; child = self->nodes[child].nextSibling)
+      {
+         const dtl_json_projection_node_t *node = &self->nodes[child];
+         bool isMatch;
+         if (node->isWildcard)
+         {
+            isMatch = true;
+         }
+         else if (pKey != 0)
+         {
+            isMatch = ( (node->tokenLen == keyLen) && (memcmp(node->token, pKey, keyLen) == 0) );
+         }
+         else
+         {
+            isMatch = (node->index == index);
+         }
+         if (isMatch)
+         {
+            childNodes[numChildren++] = child;
+         }
+      }
+   }
+   return numChildren;
+}
+
+/**
+ * Projects the value at the current token of the cursor. numActive nodes matching the value are stored for this depth in ctx->activeNodes.
+ * Returns NULL when nothing was selected or on error (ctx->isError is set).
+ */
+static dtl_dv_t* dtl_json_projection_value(dtl_json_projection_context_t *ctx, uint32_t depth, uint32_t numActive)
+{
+   const uint32_t *activeNodes = &ctx->activeNodes[depth * (ctx->projection->numPaths + 1u)];
+   dtl_json_token_t token = dtl_json_cursor_type(&ctx->cursor);
+   uint32_t i;
+   for (i = 0u; i < numActive; i++)
+   {
+      if (ctx->projection->nodes[activeNodes[i]].isSelected)
+      {
+         return dtl_json_projection_materialize(ctx);
+      }
+   }
+   if (token == DTL_JSON_TOKEN_BEGIN_OBJECT)
+   {
+      return dtl_json_projection_object(ctx, depth, numActive);
+   }
+   else if (token == DTL_JSON_TOKEN_BEGIN_ARRAY)
+   {
+      return dtl_json_projection_array(ctx, depth, numActive);
+   }
+   //scalar where the paths expected a container
+   return (dtl_dv_t*) 0;
+}
+
+static dtl_dv_t* dtl_json_projection_object(dtl_json_projection_context_t *ctx, uint32_t depth, uint32_t numActive)
+{
+   uint32_t stride = ctx->projection->numPaths + 1u;
+   const uint32_t *activeNodes = &ctx->activeNodes[depth * stride];
+   uint32_t *childNodes = &ctx->activeNodes[(depth + 1u) * stride];
+   dtl_hv_t *hv = dtl_hv_new();
+   dtl_json_token_t token = DTL_JSON_TOKEN_NONE;
+   if (hv == 0)
+   {
+      ctx->isError = true;
+      return (dtl_dv_t*) 0;
+   }
+   while ( (!ctx->isError) && ( (token = dtl_json_cursor_next(&ctx->cursor)) == DTL_JSON_TOKEN_KEY) )
+   {
+      const char *pKey = (const char*) 0;
+      uint32_t keyLen = 0u;
+      uint32_t numChildren;
+      if (dtl_json_cursor_get_string_slice(&ctx->cursor, &pKey, &keyLen) != DTL_JSON_NO_ERROR)
+      {
+         ctx->isError = true;
+         break;
+      }
+      numChildren = dtl_json_projection_match(ctx->projection, activeNodes, numActive, pKey, keyLen, PROJECTION_NO_INDEX, childNodes);
+      if (numChildren == 0u)
+      {
+         ctx->isError = (dtl_json_cursor_skip(&ctx->cursor) != DTL_JSON_NO_ERROR);
+      }
+      else
+      {
+         dtl_dv_t *child;
+         if ( (adt_str_set_bstr(&ctx->keys[depth], (const uint8_t*) pKey, (const uint8_t*) pKey + keyLen) != ADT_NO_ERROR) ||
+              (dtl_json_cursor_next(&ctx->cursor) == DTL_JSON_TOKEN_ERROR) )
+         {
+            ctx->isError = true;
+            break;
+         }
+         child = dtl_json_projection_value(ctx, depth + 1u, numChildren);
+         if (child != 0)
+         {
+            dtl_hv_set_cstr(hv, adt_str_cstr(&ctx->keys[depth]), child, false);
+         }
+      }
+   }
+   if ( (ctx->isError) || (token != DTL_JSON_TOKEN_END_OBJECT) )
+   {
+      ctx->isError = true;
+      dtl_dv_dec_ref((dtl_dv_t*) hv);
+      return (dtl_dv_t*) 0;
+   }
+   return (dtl_dv_t*) hv;
+}
+
+static dtl_dv_t* dtl_json_projection_array(dtl_json_projection_context_t *ctx, uint32_t depth, uint32_t numActive)
+{
+   uint32_t stride = ctx->projection->numPaths + 1u;
+   const uint32_t *activeNodes = &ctx->activeNodes[depth * stride];
+   uint32_t *childNodes = &ctx->activeNodes[(depth + 1u) * stride];
+   dtl_av_t *av = dtl_av_new();
+   dtl_json_token_t token;
+   uint32_t index = 0u;
+   if (av == 0)
+   {
+      ctx->isError = true;
+      return (dtl_dv_t*) 0;
+   }
+   while ( (!ctx->isError) && ( (token = dtl_json_cursor_next(&ctx->cursor)) != DTL_JSON_TOKEN_END_ARRAY) )
+   {
+      uint32_t numChildren;
+      if (token == DTL_JSON_TOKEN_ERROR)
+      {
+         ctx->isError = true;
+         break;
+      }
+      numChildren = dtl_json_projection_match(ctx->projection, activeNodes, numActive, (const char*) 0, 0u, index++, childNodes);
+      if (numChildren == 0u)
+      {
+         ctx->isError = (dtl_json_cursor_skip(&ctx->cursor) != DTL_JSON_NO_ERROR);
+      }
+      else
+      {
+         dtl_dv_t *child = dtl_json_projection_value(ctx, depth + 1u, numChildren);
+         if (child != 0)
+         {
+            dtl_av_push(av, child, false);
+         }
+      }
+   }
+   if (ctx->isError)
+   {
+      dtl_dv_dec_ref((dtl_dv_t*) av);
+      return (dtl_dv_t*) 0;
+   }
+   return (dtl_dv_t*) av;
+}
+
+/**
+ * Loads the entire value at the current token of the cursor.
+ */
+static dtl_dv_t* dtl_json_projection_materialize(dtl_json_projection_context_t *ctx)
+{
+   dtl_dv_t *retval;
+   dtl_json_token_t token = dtl_json_cursor_type(&ctx->cursor);
+   const uint8_t *pValueBegin = ctx->cursor.pTokenBegin;
+   if ( (token == DTL_JSON_TOKEN_BEGIN_OBJECT) || (token == DTL_JSON_TOKEN_BEGIN_ARRAY) )
+   {
+      if (dtl_json_cursor_skip(&ctx->cursor) != DTL_JSON_NO_ERROR)
+      {
+         ctx->isError = true;
+         return (dtl_dv_t*) 0;
+      }
+   }
+   retval = dtl_json_load_bstr(pValueBegin, ctx->cursor.pTokenEnd);
+   if (retval == 0)
+   {
+      ctx->isError = true;
+   }
+   return retval;
+}
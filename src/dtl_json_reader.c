@@ -32,9 +32,19 @@
 #include <malloc.h>
 #include "bstr.h"
 #include "dtl_json.h"
+#include "dtl_json_scan.h"
+#include "dtl_json_number.h"
+#include "dtl_json_index.h"
+#include "dtl_json_intern.h"
 #include "adt_bytearray.h"
-#include "adt_stack.h"
 #include "filestream.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#endif
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -56,6 +66,13 @@ typedef uint8_t parseState_t;
 #define PARSE_STATE_OBJECT_SEP    ((parseState_t) 9u)
 #define PARSE_STATE_OBJECT_NEXT   ((parseState_t) 10u)
 
+#define DTL_JSON_READER_INITIAL_FRAMES 16
+#define DTL_JSON_READER_MAX_THREADS    64u
+#define DTL_JSON_READER_MIN_PIECE_SIZE 262144u //smaller documents are not split further between threads
+#define DTL_JSON_LINES_MIN_RANGE_SIZE  65536u //smaller inputs are not split further between threads
+#define DTL_JSON_LINES_RANGE_SIZE      4194304u //bytes parsed by each thread per batch in ordered mode
+#define DTL_JSON_READER_VALUE_SIZE     48u //estimated bytes allocated for a dtl value, including its slot in the parent container
+
 
 typedef struct dtl_json_readerData_tag
 {
@@ -63,12 +80,12 @@ typedef struct dtl_json_readerData_tag
    dtl_dv_t *parentElem; //weak reference
    bool isArray;
    bool isObject;
-   adt_str_t objectKey;
+   const char *objectKey; //points into keyBuf
+   adt_str_t keyBuf; //key storage for DOM loads
 } dtl_json_readerData_t;
 
-typedef struct dtl_json_reader_tag
+struct dtl_json_reader_tag
 {
-   adt_stack_t stack;
    adt_bytearray_t parseBuf;
    const uint8_t *pBegin;
    const uint8_t *pEnd;
@@ -76,11 +93,97 @@ typedef struct dtl_json_reader_tag
    bool parseComplete;
    bstr_context_t ctx;
    parseState_t parseState;
-   dtl_json_readerData_t *data;
+   dtl_json_readerData_t *data; //points to frames[depth]
+   dtl_json_readerData_t *frames; //one frame per nesting level, frames above depth are kept for reuse
+   int32_t frameCapacity;
+   int32_t depth;
    dtl_json_error_t lastError;
    uint32_t lineNumber;
-} dtl_json_reader_t;
+   const dtl_json_handler_t *handler; //when set, events are sent to handler instead of building a dtl tree
+   void *handlerArg;
+   adt_str_t tmpStr; //scratch buffer for string values
+   dtl_json_intern_t *keys; //key pool shared by the caller, only used when events are sent to handler
+   dtl_json_index_t index; //used by the structural index engine
+   dtl_json_engine_t engine; //engine used for complete in-memory documents
+   dtl_json_limits_t limits;
+   uint32_t numElements; //values created for the current document
+   size_t numBytes; //estimated bytes allocated for the current document
+};
+
+struct dtl_json_parser_tag
+{
+   dtl_json_reader_t reader;
+};
+
+/**
+ * State of dtl_json_load_lines. A single reader is reset and reused for every line.
+ */
+typedef struct dtl_json_lines_tag
+{
+   dtl_json_reader_t reader;
+   adt_bytearray_t pending; //unterminated line at end of previous chunk
+   dtl_json_line_func_t callback;
+   void *arg;
+   uint32_t lineNumber; //number of next line
+   dtl_json_error_t lastError;
+   bool isStopped;
+} dtl_json_lines_t;
+
+/**
+ * Record parsed by a worker of dtl_json_load_lines_parallel, kept until it can be delivered in order.
+ */
+typedef struct dtl_json_lines_record_tag
+{
+   dtl_dv_t *dv; //strong reference, NULL for malformed line
+   uint32_t lineNumber; //relative to beginning of range
+   dtl_json_error_t errorCode;
+} dtl_json_lines_record_t;
+
+struct dtl_json_lines_parallel_tag;
 
+/**
+ * One thread of dtl_json_load_lines_parallel. Each worker parses its own range of lines with its own reader.
+ */
+typedef struct dtl_json_lines_worker_tag
+{
+   dtl_json_lines_t lines;
+   struct dtl_json_lines_parallel_tag *shared;
+   const uint8_t *pBegin;
+   const uint8_t *pEnd; //range always ends after a newline character (or at end of input)
+   dtl_json_lines_record_t *records;
+   uint32_t numRecords;
+   uint32_t recordCapacity;
+   uint32_t numLines; //newline characters in range (counting phase) or lines parsed (parsing phase)
+   uint32_t lineOffset; //lines preceding the range
+   bool isCounting;
+   bool isOutOfMemory;
+} dtl_json_lines_worker_t;
+
+typedef struct dtl_json_lines_parallel_tag
+{
+   dtl_json_lines_worker_t *workers;
+   uint32_t numWorkers;
+   bool isOrdered;
+   dtl_json_line_func_t callback;
+   void *arg;
+   dtl_json_error_t lastError;
+   bool isStopped;
+#ifndef _WIN32
+   pthread_mutex_t lock; //serializes callbacks in unordered mode
+#endif
+} dtl_json_lines_parallel_t;
+
+/**
+ * Part of a top-level array or object parsed on its own thread by dtl_json_load_parallel.
+ * The piece holds one or more complete elements (or key-value pairs) separated by commas.
+ */
+typedef struct dtl_json_piece_tag
+{
+   const uint8_t *pBegin;
+   const uint8_t *pEnd;
+   bool isObject;
+   dtl_dv_t *result; //container holding the elements of the piece, NULL on error
+} dtl_json_piece_t;
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -88,23 +191,73 @@ typedef struct dtl_json_reader_tag
 //////////////////////////////////////////////////////////////////////////////
 static void dtl_json_reader_create(dtl_json_reader_t *self);
 static void dtl_json_reader_destroy(dtl_json_reader_t *self);
+static void dtl_json_reader_reset(dtl_json_reader_t *self);
+static dtl_dv_t *dtl_json_reader_load_document(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
 static void dtl_json_readerData_create(dtl_json_readerData_t *self);
 static void dtl_json_readerData_destroy(dtl_json_readerData_t *self);
-static dtl_json_readerData_t* dtl_json_readerData_new(void);
-static void dtl_json_readerData_delete(dtl_json_readerData_t *self);
-static void dtl_json_readerData_vdelete(void *arg);
+static void dtl_json_readerData_reset(dtl_json_readerData_t *self);
+static bool dtl_json_reader_grow_frames(dtl_json_reader_t *self);
+static dtl_json_readerData_t* dtl_json_reader_push_data(dtl_json_reader_t *self);
+static void dtl_json_reader_pop_data(dtl_json_reader_t *self);
 
 static void dtl_json_reader_readChunk(void *arg,const uint8_t *pChunk, uint32_t chunkLen);
 static void dtl_json_reader_close(void *arg);
+static void dtl_json_reader_feed(dtl_json_reader_t *self, const uint8_t *pChunk, uint32_t chunkLen);
+static void dtl_json_reader_finish(dtl_json_reader_t *self);
+static dtl_json_parser_status_t dtl_json_reader_status(const dtl_json_reader_t *self);
 static const uint8_t *dtl_json_reader_parse_block(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
 static const uint8_t *dtl_json_reader_parse_value(dtl_json_reader_t *self, const uint8_t *pLineBegin, const uint8_t *pLineEnd);
+static const uint8_t *dtl_json_reader_parse_event(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
 static const uint8_t *dtl_json_reader_parse_number(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+static const uint8_t *dtl_json_reader_parse_string(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, adt_str_t *str);
+static const uint8_t *dtl_json_reader_parse_string_slice(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, const char **ppStr, uint32_t *pStrLen);
+static const uint8_t *dtl_json_reader_parse_literal(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, const char *literal);
 static const uint8_t *dtl_json_reader_lstrip(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+static const char *dtl_json_reader_store_key(dtl_json_reader_t *self, const char *pKey, uint32_t keyLen);
+static bool dtl_json_reader_pred_is_number_char(int c);
+static bool dtl_json_reader_count(dtl_json_reader_t *self, uint32_t numElements, size_t numBytes);
+static bool dtl_json_reader_check_depth(dtl_json_reader_t *self);
+static bool dtl_json_reader_check_string(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+static void dtl_json_reader_set_limit_error(dtl_json_reader_t *self);
+static void dtl_json_reader_emit_begin(dtl_json_reader_t *self, bool isObject);
+static void dtl_json_reader_emit_end(dtl_json_reader_t *self, bool isObject);
+static bool dtl_json_reader_parse_indexed(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+static void dtl_json_reader_parse_index(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_index_t *index);
+static uint32_t dtl_json_reader_parse_index_value(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_index_t *index, uint32_t i);
+static uint32_t dtl_json_reader_parse_index_key(dtl_json_reader_t *self, const uint8_t *pBegin, const dtl_json_index_t *index, uint32_t i);
+static bool dtl_json_reader_parse_index_scalar(dtl_json_reader_t *self, const uint8_t *pToken, const uint8_t *pTokenEnd);
+static void dtl_json_reader_set_error_line(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pError);
+static void dtl_json_lines_create(dtl_json_lines_t *self, dtl_json_line_func_t callback, void *arg);
+static void dtl_json_lines_destroy(dtl_json_lines_t *self);
+static void dtl_json_lines_readChunk(void *arg, const uint8_t *pChunk, uint32_t chunkLen);
+static const uint8_t *dtl_json_lines_parse_block(dtl_json_lines_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+static void dtl_json_lines_parse_line(dtl_json_lines_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+static bool dtl_json_lines_parallel_create(dtl_json_lines_parallel_t *self, uint32_t numWorkers, bool isOrdered, dtl_json_line_func_t callback, void *arg);
+static void dtl_json_lines_parallel_destroy(dtl_json_lines_parallel_t *self);
+static void dtl_json_lines_parallel_split(dtl_json_lines_parallel_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+static void dtl_json_lines_parallel_ordered(dtl_json_lines_parallel_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+static void dtl_json_lines_parallel_unordered(dtl_json_lines_parallel_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
+static void *dtl_json_lines_worker_run(void *arg);
+static bool dtl_json_lines_worker_collect(void *arg, uint32_t lineNumber, dtl_dv_t *dv, dtl_json_error_t errorCode);
+static bool dtl_json_lines_worker_forward(void *arg, uint32_t lineNumber, dtl_dv_t *dv, dtl_json_error_t errorCode);
+static void dtl_json_lines_worker_clear(dtl_json_lines_worker_t *self);
+static uint32_t dtl_json_reader_default_threads(void);
+static void dtl_json_reader_run_threads(void *(*threadFunc)(void *arg), void *pArgs, size_t argSize, uint32_t numArgs);
+static uint32_t dtl_json_reader_split_container(const uint8_t *pOpen, const uint8_t *pEnd, const uint8_t **ppSplits, uint32_t maxSplits, const uint8_t **ppClose);
+static void *dtl_json_piece_run(void *arg);
+static dtl_dv_t *dtl_json_piece_join(dtl_json_piece_t *pieces, uint32_t numPieces);
+#ifndef _WIN32
+static const uint8_t *dtl_json_reader_map_file(int fd, size_t *pMapLen);
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC VARIABLES
 //////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
 //////////////////////////////////////////////////////////////////////////////
@@ -136,6 +289,48 @@ dtl_dv_t* dtl_json_load(FILE *fh)
    return retval;
 }
 
+/**
+ * Loads JSON document from file path.
+ * On POSIX systems regular files are memory-mapped and parsed in place, avoiding the copy into the parse buffer.
+ * Other files (pipes, character devices) and other platforms fall back to dtl_json_load.
+ */
+dtl_dv_t* dtl_json_load_file(const char *path)
+{
+   dtl_dv_t *retval = (dtl_dv_t*) 0;
+   FILE *fh;
+#ifndef _WIN32
+   int fd;
+   const uint8_t *pBegin;
+   size_t mapLen = 0u;
+#endif
+   if (path == 0)
+   {
+      return retval;
+   }
+#ifndef _WIN32
+   fd = open(path, O_RDONLY);
+   if (fd < 0)
+   {
+      return retval;
+   }
+   pBegin = dtl_json_reader_map_file(fd, &mapLen);
+   close(fd);
+   if (pBegin != 0)
+   {
+      retval = dtl_json_load_bstr(pBegin, pBegin + mapLen);
+      munmap((void*) pBegin, mapLen);
+      return retval;
+   }
+#endif
+   fh = fopen(path, "rb");
+   if (fh != 0)
+   {
+      retval = dtl_json_load(fh);
+      fclose(fh);
+   }
+   return retval;
+}
+
 dtl_dv_t* dtl_json_loads(adt_str_t *str);
 
 dtl_dv_t* dtl_json_load_cstr(const char *str)
@@ -147,182 +342,882 @@ dtl_dv_t* dtl_json_load_cstr(const char *str)
    return dtl_json_load_bstr( (const uint8_t*) pBegin, (const uint8_t*) pEnd);
 }
 
+/**
+ * Loads JSON document from memory buffer using the state machine. Use a reader to select another engine.
+ */
 dtl_dv_t* dtl_json_load_bstr(const uint8_t *pBegin, const uint8_t *pEnd)
 {
-   dtl_dv_t *retval = (dtl_dv_t*) 0;
+   dtl_dv_t *retval;
+   dtl_json_reader_t reader;
+   dtl_json_reader_create(&reader);
+   retval = dtl_json_reader_load_document(&reader, pBegin, pEnd);
+   dtl_json_reader_destroy(&reader);
+   return retval;
+}
+
+/**
+ * Loads a large JSON document from memory buffer using several threads. numThreads set to 0 uses one thread per online processor.
+ * When the top-level value is an array or object, it is split at commas between its elements, found by a scan that only looks at
+ * brackets and strings. Each thread parses its own piece, and the pieces are joined in document order.
+ * Other documents, and documents smaller than DTL_JSON_READER_MIN_PIECE_SIZE per thread, are loaded by dtl_json_load_bstr.
+ */
+dtl_dv_t* dtl_json_load_parallel(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t numThreads)
+{
+   const uint8_t *splits[DTL_JSON_READER_MAX_THREADS];
+   dtl_json_piece_t pieces[DTL_JSON_READER_MAX_THREADS];
+   const uint8_t *pOpen;
+   const uint8_t *pClose;
+   const uint8_t *pNext;
+   uint32_t numSplits;
+   uint32_t i;
+   uint32_t newLines = 0u;
+   size_t docLen;
+   if ( (pBegin == 0) || (pEnd < pBegin) )
+   {
+      return (dtl_dv_t*) 0;
+   }
+   if (numThreads == 0u)
+   {
+      numThreads = dtl_json_reader_default_threads();
+   }
+   if (numThreads > DTL_JSON_READER_MAX_THREADS)
+   {
+      numThreads = DTL_JSON_READER_MAX_THREADS;
+   }
+   docLen = (size_t) (pEnd - pBegin);
+   if ( (size_t) numThreads > (docLen / DTL_JSON_READER_MIN_PIECE_SIZE) )
+   {
+      numThreads = (uint32_t) (docLen / DTL_JSON_READER_MIN_PIECE_SIZE);
+   }
+   pOpen = dtl_json_scan_whitespace(pBegin, pEnd, &newLines);
+   if ( (numThreads <= 1u) || (pOpen >= pEnd) || ( (*pOpen != '[') && (*pOpen != '{') ) )
+   {
+      return dtl_json_load_bstr(pBegin, pEnd);
+   }
+   numSplits = dtl_json_reader_split_container(pOpen, pEnd, splits, numThreads - 1u, &pClose);
+   if ( (numSplits == 0u) || (pClose == 0) )
+   {
+      //nothing to split, or brackets do not match (the error is then found by the ordinary parser)
+      return dtl_json_load_bstr(pBegin, pEnd);
+   }
+   if ( (*pClose != ( (*pOpen == '[')? ']' : '}') ) || (dtl_json_scan_whitespace(pClose + 1, pEnd, &newLines) != pEnd) )
+   {
+      return (dtl_dv_t*) 0;
+   }
+   pNext = pOpen + 1;
+   for (i = 0u; i <= numSplits; i++)
+   {
+      pieces[i].pBegin = pNext;
+      pieces[i].pEnd = (i < numSplits)? splits[i] : pClose;
+      pieces[i].isObject = (*pOpen == '{');
+      pieces[i].result = (dtl_dv_t*) 0;
+      pNext = pieces[i].pEnd + 1;
+   }
+   dtl_json_reader_run_threads(dtl_json_piece_run, (void*) pieces, sizeof(dtl_json_piece_t), numSplits + 1u);
+   return dtl_json_piece_join(pieces, numSplits + 1u);
+}
+
+dtl_json_error_t dtl_json_parse(FILE *fh, const dtl_json_handler_t *handler, void *arg)
+{
+   dtl_json_error_t retval = DTL_JSON_UNEXPECTED_EOB_ERROR;
+   ifstream_handler_t streamHandler;
+   ifstream_t ifstream;
+   dtl_json_reader_t reader;
+   dtl_json_reader_create(&reader);
+   reader.handler = handler;
+   reader.handlerArg = arg;
+   memset(&streamHandler, 0, sizeof(streamHandler));
+   streamHandler.arg = (void*) &reader;
+   streamHandler.write = dtl_json_reader_readChunk;
+   streamHandler.close = dtl_json_reader_close;
+   ifstream_create(&ifstream, &streamHandler);
+   if (ifstream_readTextFileFromHandle(&ifstream, fh) == 0)
+   {
+      retval = reader.parseComplete? DTL_JSON_NO_ERROR : reader.lastError;
+   }
+   dtl_json_reader_destroy(&reader);
+   return retval;
+}
+
+/**
+ * Parses the JSON document in the buffer without creating any dtl values.
+ * Instead, each token found is reported through the callbacks in handler.
+ * Strings and keys are passed as (pointer, length) slices that are only valid for the duration of the callback.
+ */
+dtl_json_error_t dtl_json_parse_bstr(const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_handler_t *handler, void *arg)
+{
+   dtl_json_error_t retval = DTL_JSON_NO_ERROR;
    const uint8_t *pResult;
    dtl_json_reader_t reader;
    dtl_json_reader_create(&reader);
    reader.eof = true;
+   reader.handler = handler;
+   reader.handlerArg = arg;
    pResult = dtl_json_reader_parse_block(&reader, pBegin, pEnd);
-   if (pResult == (const uint8_t*) pEnd)
+   if ( (pResult != (const uint8_t*) pEnd) || (reader.parseState != PARSE_STATE_NONE) )
+   {
+      retval = (reader.lastError != DTL_JSON_NO_ERROR)? reader.lastError : DTL_JSON_UNEXPECTED_EOB_ERROR;
+   }
+   dtl_json_reader_destroy(&reader);
+   return retval;
+}
+
+/**
+ * Loads newline-delimited JSON (JSON Lines) from file, one record per line. See dtl_json_load_lines_bstr.
+ * Only the current chunk and an unterminated line are held in memory.
+ */
+dtl_json_error_t dtl_json_load_lines(FILE *fh, dtl_json_line_func_t callback, void *arg)
+{
+   dtl_json_error_t retval = DTL_JSON_INVALID_ARGUMENT_ERROR;
+   ifstream_handler_t streamHandler;
+   ifstream_t ifstream;
+   dtl_json_lines_t lines;
+   if ( (fh == 0) || (callback == 0) )
    {
-      if (reader.data->currentElem != 0)
+      return retval;
+   }
+   dtl_json_lines_create(&lines, callback, arg);
+   memset(&streamHandler, 0, sizeof(streamHandler));
+   streamHandler.arg = (void*) &lines;
+   streamHandler.write = dtl_json_lines_readChunk;
+   ifstream_create(&ifstream, &streamHandler);
+   if (ifstream_readTextFileFromHandle(&ifstream, fh) == 0)
+   {
+      uint32_t remain = adt_bytearray_length(&lines.pending);
+      if ( (!lines.isStopped) && (remain > 0u) )
       {
-         retval = reader.data->currentElem;
-         dtl_dv_inc_ref(reader.data->currentElem);
+         const uint8_t *pBegin = adt_bytearray_data(&lines.pending);
+         dtl_json_lines_parse_line(&lines, pBegin, pBegin + remain);
       }
-      dtl_json_reader_destroy(&reader);
+      retval = lines.lastError;
    }
    else
    {
-      dtl_json_reader_destroy(&reader);
+      retval = DTL_JSON_UNEXPECTED_EOB_ERROR;
    }
+   dtl_json_lines_destroy(&lines);
    return retval;
 }
 
-//////////////////////////////////////////////////////////////////////////////
-// PRIVATE FUNCTIONS
-//////////////////////////////////////////////////////////////////////////////
-static void dtl_json_reader_create(dtl_json_reader_t *self)
+/**
+ * Loads newline-delimited JSON (JSON Lines) from buffer, one record per line.
+ * callback is called in line order for each line that is not blank. Malformed lines are reported with dv set to NULL.
+ * When the callback returns false no further lines are parsed.
+ * Returns DTL_JSON_NO_ERROR when the input was consumed or the callback stopped on a valid record,
+ * otherwise the error of the malformed line on which the callback returned false.
+ */
+dtl_json_error_t dtl_json_load_lines_bstr(const uint8_t *pBegin, const uint8_t *pEnd, dtl_json_line_func_t callback, void *arg)
 {
-   if (self != 0)
+   dtl_json_error_t retval;
+   const uint8_t *pResult;
+   dtl_json_lines_t lines;
+   if ( (pBegin == 0) || (pEnd < pBegin) || (callback == 0) )
    {
-      self->eof = false;
-      self->parseComplete = false;
-      self->pBegin = 0;
-      self->pEnd = 0;
-      self->lastError = DTL_JSON_NO_ERROR;
-      self->lineNumber = 1u;
-      self->parseState = PARSE_STATE_NONE;
-      self->data = dtl_json_readerData_new();
-      adt_bytearray_create(&self->parseBuf, ADT_BYTE_ARRAY_DEFAULT_GROW_SIZE);
-      bstr_context_create(&self->ctx);
-      adt_stack_create(&self->stack, dtl_json_readerData_vdelete);
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   dtl_json_lines_create(&lines, callback, arg);
+   pResult = dtl_json_lines_parse_block(&lines, pBegin, pEnd);
+   if ( (!lines.isStopped) && (pResult < pEnd) )
+   {
+      dtl_json_lines_parse_line(&lines, pResult, pEnd);
    }
+   retval = lines.lastError;
+   dtl_json_lines_destroy(&lines);
+   return retval;
 }
-static void dtl_json_reader_destroy(dtl_json_reader_t *self)
+
+/**
+ * Loads newline-delimited JSON from buffer using several threads. Each thread parses its own range of lines with its own reader.
+ * numThreads set to 0 uses one thread per online processor.
+ * When isOrdered is true, records are passed to the callback from the calling thread in line order. The input is then processed
+ * in batches of at most DTL_JSON_LINES_RANGE_SIZE bytes per thread, holding only one batch of parsed records in memory.
+ * When isOrdered is false, each thread passes its records to the callback as soon as they are parsed. Callbacks are serialized
+ * but come from different threads, and lines in different ranges arrive in any order.
+ * Line numbers, error handling and return value are the same as for dtl_json_load_lines_bstr.
+ */
+dtl_json_error_t dtl_json_load_lines_parallel(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t numThreads, bool isOrdered, dtl_json_line_func_t callback, void *arg)
+{
+   dtl_json_error_t retval;
+   dtl_json_lines_parallel_t parallel;
+   size_t inputLen;
+   if ( (pBegin == 0) || (pEnd < pBegin) || (callback == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if (numThreads == 0u)
+   {
+      numThreads = dtl_json_reader_default_threads();
+   }
+   if (numThreads > DTL_JSON_READER_MAX_THREADS)
+   {
+      numThreads = DTL_JSON_READER_MAX_THREADS;
+   }
+   inputLen = (size_t) (pEnd - pBegin);
+   if ( (size_t) numThreads > (inputLen / DTL_JSON_LINES_MIN_RANGE_SIZE) + 1u)
+   {
+      numThreads = (uint32_t) (inputLen / DTL_JSON_LINES_MIN_RANGE_SIZE) + 1u;
+   }
+   if (numThreads <= 1u)
+   {
+      return dtl_json_load_lines_bstr(pBegin, pEnd, callback, arg);
+   }
+   if (!dtl_json_lines_parallel_create(&parallel, numThreads, isOrdered, callback, arg))
+   {
+      return DTL_JSON_MEM_ERROR;
+   }
+   if (isOrdered)
+   {
+      dtl_json_lines_parallel_ordered(&parallel, pBegin, pEnd);
+   }
+   else
+   {
+      dtl_json_lines_parallel_unordered(&parallel, pBegin, pEnd);
+   }
+   retval = parallel.lastError;
+   dtl_json_lines_parallel_destroy(&parallel);
+   return retval;
+}
+
+/**
+ * Loads newline-delimited JSON from file path using several threads. See dtl_json_load_lines_parallel.
+ * On POSIX systems regular files are memory-mapped and split between threads.
+ * Other files (pipes, character devices) and other platforms are read by dtl_json_load_lines on the calling thread.
+ */
+dtl_json_error_t dtl_json_load_lines_file(const char *path, uint32_t numThreads, bool isOrdered, dtl_json_line_func_t callback, void *arg)
+{
+   dtl_json_error_t retval = DTL_JSON_INVALID_ARGUMENT_ERROR;
+   FILE *fh;
+#ifndef _WIN32
+   int fd;
+   const uint8_t *pBegin;
+   size_t mapLen = 0u;
+#endif
+   if ( (path == 0) || (callback == 0) )
+   {
+      return retval;
+   }
+#ifndef _WIN32
+   fd = open(path, O_RDONLY);
+   if (fd < 0)
+   {
+      return retval;
+   }
+   pBegin = dtl_json_reader_map_file(fd, &mapLen);
+   close(fd);
+   if (pBegin != 0)
+   {
+      retval = dtl_json_load_lines_parallel(pBegin, pBegin + mapLen, numThreads, isOrdered, callback, arg);
+      munmap((void*) pBegin, mapLen);
+      return retval;
+   }
+#else
+   (void) numThreads;
+   (void) isOrdered;
+#endif
+   fh = fopen(path, "rb");
+   if (fh != 0)
+   {
+      retval = dtl_json_load_lines(fh, callback, arg);
+      fclose(fh);
+   }
+   return retval;
+}
+
+dtl_json_parser_t* dtl_json_parser_new(void)
 {
+   dtl_json_parser_t *self = (dtl_json_parser_t*) malloc(sizeof(dtl_json_parser_t));
    if (self != 0)
    {
-      adt_bytearray_destroy(&self->parseBuf);
-      dtl_json_readerData_delete(self->data);
-      adt_stack_destroy(&self->stack);
+      dtl_json_reader_create(&self->reader);
    }
+   return self;
 }
 
-static void dtl_json_readerData_create(dtl_json_readerData_t *self)
+void dtl_json_parser_delete(dtl_json_parser_t *self)
 {
    if (self != 0)
    {
-      self->currentElem = (dtl_dv_t*) 0;
-      self->parentElem = (dtl_dv_t*) 0;
-      self->isArray = false;
-      self->isObject = false;
-      adt_str_create(&self->objectKey);
+      dtl_json_reader_destroy(&self->reader);
+      free(self);
    }
 }
 
-static void dtl_json_readerData_destroy(dtl_json_readerData_t *self)
+dtl_json_parser_status_t dtl_json_parser_feed(dtl_json_parser_t *self, const uint8_t *pData, uint32_t dataLen)
 {
    if (self != 0)
    {
-      adt_str_destroy(&self->objectKey);
-      if ( self->currentElem != 0)
+      if (self->reader.eof)
       {
-         dtl_dv_dec_ref(self->currentElem);
+         //finish has already been called
+         return DTL_JSON_PARSER_ERROR;
       }
+      dtl_json_reader_feed(&self->reader, pData, dataLen);
+      return dtl_json_reader_status(&self->reader);
    }
+   return DTL_JSON_PARSER_ERROR;
 }
 
-static dtl_json_readerData_t* dtl_json_readerData_new(void)
+dtl_json_parser_status_t dtl_json_parser_finish(dtl_json_parser_t *self)
 {
-   dtl_json_readerData_t *self = (dtl_json_readerData_t*) malloc(sizeof(dtl_json_readerData_t));
    if (self != 0)
    {
-      dtl_json_readerData_create(self);
+      if (!self->reader.eof)
+      {
+         dtl_json_reader_finish(&self->reader);
+      }
+      return self->reader.parseComplete? DTL_JSON_PARSER_DONE : DTL_JSON_PARSER_ERROR;
    }
-   return self;
+   return DTL_JSON_PARSER_ERROR;
+}
+
+/**
+ * Returns the parsed value (with incremented reference count) once the parser has reached DTL_JSON_PARSER_DONE.
+ * The caller is responsible for calling dtl_dec_ref on the returned value.
+ */
+dtl_dv_t* dtl_json_parser_result(dtl_json_parser_t *self)
+{
+   dtl_dv_t *retval = (dtl_dv_t*) 0;
+   if ( (self != 0) && (self->reader.parseState == PARSE_STATE_NONE) && (self->reader.data->currentElem != 0) )
+   {
+      retval = self->reader.data->currentElem;
+      dtl_dv_inc_ref(retval);
+   }
+   return retval;
 }
 
-static void dtl_json_readerData_delete(dtl_json_readerData_t *self)
+/**
+ * Limits the documents accepted by the parser. See dtl_json_reader_set_limits.
+ */
+void dtl_json_parser_set_limits(dtl_json_parser_t *self, const dtl_json_limits_t *limits)
 {
    if (self != 0)
    {
-      dtl_json_readerData_destroy(self);
-      free(self);
+      dtl_json_reader_set_limits(&self->reader, limits);
    }
 }
 
-static void dtl_json_readerData_vdelete(void *arg)
+dtl_json_error_t dtl_json_parser_last_error(const dtl_json_parser_t *self)
 {
-   dtl_json_readerData_delete((dtl_json_readerData_t*) arg);
+   if (self != 0)
+   {
+      return self->reader.lastError;
+   }
+   return DTL_JSON_NO_ERROR;
 }
 
 /**
- * For now we wait until entire file has been read into memory.
- * Sometime in the future I will implement support for streamed parsing of JSON
+ * Returns the line the parser has reached. After an error, this is the line where the error was found.
  */
-static void dtl_json_reader_readChunk(void *arg,const uint8_t *pChunk, uint32_t chunkLen)
+uint32_t dtl_json_parser_line_number(const dtl_json_parser_t *self)
 {
-   dtl_json_reader_t *self = (dtl_json_reader_t*) arg;
-   if ( (self != 0) && (pChunk != 0) && (chunkLen > 0) && (chunkLen < INT32_MAX) )
+   if (self != 0)
    {
-      adt_bytearray_append(&self->parseBuf, pChunk, chunkLen);
+      return self->reader.lineNumber;
    }
+   return 0u;
 }
 
-static void dtl_json_reader_close(void *arg)
+/**
+ * Creates a reader that can load any number of documents, one at a time.
+ * Its parse buffer, frames, structural index and key buffers are kept between documents, so loading
+ * small documents of similar shape does not allocate anything besides the returned dtl values.
+ * A reader must only be used by one thread at a time.
+ */
+dtl_json_reader_t* dtl_json_reader_new(void)
 {
-   dtl_json_reader_t *self = (dtl_json_reader_t*) arg;
+   dtl_json_reader_t *self = (dtl_json_reader_t*) malloc(sizeof(dtl_json_reader_t));
    if (self != 0)
    {
-      const uint8_t *pBegin;
-      const uint8_t *pEnd;
-      pBegin = adt_bytearray_data(&self->parseBuf);
-      pEnd = pBegin + adt_bytearray_length(&self->parseBuf);
-      if ( (pBegin != 0) && (pEnd != 0) )
-      {
-         const uint8_t *pResult = dtl_json_reader_parse_block(self, pBegin, pEnd);
-         if (pResult == pEnd)
-         {
-            self->parseComplete = true;
-         }
-      }
+      dtl_json_reader_create(self);
    }
+   return self;
 }
 
-static const uint8_t *dtl_json_reader_parse_block(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+void dtl_json_reader_delete(dtl_json_reader_t *self)
 {
-   const uint8_t *pNext = pBegin;
+   if (self != 0)
+   {
+      dtl_json_reader_destroy(self);
+      free(self);
+   }
+}
 
-   if (self->parseState == PARSE_STATE_NONE)
+/**
+ * Same as dtl_json_load_bstr but parses with a reused reader.
+ * Returns NULL on error, dtl_json_reader_last_error then tells why.
+ */
+dtl_dv_t* dtl_json_reader_load_bstr(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   if (self == 0)
    {
-      self->parseState = PARSE_STATE_PRE_VALUE;
+      return (dtl_dv_t*) 0;
    }
-   while( (self->parseState != PARSE_STATE_NONE) && (self->parseState != PARSE_STATE_ERROR) && (pNext < pEnd) )
+   dtl_json_reader_reset(self);
+   return dtl_json_reader_load_document(self, pBegin, pEnd);
+}
+
+dtl_dv_t* dtl_json_reader_load_cstr(dtl_json_reader_t *self, const char *str)
+{
+   if (str == 0)
    {
-      const uint8_t *pResult;
-      uint8_t nextChar = *pNext;
+      return (dtl_dv_t*) 0;
+   }
+   return dtl_json_reader_load_bstr(self, (const uint8_t*) str, (const uint8_t*) str + strlen(str));
+}
 
-      switch(self->parseState)
+/**
+ * Same as dtl_json_parse_bstr but parses with a reused reader, which keeps its buffers between documents.
+ * When a key pool has been set, keys it holds or has room for are passed as pointers into the pool. See dtl_json_reader_set_key_pool.
+ * Events are always produced by the state machine engine.
+ */
+dtl_json_error_t dtl_json_reader_parse_bstr(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_handler_t *handler, void *arg)
+{
+   dtl_json_error_t retval = DTL_JSON_NO_ERROR;
+   const uint8_t *pResult;
+   if ( (self == 0) || (handler == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   dtl_json_reader_reset(self);
+   self->eof = true;
+   self->handler = handler;
+   self->handlerArg = arg;
+   pResult = dtl_json_reader_parse_block(self, pBegin, pEnd);
+   if ( (pResult != (const uint8_t*) pEnd) || (self->parseState != PARSE_STATE_NONE) )
+   {
+      if (self->lastError == DTL_JSON_NO_ERROR)
       {
-      case PARSE_STATE_PRE_VALUE:
-         pNext = dtl_json_reader_lstrip(self, pNext, pEnd);
-         self->parseState = PARSE_STATE_VALUE;
-         break;
-      case PARSE_STATE_VALUE:
-         pResult = dtl_json_reader_parse_value(self, pNext, pEnd);
-         if (pResult > pNext)
-         {
-            pNext = pResult;
-         }
-         break;
-      case PARSE_STATE_POST_VALUE:
-         pNext = dtl_json_reader_lstrip(self, pNext, pEnd);
-         if (self->data->isArray)
-         {
-            assert(self->data->parentElem != 0);
-            dtl_av_push((dtl_av_t*) self->data->parentElem, self->data->currentElem, false);
-            self->data->currentElem = (dtl_dv_t*) 0;
+         self->lastError = DTL_JSON_UNEXPECTED_EOB_ERROR;
+      }
+      retval = self->lastError;
+   }
+   self->handler = (const dtl_json_handler_t*) 0;
+   self->handlerArg = (void*) 0;
+   return retval;
+}
+
+/**
+ * Returns the error of the most recent document loaded by the reader.
+ */
+dtl_json_error_t dtl_json_reader_last_error(const dtl_json_reader_t *self)
+{
+   if (self != 0)
+   {
+      return self->lastError;
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+/**
+ * Returns the line where loading of the most recent document stopped. After an error, this is the line where the error was found.
+ */
+uint32_t dtl_json_reader_line_number(const dtl_json_reader_t *self)
+{
+   if (self != 0)
+   {
+      return self->lineNumber;
+   }
+   return 0u;
+}
+
+/**
+ * Makes dtl_json_reader_parse_bstr pass object keys found in pool (or added to it) as pointers into the pool.
+ * Passing NULL removes the pool. DOM loads do not use the pool since dtl_hv_set_cstr makes its own copy of each key.
+ */
+void dtl_json_reader_set_key_pool(dtl_json_reader_t *self, dtl_json_intern_t *pool)
+{
+   if (self != 0)
+   {
+      self->keys = pool;
+   }
+}
+
+/**
+ * Limits the documents accepted by the reader, for example when loading untrusted input. The limits apply to all
+ * documents loaded from now on, NULL removes them. Loading stops with DTL_JSON_LIMIT_ERROR as soon as a limit is exceeded,
+ * before the offending value is created, and the values created so far are released.
+ * Memory is estimated from the number of values and the length of strings and keys, it does not include the input buffer.
+ */
+void dtl_json_reader_set_limits(dtl_json_reader_t *self, const dtl_json_limits_t *limits)
+{
+   if (self != 0)
+   {
+      if (limits != 0)
+      {
+         self->limits = *limits;
+      }
+      else
+      {
+         memset(&self->limits, 0, sizeof(dtl_json_limits_t));
+      }
+   }
+}
+
+/**
+ * Selects the engine used by dtl_json_reader_load_bstr for all documents loaded from now on. Unknown engines are ignored.
+ * Buffers of 4 GB or more are always parsed by the state machine.
+ */
+void dtl_json_reader_set_engine(dtl_json_reader_t *self, dtl_json_engine_t engine)
+{
+   if ( (self != 0) && ( (engine == DTL_JSON_ENGINE_STATE_MACHINE) || (engine == DTL_JSON_ENGINE_STRUCTURAL_INDEX) ) )
+   {
+      self->engine = engine;
+   }
+}
+
+dtl_json_engine_t dtl_json_reader_get_engine(const dtl_json_reader_t *self)
+{
+   if (self != 0)
+   {
+      return self->engine;
+   }
+   return DTL_JSON_ENGINE_STATE_MACHINE;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void dtl_json_reader_create(dtl_json_reader_t *self)
+{
+   if (self != 0)
+   {
+      self->eof = false;
+      self->parseComplete = false;
+      self->pBegin = 0;
+      self->pEnd = 0;
+      self->lastError = DTL_JSON_NO_ERROR;
+      self->lineNumber = 1u;
+      self->parseState = PARSE_STATE_PRE_VALUE;
+      self->handler = (const dtl_json_handler_t*) 0;
+      self->handlerArg = (void*) 0;
+      adt_str_create(&self->tmpStr);
+      self->keys = (dtl_json_intern_t*) 0;
+      self->frames = (dtl_json_readerData_t*) 0;
+      self->frameCapacity = 0;
+      self->depth = 0;
+      self->data = (dtl_json_readerData_t*) 0;
+      (void) dtl_json_reader_grow_frames(self);
+      adt_bytearray_create(&self->parseBuf, ADT_BYTE_ARRAY_DEFAULT_GROW_SIZE);
+      bstr_context_create(&self->ctx);
+      dtl_json_index_create(&self->index);
+      self->engine = DTL_JSON_ENGINE_STATE_MACHINE;
+      memset(&self->limits, 0, sizeof(dtl_json_limits_t));
+      self->numElements = 0u;
+      self->numBytes = 0u;
+   }
+}
+static void dtl_json_reader_destroy(dtl_json_reader_t *self)
+{
+   if (self != 0)
+   {
+      int32_t i;
+      adt_bytearray_destroy(&self->parseBuf);
+      adt_str_destroy(&self->tmpStr);
+      for (i = 0; i < self->frameCapacity; i++)
+      {
+         dtl_json_readerData_destroy(&self->frames[i]);
+      }
+      if (self->frames != 0)
+      {
+         free(self->frames);
+      }
+      dtl_json_index_destroy(&self->index);
+   }
+}
+
+/**
+ * Prepares reader for another document. Parse buffer and frames are kept so that parsing similar documents does not allocate again.
+ */
+static void dtl_json_reader_reset(dtl_json_reader_t *self)
+{
+   int32_t i;
+   if (self->frames != 0)
+   {
+      for (i = 0; i <= self->depth; i++)
+      {
+         dtl_json_readerData_reset(&self->frames[i]);
+      }
+      self->data = &self->frames[0];
+   }
+   self->depth = 0;
+   self->eof = false;
+   self->parseComplete = false;
+   self->pBegin = 0;
+   self->pEnd = 0;
+   self->lastError = DTL_JSON_NO_ERROR;
+   self->lineNumber = 1u;
+   self->parseState = PARSE_STATE_PRE_VALUE;
+   self->numElements = 0u;
+   self->numBytes = 0u;
+   adt_bytearray_clear(&self->parseBuf);
+}
+
+/**
+ * Parses the complete document in the buffer using the engine selected for the reader.
+ * Buffers of 4 GB or more are always parsed by the state machine.
+ * On success the value is moved out of the reader and returned, otherwise NULL is returned.
+ */
+static dtl_dv_t *dtl_json_reader_load_document(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   dtl_dv_t *retval = (dtl_dv_t*) 0;
+   bool isValid;
+   self->eof = true;
+   if ( (self->engine == DTL_JSON_ENGINE_STRUCTURAL_INDEX) && (pBegin <= pEnd) && ( (size_t) (pEnd - pBegin) < (size_t) UINT32_MAX) )
+   {
+      isValid = dtl_json_reader_parse_indexed(self, pBegin, pEnd);
+   }
+   else
+   {
+      const uint8_t *pResult = dtl_json_reader_parse_block(self, pBegin, pEnd);
+      isValid = ( (pResult == (const uint8_t*) pEnd) && (self->parseState == PARSE_STATE_NONE) );
+   }
+   if (isValid)
+   {
+      retval = self->data->currentElem;
+      self->data->currentElem = (dtl_dv_t*) 0;
+   }
+   else if (self->lastError == DTL_JSON_NO_ERROR)
+   {
+      self->lastError = DTL_JSON_UNEXPECTED_EOB_ERROR;
+   }
+   return retval;
+}
+
+static void dtl_json_readerData_create(dtl_json_readerData_t *self)
+{
+   if (self != 0)
+   {
+      self->currentElem = (dtl_dv_t*) 0;
+      self->parentElem = (dtl_dv_t*) 0;
+      self->isArray = false;
+      self->isObject = false;
+      self->objectKey = (const char*) 0;
+      adt_str_create(&self->keyBuf);
+   }
+}
+
+static void dtl_json_readerData_destroy(dtl_json_readerData_t *self)
+{
+   if (self != 0)
+   {
+      if ( self->currentElem != 0)
+      {
+         dtl_dv_dec_ref(self->currentElem);
+      }
+      adt_str_destroy(&self->keyBuf);
+   }
+}
+
+/**
+ * Prepares frame for reuse at another position in the document. The buffer of keyBuf is kept.
+ */
+static void dtl_json_readerData_reset(dtl_json_readerData_t *self)
+{
+   if (self->currentElem != 0)
+   {
+      dtl_dv_dec_ref(self->currentElem);
+      self->currentElem = (dtl_dv_t*) 0;
+   }
+   self->parentElem = (dtl_dv_t*) 0;
+   self->isArray = false;
+   self->isObject = false;
+   self->objectKey = (const char*) 0;
+}
+
+static bool dtl_json_reader_grow_frames(dtl_json_reader_t *self)
+{
+   int32_t i;
+   int32_t newCapacity = (self->frameCapacity == 0)? DTL_JSON_READER_INITIAL_FRAMES : (self->frameCapacity * 2);
+   dtl_json_readerData_t *frames = (dtl_json_readerData_t*) realloc(self->frames, sizeof(dtl_json_readerData_t) * (size_t) newCapacity);
+   if (frames == 0)
+   {
+      return false;
+   }
+   for (i = self->frameCapacity; i < newCapacity; i++)
+   {
+      dtl_json_readerData_create(&frames[i]);
+   }
+   self->frames = frames;
+   self->frameCapacity = newCapacity;
+   self->data = &self->frames[self->depth];
+   return true;
+}
+
+/**
+ * Enters a new nesting level. Returns the new frame or NULL on allocation failure.
+ */
+static dtl_json_readerData_t* dtl_json_reader_push_data(dtl_json_reader_t *self)
+{
+   dtl_dv_t *parentElem = self->data->currentElem;
+   if ( ((self->depth + 1) >= self->frameCapacity) && (!dtl_json_reader_grow_frames(self)) )
+   {
+      return (dtl_json_readerData_t*) 0;
+   }
+   self->depth++;
+   self->data = &self->frames[self->depth];
+   self->data->parentElem = parentElem;
+   return self->data;
+}
+
+static void dtl_json_reader_pop_data(dtl_json_reader_t *self)
+{
+   assert(self->depth > 0);
+   dtl_json_readerData_reset(self->data);
+   self->depth--;
+   self->data = &self->frames[self->depth];
+}
+
+static void dtl_json_reader_readChunk(void *arg,const uint8_t *pChunk, uint32_t chunkLen)
+{
+   dtl_json_reader_feed((dtl_json_reader_t*) arg, pChunk, chunkLen);
+}
+
+static void dtl_json_reader_close(void *arg)
+{
+   dtl_json_reader_finish((dtl_json_reader_t*) arg);
+}
+
+/**
+ * Parses as much of the incoming chunk as possible.
+ * Only the unfinished token at the end of the chunk (if any) is kept in parseBuf until the next chunk arrives.
+ * When there is no such token pending the chunk is parsed in place without being copied.
+ */
+static void dtl_json_reader_feed(dtl_json_reader_t *self, const uint8_t *pChunk, uint32_t chunkLen)
+{
+   if ( (self != 0) && (pChunk != 0) && (chunkLen > 0) && (chunkLen < INT32_MAX) && (self->parseState != PARSE_STATE_ERROR) )
+   {
+      adt_error_t result = ADT_NO_ERROR;
+      if (adt_bytearray_length(&self->parseBuf) == 0u)
+      {
+         const uint8_t *pEnd = pChunk + chunkLen;
+         const uint8_t *pResult = dtl_json_reader_parse_block(self, pChunk, pEnd);
+         if ( (self->parseState != PARSE_STATE_ERROR) && (pResult < pEnd) )
+         {
+            result = adt_bytearray_append(&self->parseBuf, pResult, (uint32_t) (pEnd - pResult));
+         }
+      }
+      else
+      {
+         result = adt_bytearray_append(&self->parseBuf, pChunk, chunkLen);
+         if (result == ADT_NO_ERROR)
+         {
+            const uint8_t *pBegin = adt_bytearray_data(&self->parseBuf);
+            const uint8_t *pEnd = pBegin + adt_bytearray_length(&self->parseBuf);
+            const uint8_t *pResult = dtl_json_reader_parse_block(self, pBegin, pEnd);
+            if (self->parseState != PARSE_STATE_ERROR)
+            {
+               result = adt_bytearray_trimLeft(&self->parseBuf, pResult);
+            }
+         }
+      }
+      if (result != ADT_NO_ERROR)
+      {
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = DTL_JSON_MEM_ERROR;
+      }
+      else if ( (self->limits.maxBytes != 0u) && (self->parseState != PARSE_STATE_ERROR) &&
+                ( (self->numBytes + adt_bytearray_length(&self->parseBuf)) > self->limits.maxBytes) )
+      {
+         //the unfinished token waiting for the next chunk counts against the memory limit
+         dtl_json_reader_set_limit_error(self);
+      }
+   }
+}
+
+static void dtl_json_reader_finish(dtl_json_reader_t *self)
+{
+   if ( (self != 0) && (self->parseState != PARSE_STATE_ERROR) )
+   {
+      const uint8_t *pBegin;
+      const uint8_t *pEnd;
+      const uint8_t *pResult;
+      self->eof = true;
+      pBegin = adt_bytearray_data(&self->parseBuf);
+      pEnd = pBegin + adt_bytearray_length(&self->parseBuf);
+      pResult = dtl_json_reader_parse_block(self, pBegin, pEnd);
+      if ( (pResult == pEnd) && (self->parseState == PARSE_STATE_NONE) )
+      {
+         self->parseComplete = true;
+      }
+      else if (self->lastError == DTL_JSON_NO_ERROR)
+      {
+         self->lastError = DTL_JSON_UNEXPECTED_EOB_ERROR;
+      }
+   }
+}
+
+static dtl_json_parser_status_t dtl_json_reader_status(const dtl_json_reader_t *self)
+{
+   if (self->parseState == PARSE_STATE_ERROR)
+   {
+      return DTL_JSON_PARSER_ERROR;
+   }
+   else if (self->parseState == PARSE_STATE_NONE)
+   {
+      return DTL_JSON_PARSER_DONE;
+   }
+   return DTL_JSON_PARSER_NEED_MORE;
+}
+
+static const uint8_t *dtl_json_reader_parse_block(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   const uint8_t *pNext = pBegin;
+
+   //POST_VALUE needs no input, running it right away lets a closed top-level container report DONE without waiting for more bytes
+   while( (self->parseState != PARSE_STATE_ERROR) &&
+          ( (pNext < pEnd) || (self->parseState == PARSE_STATE_POST_VALUE) ) )
+   {
+      const uint8_t *pResult;
+      const uint8_t *pMark = pNext;
+      parseState_t prevState = self->parseState;
+      uint8_t nextChar;
+
+      switch(self->parseState)
+      {
+      case PARSE_STATE_NONE:
+         //Top-level value is complete, only trailing whitespace is allowed
+         pNext = dtl_json_reader_lstrip(self, pNext, pEnd);
+         if (pNext < pEnd)
+         {
+            self->parseState = PARSE_STATE_ERROR;
+            self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+         }
+         break;
+      case PARSE_STATE_PRE_VALUE:
+         pNext = dtl_json_reader_lstrip(self, pNext, pEnd);
+         if (pNext < pEnd)
+         {
+            self->parseState = PARSE_STATE_VALUE;
+         }
+         break;
+      case PARSE_STATE_VALUE:
+         pResult = dtl_json_reader_parse_value(self, pNext, pEnd);
+         if (pResult > pNext)
+         {
+            pNext = pResult;
+         }
+         break;
+      case PARSE_STATE_POST_VALUE:
+         pNext = dtl_json_reader_lstrip(self, pNext, pEnd);
+         if (self->data->isArray)
+         {
+            if (self->handler == 0)
+            {
+               assert(self->data->parentElem != 0);
+               dtl_av_push((dtl_av_t*) self->data->parentElem, self->data->currentElem, false);
+               self->data->currentElem = (dtl_dv_t*) 0;
+            }
             self->parseState = PARSE_STATE_ARRAY_NEXT;
          }
          else if (self->data->isObject)
          {
-            assert(self->data->parentElem != 0);
-            dtl_hv_set_cstr((dtl_hv_t*) self->data->parentElem, adt_str_cstr(&self->data->objectKey), self->data->currentElem, false);
-            self->data->currentElem = (dtl_dv_t*) 0;
-            adt_str_clear(&self->data->objectKey);
+            if (self->handler == 0)
+            {
+               assert(self->data->parentElem != 0);
+               dtl_hv_set_cstr((dtl_hv_t*) self->data->parentElem, self->data->objectKey, self->data->currentElem, false);
+               self->data->currentElem = (dtl_dv_t*) 0;
+               self->data->objectKey = (const char*) 0;
+            }
             self->parseState = PARSE_STATE_OBJECT_NEXT;
          }
          else
@@ -338,19 +1233,17 @@ static const uint8_t *dtl_json_reader_parse_block(dtl_json_reader_t *self, const
             if (nextChar==']')
             {
                //empty array, no need to create child state
+               dtl_json_reader_emit_end(self, false);
                self->parseState = PARSE_STATE_POST_VALUE;
                pNext++;
             }
             else
             {
                //non-empty array, push current data and initiate child state
-               dtl_json_readerData_t *childData = dtl_json_readerData_new();
+               dtl_json_readerData_t *childData = dtl_json_reader_push_data(self);
                if (childData != 0)
                {
                   childData->isArray = true;
-                  childData->parentElem = self->data->currentElem;
-                  adt_stack_push(&self->stack, self->data);
-                  self->data = childData;
                   self->parseState = PARSE_STATE_PRE_VALUE;
                }
                else
@@ -362,25 +1255,28 @@ static const uint8_t *dtl_json_reader_parse_block(dtl_json_reader_t *self, const
          }
          break;
       case PARSE_STATE_ARRAY_NEXT:
-         if (nextChar == ',')
-         {
-            pNext++;
-            self->parseState = PARSE_STATE_PRE_VALUE;
-         }
-         else if(nextChar == ']')
+         pNext = dtl_json_reader_lstrip(self, pNext, pEnd);
+         if ( pNext < pEnd)
          {
-            pNext++;
-            dtl_dv_inc_ref(self->data->currentElem);
-            dtl_json_readerData_delete(self->data);
-            assert(adt_stack_size(&self->stack) > 0);
-            self->data = adt_stack_top(&self->stack);
-            adt_stack_pop(&self->stack);
-            self->parseState = PARSE_STATE_POST_VALUE;
-         }
-         else
-         {
-            self->parseState = PARSE_STATE_ERROR;
-            self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+            nextChar = *pNext;
+            if (nextChar == ',')
+            {
+               pNext++;
+               self->parseState = PARSE_STATE_PRE_VALUE;
+            }
+            else if(nextChar == ']')
+            {
+               pNext++;
+               dtl_json_reader_emit_end(self, false);
+               dtl_dv_inc_ref(self->data->currentElem);
+               dtl_json_reader_pop_data(self);
+               self->parseState = PARSE_STATE_POST_VALUE;
+            }
+            else
+            {
+               self->parseState = PARSE_STATE_ERROR;
+               self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+            }
          }
          break;
       case PARSE_STATE_OBJECT_BEGIN:
@@ -391,19 +1287,17 @@ static const uint8_t *dtl_json_reader_parse_block(dtl_json_reader_t *self, const
             if (nextChar=='}')
             {
                //empty object, no need to create child state
+               dtl_json_reader_emit_end(self, true);
                self->parseState = PARSE_STATE_POST_VALUE;
                pNext++;
             }
             else
             {
                //non-empty array, push current data and initiate child state
-               dtl_json_readerData_t *childData = dtl_json_readerData_new();
+               dtl_json_readerData_t *childData = dtl_json_reader_push_data(self);
                if (childData != 0)
                {
                   childData->isObject = true;
-                  childData->parentElem = self->data->currentElem;
-                  adt_stack_push(&self->stack, self->data);
-                  self->data = childData;
                   self->parseState = PARSE_STATE_OBJECT_KEY;
                }
                else
@@ -422,234 +1316,1541 @@ static const uint8_t *dtl_json_reader_parse_block(dtl_json_reader_t *self, const
             if (nextChar=='"')
             {
                const uint8_t *pInnerResult;
-               pInnerResult = bstr_parse_json_string_literal(&self->ctx, pNext, pEnd, &self->data->objectKey);
+               const char *pKey = (const char*) 0;
+               uint32_t keyLen = 0u;
+               pInnerResult = dtl_json_reader_parse_string_slice(self, pNext, pEnd, &pKey, &keyLen);
                if (pInnerResult > pNext)
                {
                   pNext = pInnerResult;
-                  if (adt_str_length(&self->data->objectKey) == 0)
+                  if (keyLen == 0u)
                   {
                      self->parseState = PARSE_STATE_ERROR;
                      self->lastError = DTL_JSON_EMPTY_KEY_ERROR;
                   }
-                  else
+                  else if (dtl_json_reader_count(self, 0u, (size_t) keyLen + 1u))
                   {
+                     pKey = dtl_json_reader_store_key(self, pKey, keyLen);
+                     if (pKey == 0)
+                     {
+                        self->parseState = PARSE_STATE_ERROR;
+                        self->lastError = DTL_JSON_MEM_ERROR;
+                        break;
+                     }
+                     if (self->handler != 0)
+                     {
+                        if (self->handler->on_key != 0)
+                        {
+                           self->handler->on_key(self->handlerArg, pKey, keyLen);
+                        }
+                     }
                      self->parseState = PARSE_STATE_OBJECT_SEP;
                   }
                }
-               else
+            }
+            //TODO: We should probably allow stray comma here to make it easier for the user
+            else
+            {
+               self->parseState = PARSE_STATE_ERROR;
+               self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+            }
+         }
+         break;
+      case PARSE_STATE_OBJECT_SEP:
+         pNext = dtl_json_reader_lstrip(self, pNext, pEnd);
+         if ( pNext < pEnd)
+         {
+            nextChar = *pNext;
+            if (nextChar==':')
+            {
+               pNext++;
+               self->parseState = PARSE_STATE_PRE_VALUE;
+            }
+            else
+            {
+               self->parseState = PARSE_STATE_ERROR;
+               self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+            }
+         }
+         break;
+      case PARSE_STATE_OBJECT_NEXT:
+         pNext = dtl_json_reader_lstrip(self, pNext, pEnd);
+         if ( pNext < pEnd)
+         {
+            nextChar = *pNext;
+            if (nextChar == ',')
+            {
+               pNext++;
+               self->parseState = PARSE_STATE_OBJECT_KEY;
+            }
+            else if(nextChar == '}')
+            {
+               pNext++;
+               dtl_json_reader_emit_end(self, true);
+               dtl_dv_inc_ref(self->data->currentElem);
+               dtl_json_reader_pop_data(self);
+               self->parseState = PARSE_STATE_POST_VALUE;
+            }
+            else
+            {
+               self->parseState = PARSE_STATE_ERROR;
+               self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+            }
+         }
+         break;
+      default:
+         assert(0);
+      }
+      if ( (pNext == pMark) && (self->parseState == prevState) )
+      {
+         //Current token continues beyond pEnd, wait for more data
+         break;
+      }
+   }
+   return pNext;
+}
+
+static const uint8_t *dtl_json_reader_parse_value(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   const uint8_t *pNext = pBegin;
+   if (pNext < pEnd)
+   {
+      const uint8_t *pResult = (const uint8_t*) 0;
+      int firstChar = (int) *pBegin;
+      if (bstr_pred_is_digit(firstChar) || firstChar == '-')
+      {
+         pResult = dtl_json_reader_parse_number(self, pNext, pEnd);
+         if (pResult > pBegin)
+         {
+            pNext = pResult;
+            self->parseState = PARSE_STATE_POST_VALUE;
+         }
+      }
+      else
+      {
+         if (self->handler != 0)
+         {
+            return dtl_json_reader_parse_event(self, pBegin, pEnd);
+         }
+         switch(firstChar)
+         {
+         case '"':
+            pResult = dtl_json_reader_parse_string(self, pNext, pEnd, &self->tmpStr);
+            if ( (pResult > pBegin) && dtl_json_reader_count(self, 1u, DTL_JSON_READER_VALUE_SIZE + (size_t) (pResult - pBegin)) )
+            {
+               self->data->currentElem = (dtl_dv_t*) dtl_sv_make_str(&self->tmpStr);
+               if (self->data->currentElem == 0)
                {
                   self->parseState = PARSE_STATE_ERROR;
-                  self->lastError = DTL_JSON_UNMATCHED_STRING_LITERAL;
+                  self->lastError = DTL_JSON_MEM_ERROR;
+                  break;
                }
+               pNext = pResult;
+               self->parseState = PARSE_STATE_POST_VALUE;
+            }
+            break;
+         case '[':
+            if ( (!dtl_json_reader_check_depth(self)) || (!dtl_json_reader_count(self, 1u, DTL_JSON_READER_VALUE_SIZE)) )
+            {
+               break;
+            }
+            self->data->currentElem = (dtl_dv_t*) dtl_av_new();
+            if (self->data->currentElem == 0)
+            {
+               self->parseState = PARSE_STATE_ERROR;
+               self->lastError = DTL_JSON_MEM_ERROR;
             }
-            //TODO: We should probably allow stray comma here to make it easier for the user
             else
+            {
+               self->parseState = PARSE_STATE_ARRAY_BEGIN;
+               pNext++;
+            }
+            break;
+         case '{':
+            if ( (!dtl_json_reader_check_depth(self)) || (!dtl_json_reader_count(self, 1u, DTL_JSON_READER_VALUE_SIZE)) )
+            {
+               break;
+            }
+            self->data->currentElem = (dtl_dv_t*) dtl_hv_new();
+            if (self->data->currentElem == 0)
             {
                self->parseState = PARSE_STATE_ERROR;
-               self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+               self->lastError = DTL_JSON_MEM_ERROR;
+            }
+            else
+            {
+               self->parseState = PARSE_STATE_OBJECT_BEGIN;
+               pNext++;
+            }
+            break;
+         case 'f':
+            pResult = dtl_json_reader_parse_literal(self, pNext, pEnd, "false");
+            if ( (pResult > pBegin) && dtl_json_reader_count(self, 1u, DTL_JSON_READER_VALUE_SIZE) )
+            {
+               self->data->currentElem = (dtl_dv_t*) dtl_sv_make_bool(false);
+               pNext = pResult;
+               self->parseState = PARSE_STATE_POST_VALUE;
+            }
+            break;
+         case 't':
+            pResult = dtl_json_reader_parse_literal(self, pNext, pEnd, "true");
+            if ( (pResult > pBegin) && dtl_json_reader_count(self, 1u, DTL_JSON_READER_VALUE_SIZE) )
+            {
+               self->data->currentElem = (dtl_dv_t*) dtl_sv_make_bool(true);
+               pNext = pResult;
+               self->parseState = PARSE_STATE_POST_VALUE;
+            }
+            break;
+         case 'n':
+            pResult = dtl_json_reader_parse_literal(self, pNext, pEnd, "null");
+            if ( (pResult > pBegin) && dtl_json_reader_count(self, 1u, DTL_JSON_READER_VALUE_SIZE) )
+            {
+               self->data->currentElem = (dtl_dv_t*) dtl_sv_none();
+               pNext = pResult;
+               self->parseState = PARSE_STATE_POST_VALUE;
             }
+            break;
+         default:
+            self->parseState = PARSE_STATE_ERROR;
+            self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+         }
+      }
+   }
+   return pNext;
+}
+
+/**
+ * Handler version of dtl_json_reader_parse_value for non-numeric values.
+ * Reports the value to the handler rather than creating a dtl value.
+ */
+static const uint8_t *dtl_json_reader_parse_event(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   const uint8_t *pNext = pBegin;
+   const uint8_t *pResult;
+   const dtl_json_handler_t *handler = self->handler;
+   const char *pStr = (const char*) 0;
+   uint32_t strLen = 0u;
+
+   switch(*pBegin)
+   {
+   case '"':
+      pResult = dtl_json_reader_parse_string_slice(self, pNext, pEnd, &pStr, &strLen);
+      if (pResult > pBegin)
+      {
+         if (handler->on_string != 0)
+         {
+            handler->on_string(self->handlerArg, pStr, strLen);
+         }
+         pNext = pResult;
+         self->parseState = PARSE_STATE_POST_VALUE;
+      }
+      break;
+   case '[':
+      dtl_json_reader_emit_begin(self, false);
+      self->parseState = PARSE_STATE_ARRAY_BEGIN;
+      pNext++;
+      break;
+   case '{':
+      dtl_json_reader_emit_begin(self, true);
+      self->parseState = PARSE_STATE_OBJECT_BEGIN;
+      pNext++;
+      break;
+   case 'f':
+   case 't':
+      pResult = dtl_json_reader_parse_literal(self, pNext, pEnd, (*pBegin == 't')? "true" : "false");
+      if (pResult > pBegin)
+      {
+         if (handler->on_bool != 0)
+         {
+            handler->on_bool(self->handlerArg, (*pBegin == 't'));
+         }
+         pNext = pResult;
+         self->parseState = PARSE_STATE_POST_VALUE;
+      }
+      break;
+   case 'n':
+      pResult = dtl_json_reader_parse_literal(self, pNext, pEnd, "null");
+      if (pResult > pBegin)
+      {
+         if (handler->on_null != 0)
+         {
+            handler->on_null(self->handlerArg);
+         }
+         pNext = pResult;
+         self->parseState = PARSE_STATE_POST_VALUE;
+      }
+      break;
+   default:
+      self->parseState = PARSE_STATE_ERROR;
+      self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+   }
+   return pNext;
+}
+
+/**
+ * Integers are stored in the narrowest of DTL_SV_I32, DTL_SV_U32, DTL_SV_I64 and DTL_SV_U64 that holds the value.
+ * Other numbers are stored as DTL_SV_DBL.
+ * The number is counted against the limits before the value is created or passed to the handler.
+ */
+static const uint8_t *dtl_json_reader_parse_number(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   dtl_json_number_t number;
+   int64_t i64;
+   uint64_t u64;
+   const uint8_t *pNext = pBegin;
+   const uint8_t *pResult = pBegin;
+   while ( (pResult < pEnd) && dtl_json_reader_pred_is_number_char((int) *pResult) )
+   {
+      pResult++;
+   }
+   if ( (pResult == pEnd) && (!self->eof) )
+   {
+      //number may continue in next chunk
+      return pBegin;
+   }
+   pResult = dtl_json_number_parse(pBegin, pResult, &number);
+   if (pResult == 0)
+   {
+      self->parseState = PARSE_STATE_ERROR;
+      self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+   }
+   else if (!dtl_json_reader_count(self, 1u, DTL_JSON_READER_VALUE_SIZE))
+   {
+      //limit exceeded, the reader is now in error state
+   }
+   else if (dtl_json_number_to_i64(&number, &i64))
+   {
+      if (self->handler != 0)
+      {
+         if (self->handler->on_int != 0)
+         {
+            self->handler->on_int(self->handlerArg, i64);
+         }
+      }
+      else if ( (i64 >= INT32_MIN) && (i64 <= INT32_MAX) )
+      {
+         self->data->currentElem = (dtl_dv_t*) dtl_sv_make_i32((int32_t) i64);
+      }
+      else if ( (i64 > 0) && (i64 <= UINT32_MAX) )
+      {
+         self->data->currentElem = (dtl_dv_t*) dtl_sv_make_u32((uint32_t) i64);
+      }
+      else
+      {
+         self->data->currentElem = (dtl_dv_t*) dtl_sv_make_i64(i64);
+      }
+      pNext = pResult;
+   }
+   else if (dtl_json_number_to_u64(&number, &u64))
+   {
+      //above INT64_MAX
+      if (self->handler != 0)
+      {
+         if (self->handler->on_uint != 0)
+         {
+            self->handler->on_uint(self->handlerArg, u64);
+         }
+         else if (self->handler->on_double != 0)
+         {
+            self->handler->on_double(self->handlerArg, (double) u64);
+         }
+      }
+      else
+      {
+         self->data->currentElem = (dtl_dv_t*) dtl_sv_make_u64(u64);
+      }
+      pNext = pResult;
+   }
+   else
+   {
+      //fraction, exponent or integer outside of [INT64_MIN, UINT64_MAX]
+      double value = dtl_json_number_to_double(&number);
+      if (self->handler != 0)
+      {
+         if (self->handler->on_double != 0)
+         {
+            self->handler->on_double(self->handlerArg, value);
+         }
+      }
+      else
+      {
+         self->data->currentElem = (dtl_dv_t*) dtl_sv_make_dbl(value);
+      }
+      pNext = pResult;
+   }
+   return pNext;
+}
+
+/**
+ * Parses a string literal into str.
+ * Strings without escape sequences are copied directly from the input, others are unescaped by bstr.
+ * Returns pBegin without any state change when the closing quote has not yet been received.
+ */
+static const uint8_t *dtl_json_reader_parse_string(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, adt_str_t *str)
+{
+   bool isPlain = false;
+   const uint8_t *pResult = dtl_json_scan_string_end(pBegin, pEnd, &isPlain);
+   if (pResult == 0)
+   {
+      if (self->eof)
+      {
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = DTL_JSON_UNMATCHED_STRING_LITERAL;
+      }
+      return pBegin;
+   }
+   if (!dtl_json_reader_check_string(self, pBegin, pResult))
+   {
+      return pBegin;
+   }
+   if (isPlain)
+   {
+      if (adt_str_set_bstr(str, pBegin + 1, pResult - 1) != ADT_NO_ERROR)
+      {
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = DTL_JSON_MEM_ERROR;
+         return pBegin;
+      }
+      return pResult;
+   }
+   adt_str_clear(str);
+   if (bstr_parse_json_string_literal(&self->ctx, pBegin, pResult, str) != pResult)
+   {
+      self->parseState = PARSE_STATE_ERROR;
+      self->lastError = DTL_JSON_UNMATCHED_STRING_LITERAL;
+      return pBegin;
+   }
+   return pResult;
+}
+
+/**
+ * Parses a string literal and returns its content as a (pointer, length) slice.
+ * Strings without escape sequences are returned as a slice of the input, others are unescaped into tmpStr.
+ */
+static const uint8_t *dtl_json_reader_parse_string_slice(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, const char **ppStr, uint32_t *pStrLen)
+{
+   bool isPlain = false;
+   const uint8_t *pResult = dtl_json_scan_string_end(pBegin, pEnd, &isPlain);
+   if (pResult == 0)
+   {
+      if (self->eof)
+      {
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = DTL_JSON_UNMATCHED_STRING_LITERAL;
+      }
+      return pBegin;
+   }
+   if (!dtl_json_reader_check_string(self, pBegin, pResult))
+   {
+      return pBegin;
+   }
+   if (isPlain)
+   {
+      *ppStr = (const char*) (pBegin + 1);
+      *pStrLen = (uint32_t) (pResult - pBegin - 2);
+   }
+   else
+   {
+      if (dtl_json_reader_parse_string(self, pBegin, pResult, &self->tmpStr) != pResult)
+      {
+         return pBegin;
+      }
+      *ppStr = adt_str_cstr(&self->tmpStr);
+      *pStrLen = (uint32_t) adt_str_size(&self->tmpStr); //byte size, may contain \u0000
+   }
+   return pResult;
+}
+
+/**
+ * Matches one of the literals true, false or null.
+ * Returns pBegin without any state change when the input ends in the middle of the literal.
+ */
+static const uint8_t *dtl_json_reader_parse_literal(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, const char *literal)
+{
+   const uint8_t *pResult = bstr_match_cstr(pBegin, pEnd, literal);
+   if ( (pResult == 0) || (pResult <= pBegin) )
+   {
+      size_t remain = (size_t) (pEnd - pBegin);
+      if ( (self->eof) || (remain >= strlen(literal)) || (memcmp(pBegin, literal, remain) != 0) )
+      {
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+      }
+      pResult = pBegin;
+   }
+   return pResult;
+}
+
+
+static const uint8_t *dtl_json_reader_lstrip(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   return dtl_json_scan_whitespace(pBegin, pEnd, &self->lineNumber);
+}
+
+/**
+ * Returns the key to pass on. DOM loads copy the key into the frame, null-terminated for dtl_hv_set_cstr.
+ * In handler mode the slice itself is returned, unless the caller shared a key pool that holds the key or has room for it.
+ */
+static const char *dtl_json_reader_store_key(dtl_json_reader_t *self, const char *pKey, uint32_t keyLen)
+{
+   const uint8_t *pBegin = (const uint8_t*) pKey;
+   const char *retval = pKey;
+   if (self->handler == 0)
+   {
+      if (adt_str_set_bstr(&self->data->keyBuf, pBegin, pBegin + keyLen) != ADT_NO_ERROR)
+      {
+         return (const char*) 0;
+      }
+      retval = adt_str_cstr(&self->data->keyBuf);
+      self->data->objectKey = retval;
+   }
+   else if (self->keys != 0)
+   {
+      const char *pooled = dtl_json_intern_bstr(self->keys, pBegin, pBegin + keyLen);
+      if (pooled != 0)
+      {
+         retval = pooled;
+      }
+   }
+   return retval;
+}
+
+static bool dtl_json_reader_pred_is_number_char(int c)
+{
+   return ( bstr_pred_is_digit(c) || (c == '-') || (c == '+') || (c == '.') || (c == 'e') || (c == 'E') );
+}
+
+/**
+ * Adds numElements values and numBytes estimated bytes to the current document.
+ * Returns false and puts the reader in error state when this exceeds the limits.
+ */
+static bool dtl_json_reader_count(dtl_json_reader_t *self, uint32_t numElements, size_t numBytes)
+{
+   self->numElements += numElements;
+   self->numBytes += numBytes;
+   if ( ( (self->limits.maxElements != 0u) && (self->numElements > self->limits.maxElements) ) ||
+        ( (self->limits.maxBytes != 0u) && (self->numBytes > self->limits.maxBytes) ) )
+   {
+      dtl_json_reader_set_limit_error(self);
+      return false;
+   }
+   return true;
+}
+
+/**
+ * Checks that an array or object can be opened at the current depth.
+ */
+static bool dtl_json_reader_check_depth(dtl_json_reader_t *self)
+{
+   if ( (self->limits.maxDepth != 0u) && ( (uint32_t) self->depth >= self->limits.maxDepth) )
+   {
+      dtl_json_reader_set_limit_error(self);
+      return false;
+   }
+   return true;
+}
+
+/**
+ * Checks the length of the string literal between pBegin (opening quote) and pEnd (after closing quote).
+ */
+static bool dtl_json_reader_check_string(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   if ( (self->limits.maxStringLength != 0u) && ( (size_t) (pEnd - pBegin - 2) > (size_t) self->limits.maxStringLength) )
+   {
+      dtl_json_reader_set_limit_error(self);
+      return false;
+   }
+   return true;
+}
+
+/**
+ * Stops parsing. The values created so far are still owned by the frames and are released when the reader is reset or destroyed.
+ */
+static void dtl_json_reader_set_limit_error(dtl_json_reader_t *self)
+{
+   self->parseState = PARSE_STATE_ERROR;
+   self->lastError = DTL_JSON_LIMIT_ERROR;
+}
+
+static void dtl_json_reader_emit_begin(dtl_json_reader_t *self, bool isObject)
+{
+   if (self->handler != 0)
+   {
+      void (*callback)(void *arg) = isObject? self->handler->on_begin_object : self->handler->on_begin_array;
+      if (callback != 0)
+      {
+         callback(self->handlerArg);
+      }
+   }
+}
+
+static void dtl_json_reader_emit_end(dtl_json_reader_t *self, bool isObject)
+{
+   if (self->handler != 0)
+   {
+      void (*callback)(void *arg) = isObject? self->handler->on_end_object : self->handler->on_end_array;
+      if (callback != 0)
+      {
+         callback(self->handlerArg);
+      }
+   }
+}
+
+/**
+ * Structural index engine: builds the index of the whole buffer (stage 1) and then walks it (stage 2).
+ * The index is kept in the reader so that a reused reader does not allocate it again.
+ * Returns true when the buffer holds exactly one valid JSON value.
+ */
+static bool dtl_json_reader_parse_indexed(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   dtl_json_error_t result = dtl_json_index_build(&self->index, pBegin, pEnd);
+   if (result == DTL_JSON_UNMATCHED_STRING_LITERAL)
+   {
+      //the index is complete up to the unterminated string, walk it to find the first error and its line
+      dtl_json_reader_parse_index(self, pBegin, pEnd, &self->index);
+      if (self->parseState != PARSE_STATE_ERROR)
+      {
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = result;
+      }
+   }
+   else if (result == DTL_JSON_NO_ERROR)
+   {
+      dtl_json_reader_parse_index(self, pBegin, pEnd, &self->index);
+   }
+   else
+   {
+      self->parseState = PARSE_STATE_ERROR;
+      self->lastError = result;
+   }
+   return (self->parseState == PARSE_STATE_NONE);
+}
+
+/**
+ * Stage 2 of the structural index engine.
+ * Uses the same frames and parse states as dtl_json_reader_parse_block but moves from token to token
+ * using the index, never looking at whitespace or string content.
+ */
+static void dtl_json_reader_parse_index(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_index_t *index)
+{
+   uint32_t i = 0u;
+   uint32_t tokenIndex = 0u; //index position of the token being parsed
+   self->parseState = PARSE_STATE_VALUE;
+   while (self->parseState != PARSE_STATE_ERROR)
+   {
+      uint8_t nextChar;
+      if (self->parseState == PARSE_STATE_POST_VALUE)
+      {
+         if (self->data->isArray)
+         {
+            assert(self->data->parentElem != 0);
+            dtl_av_push((dtl_av_t*) self->data->parentElem, self->data->currentElem, false);
+            self->data->currentElem = (dtl_dv_t*) 0;
+            self->parseState = PARSE_STATE_ARRAY_NEXT;
+         }
+         else if (self->data->isObject)
+         {
+            assert(self->data->parentElem != 0);
+            dtl_hv_set_cstr((dtl_hv_t*) self->data->parentElem, self->data->objectKey, self->data->currentElem, false);
+            self->data->currentElem = (dtl_dv_t*) 0;
+            self->data->objectKey = (const char*) 0;
+            self->parseState = PARSE_STATE_OBJECT_NEXT;
+         }
+         else
+         {
+            self->parseState = PARSE_STATE_NONE;
+         }
+         continue;
+      }
+      if (i >= index->count)
+      {
+         tokenIndex = index->count;
+         if (self->parseState != PARSE_STATE_NONE)
+         {
+            self->parseState = PARSE_STATE_ERROR;
+            self->lastError = DTL_JSON_UNEXPECTED_EOB_ERROR;
+         }
+         break;
+      }
+      tokenIndex = i;
+      nextChar = pBegin[index->positions[i]];
+      switch(self->parseState)
+      {
+      case PARSE_STATE_NONE:
+         //Top-level value is complete, only trailing whitespace is allowed
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+         break;
+      case PARSE_STATE_VALUE:
+         i = dtl_json_reader_parse_index_value(self, pBegin, pEnd, index, i);
+         break;
+      case PARSE_STATE_ARRAY_NEXT:
+         i++;
+         if (nextChar == ',')
+         {
+            self->parseState = PARSE_STATE_VALUE;
+         }
+         else if (nextChar == ']')
+         {
+            dtl_json_reader_pop_data(self);
+            self->parseState = PARSE_STATE_POST_VALUE;
+         }
+         else
+         {
+            self->parseState = PARSE_STATE_ERROR;
+            self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+         }
+         break;
+      case PARSE_STATE_OBJECT_KEY:
+         i = dtl_json_reader_parse_index_key(self, pBegin, index, i);
+         break;
+      case PARSE_STATE_OBJECT_SEP:
+         i++;
+         if (nextChar == ':')
+         {
+            self->parseState = PARSE_STATE_VALUE;
+         }
+         else
+         {
+            self->parseState = PARSE_STATE_ERROR;
+            self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+         }
+         break;
+      case PARSE_STATE_OBJECT_NEXT:
+         i++;
+         if (nextChar == ',')
+         {
+            self->parseState = PARSE_STATE_OBJECT_KEY;
+         }
+         else if (nextChar == '}')
+         {
+            dtl_json_reader_pop_data(self);
+            self->parseState = PARSE_STATE_POST_VALUE;
+         }
+         else
+         {
+            self->parseState = PARSE_STATE_ERROR;
+            self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+         }
+         break;
+      default:
+         assert(0);
+      }
+   }
+   if (self->parseState == PARSE_STATE_ERROR)
+   {
+      dtl_json_reader_set_error_line(self, pBegin, (tokenIndex < index->count)? pBegin + index->positions[tokenIndex] : pEnd);
+   }
+}
+
+/**
+ * Parses the value starting at index position i. Returns the index position following the value
+ * (for containers, the position following the opening bracket unless the container is empty).
+ */
+static uint32_t dtl_json_reader_parse_index_value(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_index_t *index, uint32_t i)
+{
+   const uint8_t *pToken = pBegin + index->positions[i];
+   const uint8_t *pTokenEnd = (i + 1u < index->count)? pBegin + index->positions[i + 1u] : pEnd;
+   dtl_json_readerData_t *childData;
+   switch(*pToken)
+   {
+   case '"':
+      //the next position is always the closing quote
+      if ( (i + 1u >= index->count) ||
+           (dtl_json_reader_parse_string(self, pToken, pTokenEnd + 1, &self->tmpStr) != (pTokenEnd + 1)) )
+      {
+         if (self->parseState != PARSE_STATE_ERROR)
+         {
+            self->parseState = PARSE_STATE_ERROR;
+            self->lastError = DTL_JSON_UNMATCHED_STRING_LITERAL;
+         }
+         break;
+      }
+      if (!dtl_json_reader_count(self, 1u, DTL_JSON_READER_VALUE_SIZE + (size_t) (pTokenEnd + 1 - pToken)))
+      {
+         break;
+      }
+      self->data->currentElem = (dtl_dv_t*) dtl_sv_make_str(&self->tmpStr);
+      if (self->data->currentElem == 0)
+      {
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = DTL_JSON_MEM_ERROR;
+         break;
+      }
+      self->parseState = PARSE_STATE_POST_VALUE;
+      return i + 2u;
+   case '[':
+   case '{':
+      if ( (!dtl_json_reader_check_depth(self)) || (!dtl_json_reader_count(self, 1u, DTL_JSON_READER_VALUE_SIZE)) )
+      {
+         break;
+      }
+      self->data->currentElem = (*pToken == '[')? (dtl_dv_t*) dtl_av_new() : (dtl_dv_t*) dtl_hv_new();
+      if (self->data->currentElem == 0)
+      {
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = DTL_JSON_MEM_ERROR;
+         break;
+      }
+      if ( (pTokenEnd < pEnd) && (*pTokenEnd == ( (*pToken == '[')? ']' : '}') ) )
+      {
+         //empty container, no need to create child state
+         self->parseState = PARSE_STATE_POST_VALUE;
+         return i + 2u;
+      }
+      childData = dtl_json_reader_push_data(self);
+      if (childData == 0)
+      {
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = DTL_JSON_MEM_ERROR;
+         break;
+      }
+      if (*pToken == '[')
+      {
+         childData->isArray = true;
+         self->parseState = PARSE_STATE_VALUE;
+      }
+      else
+      {
+         childData->isObject = true;
+         self->parseState = PARSE_STATE_OBJECT_KEY;
+      }
+      return i + 1u;
+   default:
+      if (dtl_json_reader_parse_index_scalar(self, pToken, pTokenEnd))
+      {
+         self->parseState = PARSE_STATE_POST_VALUE;
+         return i + 1u;
+      }
+   }
+   return i;
+}
+
+/**
+ * Parses the object key at index position i together with the following ':'. Returns the index position after the ':'.
+ */
+static uint32_t dtl_json_reader_parse_index_key(dtl_json_reader_t *self, const uint8_t *pBegin, const dtl_json_index_t *index, uint32_t i)
+{
+   const uint8_t *pToken = pBegin + index->positions[i];
+   const uint8_t *pClose;
+   const char *pKey = (const char*) 0;
+   uint32_t keyLen = 0u;
+   if ( (*pToken != '"') || (i + 1u >= index->count) )
+   {
+      self->parseState = PARSE_STATE_ERROR;
+      self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+      return i;
+   }
+   pClose = pBegin + index->positions[i + 1u];
+   if (dtl_json_reader_parse_string_slice(self, pToken, pClose + 1, &pKey, &keyLen) != (pClose + 1))
+   {
+      if (self->parseState != PARSE_STATE_ERROR)
+      {
+         self->parseState = PARSE_STATE_ERROR;
+         self->lastError = DTL_JSON_UNMATCHED_STRING_LITERAL;
+      }
+      return i;
+   }
+   if (keyLen == 0u)
+   {
+      self->parseState = PARSE_STATE_ERROR;
+      self->lastError = DTL_JSON_EMPTY_KEY_ERROR;
+      return i;
+   }
+   if (!dtl_json_reader_count(self, 0u, (size_t) keyLen + 1u))
+   {
+      return i;
+   }
+   if (dtl_json_reader_store_key(self, pKey, keyLen) == 0)
+   {
+      self->parseState = PARSE_STATE_ERROR;
+      self->lastError = DTL_JSON_MEM_ERROR;
+      return i;
+   }
+   self->parseState = PARSE_STATE_OBJECT_SEP;
+   return i + 2u;
+}
+
+/**
+ * Parses number, true, false or null. The token must cover everything up to the next structural character except trailing whitespace.
+ * The value is counted against the limits before it is created.
+ */
+static bool dtl_json_reader_parse_index_scalar(dtl_json_reader_t *self, const uint8_t *pToken, const uint8_t *pTokenEnd)
+{
+   const uint8_t *pResult = (const uint8_t*) 0;
+   int firstChar = (int) *pToken;
+   while ( (pTokenEnd > pToken) &&
+           ( (pTokenEnd[-1] == ' ') || (pTokenEnd[-1] == '\n') || (pTokenEnd[-1] == '\r') || (pTokenEnd[-1] == '\t') ) )
+   {
+      pTokenEnd--;
+   }
+   if (bstr_pred_is_digit(firstChar) || (firstChar == '-') )
+   {
+      pResult = dtl_json_reader_parse_number(self, pToken, pTokenEnd);
+      if (self->parseState == PARSE_STATE_ERROR)
+      {
+         return false;
+      }
+   }
+   else if (!dtl_json_reader_count(self, 1u, DTL_JSON_READER_VALUE_SIZE))
+   {
+      return false;
+   }
+   else if (firstChar == 't')
+   {
+      pResult = dtl_json_reader_parse_literal(self, pToken, pTokenEnd, "true");
+      self->data->currentElem = (dtl_dv_t*) dtl_sv_make_bool(true);
+   }
+   else if (firstChar == 'f')
+   {
+      pResult = dtl_json_reader_parse_literal(self, pToken, pTokenEnd, "false");
+      self->data->currentElem = (dtl_dv_t*) dtl_sv_make_bool(false);
+   }
+   else if (firstChar == 'n')
+   {
+      pResult = dtl_json_reader_parse_literal(self, pToken, pTokenEnd, "null");
+      self->data->currentElem = (dtl_dv_t*) dtl_sv_none();
+   }
+   if (pResult != pTokenEnd)
+   {
+      //the frame is reset (and the value released) by dtl_json_reader_destroy
+      self->parseState = PARSE_STATE_ERROR;
+      self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+      return false;
+   }
+   return true;
+}
+
+/**
+ * The structural index engine does not count lines while parsing. After an error, lineNumber is set to the line of pError.
+ */
+static void dtl_json_reader_set_error_line(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pError)
+{
+   const uint8_t *pNext = pBegin;
+   uint32_t lineNumber = 1u;
+   while (pNext < pError)
+   {
+      pNext = (const uint8_t*) memchr(pNext, '\n', (size_t) (pError - pNext));
+      if (pNext == 0)
+      {
+         break;
+      }
+      lineNumber++;
+      pNext++;
+   }
+   self->lineNumber = lineNumber;
+}
+
+static void dtl_json_lines_create(dtl_json_lines_t *self, dtl_json_line_func_t callback, void *arg)
+{
+   dtl_json_reader_create(&self->reader);
+   adt_bytearray_create(&self->pending, ADT_BYTE_ARRAY_DEFAULT_GROW_SIZE);
+   self->callback = callback;
+   self->arg = arg;
+   self->lineNumber = 1u;
+   self->lastError = DTL_JSON_NO_ERROR;
+   self->isStopped = false;
+}
+
+static void dtl_json_lines_destroy(dtl_json_lines_t *self)
+{
+   dtl_json_reader_destroy(&self->reader);
+   adt_bytearray_destroy(&self->pending);
+}
+
+/**
+ * Parses all complete lines. The unterminated line at the end of the chunk is kept in pending until its newline arrives.
+ */
+static void dtl_json_lines_readChunk(void *arg, const uint8_t *pChunk, uint32_t chunkLen)
+{
+   dtl_json_lines_t *self = (dtl_json_lines_t*) arg;
+   adt_error_t result = ADT_NO_ERROR;
+   if ( (self->isStopped) || (pChunk == 0) || (chunkLen == 0u) )
+   {
+      return;
+   }
+   if (adt_bytearray_length(&self->pending) == 0u)
+   {
+      const uint8_t *pEnd = pChunk + chunkLen;
+      const uint8_t *pResult = dtl_json_lines_parse_block(self, pChunk, pEnd);
+      if ( (!self->isStopped) && (pResult < pEnd) )
+      {
+         result = adt_bytearray_append(&self->pending, pResult, (uint32_t) (pEnd - pResult));
+      }
+   }
+   else
+   {
+      bool hasNewLine = (memchr(pChunk, '\n', chunkLen) != 0);
+      result = adt_bytearray_append(&self->pending, pChunk, chunkLen);
+      if ( (result == ADT_NO_ERROR) && hasNewLine )
+      {
+         const uint8_t *pBegin = adt_bytearray_data(&self->pending);
+         const uint8_t *pResult = dtl_json_lines_parse_block(self, pBegin, pBegin + adt_bytearray_length(&self->pending));
+         result = adt_bytearray_trimLeft(&self->pending, pResult);
+      }
+   }
+   if (result != ADT_NO_ERROR)
+   {
+      self->lastError = DTL_JSON_MEM_ERROR;
+      self->isStopped = true;
+   }
+}
+
+/**
+ * Parses each line terminated by a newline character. Returns pointer to the beginning of the unterminated line (or pEnd).
+ */
+static const uint8_t *dtl_json_lines_parse_block(dtl_json_lines_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   const uint8_t *pNext = pBegin;
+   while ( (!self->isStopped) && (pNext < pEnd) )
+   {
+      const uint8_t *pLineEnd = (const uint8_t*) memchr(pNext, '\n', (size_t) (pEnd - pNext));
+      if (pLineEnd == 0)
+      {
+         break;
+      }
+      dtl_json_lines_parse_line(self, pNext, pLineEnd);
+      pNext = pLineEnd + 1;
+   }
+   return pNext;
+}
+
+/**
+ * Parses one record and passes it to the callback. Blank lines are skipped. pEnd points to the newline character (or end of input).
+ */
+static void dtl_json_lines_parse_line(dtl_json_lines_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   dtl_json_reader_t *reader = &self->reader;
+   uint32_t lineNumber = self->lineNumber++;
+   const uint8_t *pNext;
+   const uint8_t *pResult;
+   dtl_json_reader_reset(reader);
+   pNext = dtl_json_reader_lstrip(reader, pBegin, pEnd);
+   if (pNext == pEnd)
+   {
+      return;
+   }
+   reader->eof = true;
+   pResult = dtl_json_reader_parse_block(reader, pNext, pEnd);
+   if ( (pResult == pEnd) && (reader->parseState == PARSE_STATE_NONE) && (reader->data->currentElem != 0) )
+   {
+      dtl_dv_t *dv = reader->data->currentElem;
+      reader->data->currentElem = (dtl_dv_t*) 0;
+      if (!self->callback(self->arg, lineNumber, dv, DTL_JSON_NO_ERROR))
+      {
+         self->isStopped = true;
+      }
+      dtl_dv_dec_ref(dv);
+   }
+   else
+   {
+      dtl_json_error_t errorCode = (reader->lastError != DTL_JSON_NO_ERROR)? reader->lastError : DTL_JSON_UNEXPECTED_EOB_ERROR;
+      if (!self->callback(self->arg, lineNumber, (dtl_dv_t*) 0, errorCode))
+      {
+         self->lastError = errorCode;
+         self->isStopped = true;
+      }
+   }
+}
+
+/**
+ * Allocates the workers. Readers are created once and reused for every range and batch.
+ */
+static bool dtl_json_lines_parallel_create(dtl_json_lines_parallel_t *self, uint32_t numWorkers, bool isOrdered, dtl_json_line_func_t callback, void *arg)
+{
+   uint32_t i;
+   self->workers = (dtl_json_lines_worker_t*) malloc(sizeof(dtl_json_lines_worker_t) * (size_t) numWorkers);
+   if (self->workers == 0)
+   {
+      return false;
+   }
+   self->numWorkers = numWorkers;
+   self->isOrdered = isOrdered;
+   self->callback = callback;
+   self->arg = arg;
+   self->lastError = DTL_JSON_NO_ERROR;
+   self->isStopped = false;
+#ifndef _WIN32
+   pthread_mutex_init(&self->lock, (const pthread_mutexattr_t*) 0);
+#endif
+   for (i = 0u; i < numWorkers; i++)
+   {
+      dtl_json_lines_worker_t *worker = &self->workers[i];
+      dtl_json_lines_create(&worker->lines, isOrdered? dtl_json_lines_worker_collect : dtl_json_lines_worker_forward, (void*) worker);
+      worker->shared = self;
+      worker->pBegin = (const uint8_t*) 0;
+      worker->pEnd = (const uint8_t*) 0;
+      worker->records = (dtl_json_lines_record_t*) 0;
+      worker->numRecords = 0u;
+      worker->recordCapacity = 0u;
+      worker->numLines = 0u;
+      worker->lineOffset = 0u;
+      worker->isCounting = false;
+      worker->isOutOfMemory = false;
+   }
+   return true;
+}
+
+static void dtl_json_lines_parallel_destroy(dtl_json_lines_parallel_t *self)
+{
+   uint32_t i;
+   for (i = 0u; i < self->numWorkers; i++)
+   {
+      dtl_json_lines_worker_t *worker = &self->workers[i];
+      dtl_json_lines_worker_clear(worker);
+      if (worker->records != 0)
+      {
+         free(worker->records);
+      }
+      dtl_json_lines_destroy(&worker->lines);
+   }
+   free(self->workers);
+#ifndef _WIN32
+   pthread_mutex_destroy(&self->lock);
+#endif
+}
+
+/**
+ * Divides [pBegin, pEnd) into one range per worker. Each range ends right after a newline character (or at pEnd), some ranges may be empty.
+ */
+static void dtl_json_lines_parallel_split(dtl_json_lines_parallel_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   uint32_t i;
+   size_t inputLen = (size_t) (pEnd - pBegin);
+   const uint8_t *pNext = pBegin;
+   for (i = 0u; i < self->numWorkers; i++)
+   {
+      dtl_json_lines_worker_t *worker = &self->workers[i];
+      const uint8_t *pTarget = pBegin + (size_t) ( ( (uint64_t) inputLen * (i + 1u) ) / self->numWorkers);
+      if ( (i + 1u == self->numWorkers) || (pTarget >= pEnd) )
+      {
+         pTarget = pEnd;
+      }
+      else if (pTarget > pNext)
+      {
+         //move forward to the character after the next newline
+         const uint8_t *pNewLine = (const uint8_t*) memchr(pTarget - 1, '\n', (size_t) (pEnd - pTarget + 1));
+         pTarget = (pNewLine != 0)? pNewLine + 1 : pEnd;
+      }
+      else
+      {
+         pTarget = pNext;
+      }
+      worker->pBegin = pNext;
+      worker->pEnd = pTarget;
+      pNext = pTarget;
+   }
+}
+
+/**
+ * Parses one batch at a time. Workers keep their records and the calling thread passes them to the callback in line order
+ * once the whole batch has been parsed.
+ */
+static void dtl_json_lines_parallel_ordered(dtl_json_lines_parallel_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   const uint8_t *pNext = pBegin;
+   uint32_t lineNumber = 1u;
+   size_t batchSize = (size_t) DTL_JSON_LINES_RANGE_SIZE * self->numWorkers;
+   while ( (!self->isStopped) && (pNext < pEnd) )
+   {
+      uint32_t i;
+      const uint8_t *pBatchEnd = pEnd;
+      if ( (size_t) (pEnd - pNext) > batchSize)
+      {
+         const uint8_t *pNewLine = (const uint8_t*) memchr(pNext + batchSize - 1, '\n', (size_t) (pEnd - pNext) - batchSize + 1u);
+         pBatchEnd = (pNewLine != 0)? pNewLine + 1 : pEnd;
+      }
+      dtl_json_lines_parallel_split(self, pNext, pBatchEnd);
+      dtl_json_reader_run_threads(dtl_json_lines_worker_run, (void*) self->workers, sizeof(dtl_json_lines_worker_t), self->numWorkers);
+      for (i = 0u; i < self->numWorkers; i++)
+      {
+         uint32_t j;
+         dtl_json_lines_worker_t *worker = &self->workers[i];
+         if ( (worker->isOutOfMemory) && (!self->isStopped) )
+         {
+            self->lastError = DTL_JSON_MEM_ERROR;
+            self->isStopped = true;
          }
-         break;
-      case PARSE_STATE_OBJECT_SEP:
-         pNext = dtl_json_reader_lstrip(self, pNext, pEnd);
-         if ( pNext < pEnd)
+         for (j = 0u; (!self->isStopped) && (j < worker->numRecords); j++)
          {
-            nextChar = *pNext;
-            if (nextChar==':')
+            dtl_json_lines_record_t *record = &worker->records[j];
+            if (!self->callback(self->arg, lineNumber + record->lineNumber - 1u, record->dv, record->errorCode))
             {
-               pNext++;
-               self->parseState = PARSE_STATE_PRE_VALUE;
+               if (record->dv == 0)
+               {
+                  self->lastError = record->errorCode;
+               }
+               self->isStopped = true;
             }
          }
-         break;
-      case PARSE_STATE_OBJECT_NEXT:
-         if (nextChar == ',')
-         {
-            pNext++;
-            self->parseState = PARSE_STATE_OBJECT_KEY;
-         }
-         else if(nextChar == '}')
-         {
-            pNext++;
-            dtl_dv_inc_ref(self->data->currentElem);
-            dtl_json_readerData_delete(self->data);
-            assert(adt_stack_size(&self->stack) > 0);
-            self->data = adt_stack_top(&self->stack);
-            adt_stack_pop(&self->stack);
-            self->parseState = PARSE_STATE_POST_VALUE;
-         }
-         else
+         lineNumber += worker->numLines;
+         dtl_json_lines_worker_clear(worker);
+      }
+      pNext = pBatchEnd;
+   }
+}
+
+/**
+ * Splits the whole input between the workers. Newlines in each range are counted first (in parallel) to give each worker
+ * the number of its first line, then each worker parses its range and calls the callback directly.
+ */
+static void dtl_json_lines_parallel_unordered(dtl_json_lines_parallel_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   uint32_t i;
+   uint32_t lineOffset = 0u;
+   dtl_json_lines_parallel_split(self, pBegin, pEnd);
+   for (i = 0u; i < self->numWorkers; i++)
+   {
+      self->workers[i].isCounting = true;
+   }
+   dtl_json_reader_run_threads(dtl_json_lines_worker_run, (void*) self->workers, sizeof(dtl_json_lines_worker_t), self->numWorkers);
+   for (i = 0u; i < self->numWorkers; i++)
+   {
+      dtl_json_lines_worker_t *worker = &self->workers[i];
+      worker->isCounting = false;
+      worker->lineOffset = lineOffset;
+      lineOffset += worker->numLines;
+   }
+   dtl_json_reader_run_threads(dtl_json_lines_worker_run, (void*) self->workers, sizeof(dtl_json_lines_worker_t), self->numWorkers);
+}
+
+/**
+ * Thread function of a worker. Parses (or counts the lines of) the range in the same way as dtl_json_load_lines_bstr.
+ */
+static void *dtl_json_lines_worker_run(void *arg)
+{
+   dtl_json_lines_worker_t *self = (dtl_json_lines_worker_t*) arg;
+   const uint8_t *pResult;
+   if (self->isCounting)
+   {
+      const uint8_t *pNext = self->pBegin;
+      self->numLines = 0u;
+      while (pNext < self->pEnd)
+      {
+         const uint8_t *pNewLine = (const uint8_t*) memchr(pNext, '\n', (size_t) (self->pEnd - pNext));
+         if (pNewLine == 0)
          {
-            self->parseState = PARSE_STATE_ERROR;
-            self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+            break;
          }
-         break;
-      default:
-         assert(0);
+         self->numLines++;
+         pNext = pNewLine + 1;
       }
+      return (void*) 0;
    }
-   if (self->parseState == PARSE_STATE_ERROR)
+   self->lines.lineNumber = 1u;
+   self->lines.isStopped = false;
+   pResult = dtl_json_lines_parse_block(&self->lines, self->pBegin, self->pEnd);
+   if ( (!self->lines.isStopped) && (pResult < self->pEnd) )
    {
-      dtl_av_delete((dtl_av_t*) self->data->currentElem);
+      dtl_json_lines_parse_line(&self->lines, pResult, self->pEnd);
    }
-   return pNext;
+   self->numLines = self->lines.lineNumber - 1u;
+   return (void*) 0;
 }
 
-static const uint8_t *dtl_json_reader_parse_value(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+/**
+ * Line callback of workers in ordered mode. Keeps the record until the calling thread delivers it.
+ */
+static bool dtl_json_lines_worker_collect(void *arg, uint32_t lineNumber, dtl_dv_t *dv, dtl_json_error_t errorCode)
 {
-   const uint8_t *pNext = pBegin;
-   if (pNext < pEnd)
+   dtl_json_lines_worker_t *self = (dtl_json_lines_worker_t*) arg;
+   dtl_json_lines_record_t *record;
+   if (self->numRecords == self->recordCapacity)
    {
-      const uint8_t *pResult = (const uint8_t*) 0;
-      int firstChar = (int) *pBegin;
-      if (bstr_pred_is_digit(firstChar) || firstChar == '-')
+      uint32_t newCapacity = (self->recordCapacity == 0u)? 64u : (self->recordCapacity * 2u);
+      dtl_json_lines_record_t *records = (dtl_json_lines_record_t*) realloc(self->records, sizeof(dtl_json_lines_record_t) * (size_t) newCapacity);
+      if (records == 0)
       {
-         pResult = dtl_json_reader_parse_number(self, pNext, pEnd);
-         if (pResult > pBegin)
+         self->isOutOfMemory = true;
+         return false;
+      }
+      self->records = records;
+      self->recordCapacity = newCapacity;
+   }
+   record = &self->records[self->numRecords++];
+   record->dv = dv;
+   record->lineNumber = lineNumber;
+   record->errorCode = errorCode;
+   if (dv != 0)
+   {
+      dtl_dv_inc_ref(dv);
+   }
+   return true;
+}
+
+/**
+ * Line callback of workers in unordered mode. Passes the record on to the caller's callback while holding the lock.
+ */
+static bool dtl_json_lines_worker_forward(void *arg, uint32_t lineNumber, dtl_dv_t *dv, dtl_json_error_t errorCode)
+{
+   dtl_json_lines_worker_t *self = (dtl_json_lines_worker_t*) arg;
+   dtl_json_lines_parallel_t *shared = self->shared;
+   bool retval = false;
+#ifndef _WIN32
+   pthread_mutex_lock(&shared->lock);
+#endif
+   if (!shared->isStopped)
+   {
+      retval = shared->callback(shared->arg, self->lineOffset + lineNumber, dv, errorCode);
+      if (!retval)
+      {
+         if (dv == 0)
          {
-            pNext = pResult;
-            self->parseState = PARSE_STATE_POST_VALUE;
+            shared->lastError = errorCode;
          }
+         shared->isStopped = true;
+      }
+   }
+#ifndef _WIN32
+   pthread_mutex_unlock(&shared->lock);
+#endif
+   return retval;
+}
+
+/**
+ * Releases records that have been delivered (or were never delivered because loading stopped).
+ */
+static void dtl_json_lines_worker_clear(dtl_json_lines_worker_t *self)
+{
+   uint32_t i;
+   for (i = 0u; i < self->numRecords; i++)
+   {
+      if (self->records[i].dv != 0)
+      {
+         dtl_dv_dec_ref(self->records[i].dv);
+      }
+   }
+   self->numRecords = 0u;
+   self->numLines = 0u;
+}
+
+static uint32_t dtl_json_reader_default_threads(void)
+{
+#ifndef _WIN32
+   long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+   if (numProcessors > 0)
+   {
+      return (uint32_t) numProcessors;
+   }
+#endif
+   return 1u;
+}
+
+/**
+ * Calls threadFunc once for each of the numArgs consecutive elements of argSize bytes at pArgs, each call on its own thread,
+ * and waits for all of them to return. The first call is made on the calling thread, as is any call whose thread cannot be started.
+ */
+static void dtl_json_reader_run_threads(void *(*threadFunc)(void *arg), void *pArgs, size_t argSize, uint32_t numArgs)
+{
+   uint32_t i;
+   uint8_t *pArg = (uint8_t*) pArgs;
+#ifndef _WIN32
+   pthread_t threads[DTL_JSON_READER_MAX_THREADS];
+   bool isStarted[DTL_JSON_READER_MAX_THREADS];
+   assert(numArgs <= DTL_JSON_READER_MAX_THREADS);
+   for (i = 1u; i < numArgs; i++)
+   {
+      isStarted[i] = (pthread_create(&threads[i], (const pthread_attr_t*) 0, threadFunc, (void*) (pArg + argSize * i)) == 0);
+   }
+   if (numArgs > 0u)
+   {
+      (void) threadFunc((void*) pArg);
+   }
+   for (i = 1u; i < numArgs; i++)
+   {
+      if (isStarted[i])
+      {
+         (void) pthread_join(threads[i], (void**) 0);
       }
       else
       {
-         adt_str_t *str;
+         (void) threadFunc((void*) (pArg + argSize * i));
+      }
+   }
+#else
+   for (i = 0u; i < numArgs; i++)
+   {
+      (void) threadFunc((void*) (pArg + argSize * i));
+   }
+#endif
+}
 
-         switch(firstChar)
+/**
+ * Finds up to maxSplits commas that separate the elements of the array or object opened at pOpen, spread evenly over the buffer.
+ * Only the brackets and strings of the nested values are looked at, so this runs at scan speed.
+ * Returns the number of commas stored in ppSplits. *ppClose is set to the matching end bracket, or NULL when there is none.
+ */
+static uint32_t dtl_json_reader_split_container(const uint8_t *pOpen, const uint8_t *pEnd, const uint8_t **ppSplits, uint32_t maxSplits, const uint8_t **ppClose)
+{
+   const uint8_t *pNext = pOpen + 1;
+   size_t docLen = (size_t) (pEnd - pOpen);
+   uint32_t numSplits = 0u;
+   uint32_t newLines = 0u;
+   int32_t level = 1;
+   const uint8_t *pTarget = pOpen + docLen / (maxSplits + 1u);
+   *ppClose = (const uint8_t*) 0;
+   while (pNext < pEnd)
+   {
+      uint8_t c;
+      const uint8_t *pStop = dtl_json_scan_bracket(pNext, pEnd, &newLines);
+      if ( (level == 1) && (numSplits < maxSplits) )
+      {
+         //between the brackets and strings at the top level there are only scalars, commas, colons and whitespace
+         while ( (numSplits < maxSplits) && (pStop > pTarget) )
          {
-         case '"':
-            str = adt_str_new();
-            if (str != 0)
-            {
-               pResult = bstr_parse_json_string_literal(&self->ctx, pNext, pEnd, str);
-               if (pResult > pBegin)
-               {
-                  self->data->currentElem = (dtl_dv_t*) dtl_sv_make_str(str);
-                  pNext = pResult;
-                  self->parseState = PARSE_STATE_POST_VALUE;
-               }
-               adt_str_delete(str);
-            }
-            break;
-         case '[':
-            self->data->currentElem = (dtl_dv_t*) dtl_av_new();
-            if (self->data->currentElem == 0)
-            {
-               self->parseState = PARSE_STATE_ERROR;
-               self->lastError = DTL_JSON_MEM_ERROR;
-            }
-            else
-            {
-               self->parseState = PARSE_STATE_ARRAY_BEGIN;
-               pNext++;
-            }
-            break;
-         case '{':
-            self->data->currentElem = (dtl_dv_t*) dtl_hv_new();
-            if (self->data->currentElem == 0)
-            {
-               self->parseState = PARSE_STATE_ERROR;
-               self->lastError = DTL_JSON_MEM_ERROR;
-            }
-            else
-            {
-               self->parseState = PARSE_STATE_OBJECT_BEGIN;
-               pNext++;
-            }
-            break;
-         case 'f':
-            pResult = bstr_match_cstr(pNext, pEnd, "false");
-            if (pResult > pBegin)
-            {
-               self->data->currentElem = (dtl_dv_t*) dtl_sv_make_bool(false);
-               pNext = pResult;
-               self->parseState = PARSE_STATE_POST_VALUE;
-            }
-            break;
-         case 't':
-            pResult = bstr_match_cstr(pNext, pEnd, "true");
-            if (pResult > pBegin)
+            const uint8_t *pFrom = (pNext > pTarget)? pNext : pTarget;
+            const uint8_t *pComma = (const uint8_t*) memchr(pFrom, ',', (size_t) (pStop - pFrom));
+            if (pComma == 0)
             {
-               self->data->currentElem = (dtl_dv_t*) dtl_sv_make_bool(true);
-               pNext = pResult;
-               self->parseState = PARSE_STATE_POST_VALUE;
+               break;
             }
+            ppSplits[numSplits++] = pComma;
+            pNext = pComma + 1;
+            pTarget = pOpen + (size_t) ( ( (uint64_t) docLen * (numSplits + 1u) ) / (maxSplits + 1u) );
+         }
+      }
+      pNext = pStop;
+      if (pNext >= pEnd)
+      {
+         break;
+      }
+      c = *pNext;
+      if (c == '"')
+      {
+         bool isPlain;
+         pNext = dtl_json_scan_string_end(pNext, pEnd, &isPlain);
+         if (pNext == 0)
+         {
             break;
-         case 'n':
-            pResult = bstr_match_cstr(pNext, pEnd, "null");
-            if (pResult > pBegin)
-            {
-               self->data->currentElem = (dtl_dv_t*) dtl_sv_none();
-               pNext = pResult;
-               self->parseState = PARSE_STATE_POST_VALUE;
-            }
+         }
+      }
+      else
+      {
+         pNext++;
+         if ( (c == '[') || (c == '{') )
+         {
+            level++;
+         }
+         else if (--level == 0)
+         {
+            *ppClose = pNext - 1;
             break;
-         default:
-            self->parseState = PARSE_STATE_ERROR;
-            self->lastError = DTL_JSON_UNEXPECTED_CHAR_ERROR;
          }
       }
    }
-   return pNext;
+   return numSplits;
 }
 
-static const uint8_t *dtl_json_reader_parse_number(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+/**
+ * Thread function of dtl_json_load_parallel. Parses the elements of the piece with a reader that starts out
+ * inside of a container, as if the opening bracket had just been read.
+ */
+static void *dtl_json_piece_run(void *arg)
 {
-   bstr_number_t number;
-   const uint8_t *pNext = pBegin;
-   const uint8_t *pResult = bstr_parse_json_number(&self->ctx, pBegin, pEnd, &number);
-   if (pResult > pBegin)
+   dtl_json_piece_t *self = (dtl_json_piece_t*) arg;
+   dtl_json_reader_t reader;
+   dtl_json_readerData_t *childData;
+   const uint8_t *pResult;
+   self->result = (dtl_dv_t*) 0;
+   dtl_json_reader_create(&reader);
+   reader.eof = true;
+   reader.data->currentElem = self->isObject? (dtl_dv_t*) dtl_hv_new() : (dtl_dv_t*) dtl_av_new();
+   childData = (reader.data->currentElem != 0)? dtl_json_reader_push_data(&reader) : (dtl_json_readerData_t*) 0;
+   if (childData != 0)
+   {
+      childData->isObject = self->isObject;
+      childData->isArray = !self->isObject;
+      reader.parseState = self->isObject? PARSE_STATE_OBJECT_KEY : PARSE_STATE_PRE_VALUE;
+      pResult = dtl_json_reader_parse_block(&reader, self->pBegin, self->pEnd);
+      //a complete piece leaves the reader waiting for the next ',' or the end bracket
+      if ( (pResult == self->pEnd) && (reader.depth == 1) &&
+           (reader.parseState == (self->isObject? PARSE_STATE_OBJECT_NEXT : PARSE_STATE_ARRAY_NEXT) ) )
+      {
+         self->result = reader.frames[0].currentElem;
+         dtl_dv_inc_ref(self->result);
+      }
+   }
+   dtl_json_reader_destroy(&reader);
+   return (void*) 0;
+}
+
+/**
+ * Moves the elements of all pieces into the container of the first piece. Returns that container, or NULL if any piece failed.
+ */
+static dtl_dv_t *dtl_json_piece_join(dtl_json_piece_t *pieces, uint32_t numPieces)
+{
+   uint32_t i;
+   dtl_dv_t *retval = pieces[0].result;
+   for (i = 0u; i < numPieces; i++)
+   {
+      if (pieces[i].result == 0)
+      {
+         retval = (dtl_dv_t*) 0;
+      }
+   }
+   for (i = 1u; i < numPieces; i++)
    {
-      if ( (number.hasInteger) && (!number.hasFraction) && (!number.hasExponent) )
+      dtl_dv_t *piece = pieces[i].result;
+      if ( (retval != 0) && (pieces[i].isObject) )
       {
-         if (number.isNegative)
+         dtl_hv_t *hv = (dtl_hv_t*) piece;
+         dtl_av_t *keys = dtl_hv_keys(hv);
+         int32_t j;
+         int32_t numKeys = (keys != 0)? dtl_av_length(keys) : 0;
+         for (j = 0; j < numKeys; j++)
          {
-            if (number.integer > INT32_MAX)
-            {
-               self->data->currentElem = (dtl_dv_t*) dtl_sv_make_i64( -((int64_t) number.integer) );
-            }
-            else
+            bool ok = false;
+            const char *key = dtl_sv_to_cstr((dtl_sv_t*) dtl_av_value(keys, j), &ok);
+            if (ok)
             {
-               self->data->currentElem = (dtl_dv_t*) dtl_sv_make_i32( -((int32_t) number.integer) );
+               dtl_hv_set_cstr((dtl_hv_t*) retval, key, dtl_hv_get_cstr(hv, key), true);
             }
          }
-         else
+         if (keys != 0)
          {
-            if ( number.integer > INT32_MAX)
-            {
-               self->data->currentElem = (dtl_dv_t*) dtl_sv_make_u32(number.integer);
-            }
-            else
-            {
-               self->data->currentElem = (dtl_dv_t*) dtl_sv_make_i32( ((int32_t) number.integer) );
-            }
+            dtl_dv_dec_ref((dtl_dv_t*) keys);
          }
-         pNext = pResult;
       }
-      else
+      else if (retval != 0)
       {
-         pNext = (const uint8_t*) 0;
-         self->parseState = PARSE_STATE_ERROR;
+         dtl_av_t *av = (dtl_av_t*) piece;
+         int32_t j;
+         int32_t numElems = dtl_av_length(av);
+         for (j = 0; j < numElems; j++)
+         {
+            dtl_av_push((dtl_av_t*) retval, dtl_av_value(av, j), true);
+         }
+      }
+      if (piece != 0)
+      {
+         dtl_dv_dec_ref(piece);
       }
    }
-   return pNext;
+   if ( (retval == 0) && (pieces[0].result != 0) )
+   {
+      dtl_dv_dec_ref(pieces[0].result);
+   }
+   return retval;
 }
 
-
-static const uint8_t *dtl_json_reader_lstrip(dtl_json_reader_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+#ifndef _WIN32
+/**
+ * Maps a regular, non-empty file for sequential reading. Returns NULL when the file cannot be mapped.
+ * The file descriptor can be closed once the function returns, the mapping is released with munmap.
+ */
+static const uint8_t *dtl_json_reader_map_file(int fd, size_t *pMapLen)
 {
-   const uint8_t *pNext = pBegin;
-   while (pNext < pEnd)
+   struct stat st;
+   if ( (fstat(fd, &st) == 0) && (S_ISREG(st.st_mode)) && (st.st_size > 0) )
    {
-      int c = (int) *pNext;
-      if (!bstr_pred_is_whitespace(c)){
-         break;
-      }
-      if (c == '\n')
+      size_t mapLen = (size_t) st.st_size;
+      void *pMap = mmap((void*) 0, mapLen, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (pMap != MAP_FAILED)
       {
-         self->lineNumber++;
+         (void) madvise(pMap, mapLen, MADV_SEQUENTIAL);
+         *pMapLen = mapLen;
+         return (const uint8_t*) pMap;
       }
-      pNext++;
    }
-   return pNext;
+   return (const uint8_t*) 0;
 }
+#endif
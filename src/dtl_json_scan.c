@@ -0,0 +1,519 @@
+/*****************************************************************************
+* \file      dtl_json_scan.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Fast byte scanning routines used by the JSON parsers
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include "dtl_json_scan.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define DTL_JSON_SCAN_HAS_SSE2 1
+#define DTL_JSON_SCAN_HAS_AVX2 1
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#include <emmintrin.h>
+#define DTL_JSON_SCAN_HAS_SSE2 1
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+typedef const uint8_t *(scanFunc_t)(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines);
+typedef const uint8_t *(findFunc_t)(const uint8_t *pBegin, const uint8_t *pEnd);
+
+#define SCAN_IS_WHITESPACE(c) ( ((c) == ' ') || ((c) == '\n') || ((c) == '\r') || ((c) == '\t') )
+#define SCAN_IS_STRING_SPECIAL(c) ( ((c) == '"') || ((c) == '\\') || ((c) < 0x20u) )
+#define SCAN_IS_BRACKET(c) ( ((c) == '"') || ((c) == '[') || ((c) == ']') || ((c) == '{') || ((c) == '}') )
+
+//Selected functions are stored on first use while other threads may be scanning, they all select the same function.
+//Threads are only started in POSIX builds.
+#if defined(__GNUC__)
+#define SCAN_LOAD_FUNC(p) __atomic_load_n(&(p), __ATOMIC_ACQUIRE)
+#define SCAN_STORE_FUNC(p, f) __atomic_store_n(&(p), (f), __ATOMIC_RELEASE)
+#else
+#define SCAN_LOAD_FUNC(p) (p)
+#define SCAN_STORE_FUNC(p, f) ((p) = (f))
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#ifdef DTL_JSON_SCAN_HAS_SSE2
+static const uint8_t *dtl_json_scan_whitespace_sse2(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines);
+static const uint8_t *dtl_json_scan_string_special_sse2(const uint8_t *pBegin, const uint8_t *pEnd);
+static const uint8_t *dtl_json_scan_bracket_sse2(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines);
+#endif
+#ifdef DTL_JSON_SCAN_HAS_AVX2
+static const uint8_t *dtl_json_scan_whitespace_avx2(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines);
+static const uint8_t *dtl_json_scan_string_special_avx2(const uint8_t *pBegin, const uint8_t *pEnd);
+static const uint8_t *dtl_json_scan_bracket_avx2(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines);
+#endif
+static scanFunc_t *dtl_json_scan_select_whitespace(void);
+static findFunc_t *dtl_json_scan_select_string_special(void);
+static scanFunc_t *dtl_json_scan_select_bracket(void);
+#ifdef DTL_JSON_SCAN_HAS_SSE2
+static uint32_t dtl_json_scan_popcount(uint32_t value);
+static uint32_t dtl_json_scan_ctz(uint32_t value);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static scanFunc_t *m_scanWhitespace = (scanFunc_t*) 0; //selected on first use
+static findFunc_t *m_findStringSpecial = (findFunc_t*) 0; //selected on first use
+static scanFunc_t *m_scanBracket = (scanFunc_t*) 0; //selected on first use
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns the best instruction set extension supported by both the build and the running CPU.
+ */
+dtl_json_simd_t dtl_json_scan_simd_level(void)
+{
+#ifdef DTL_JSON_SCAN_HAS_AVX2
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+   {
+      return DTL_JSON_SIMD_AVX2;
+   }
+#endif
+#if defined(DTL_JSON_SCAN_HAS_SSE2) && defined(__GNUC__)
+   if (__builtin_cpu_supports("sse2"))
+   {
+      return DTL_JSON_SIMD_SSE2;
+   }
+#elif defined(DTL_JSON_SCAN_HAS_SSE2)
+   return DTL_JSON_SIMD_SSE2; //SSE2 is part of the x64 baseline
+#endif
+   return DTL_JSON_SIMD_NONE;
+}
+
+/**
+ * Returns pointer to first non-whitespace character in [pBegin, pEnd), or pEnd if there is none.
+ * Number of newline characters skipped over is added to *pNewLines.
+ */
+const uint8_t *dtl_json_scan_whitespace(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines)
+{
+   scanFunc_t *scanFunc;
+   if ( (pBegin >= pEnd) || (!SCAN_IS_WHITESPACE(*pBegin)) )
+   {
+      return pBegin; //common case in compact JSON
+   }
+   scanFunc = SCAN_LOAD_FUNC(m_scanWhitespace);
+   if (scanFunc == 0)
+   {
+      scanFunc = dtl_json_scan_select_whitespace();
+      SCAN_STORE_FUNC(m_scanWhitespace, scanFunc);
+   }
+   return scanFunc(pBegin, pEnd, pNewLines);
+}
+
+const uint8_t *dtl_json_scan_whitespace_scalar(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines)
+{
+   const uint8_t *pNext = pBegin;
+   uint32_t newLines = 0u;
+   while (pNext < pEnd)
+   {
+      uint8_t c = *pNext;
+      if (!SCAN_IS_WHITESPACE(c))
+      {
+         break;
+      }
+      if (c == '\n')
+      {
+         newLines++;
+      }
+      pNext++;
+   }
+   *pNewLines += newLines;
+   return pNext;
+}
+
+/**
+ * Finds the end of the string literal starting at pBegin, which must point to the opening quote.
+ * Returns pointer to the character after the closing quote or NULL if the closing quote was not found before pEnd.
+ * *pIsPlain is set to true when the string contains no escape sequences and no control characters,
+ * meaning that its content can be used as-is.
+ */
+const uint8_t *dtl_json_scan_string_end(const uint8_t *pBegin, const uint8_t *pEnd, bool *pIsPlain)
+{
+   const uint8_t *pNext = pBegin + 1;
+   bool isPlain = true;
+   findFunc_t *findFunc = SCAN_LOAD_FUNC(m_findStringSpecial);
+   if (findFunc == 0)
+   {
+      findFunc = dtl_json_scan_select_string_special();
+      SCAN_STORE_FUNC(m_findStringSpecial, findFunc);
+   }
+   for(;;)
+   {
+      uint8_t c;
+      pNext = findFunc(pNext, pEnd);
+      if (pNext >= pEnd)
+      {
+         return (const uint8_t*) 0;
+      }
+      c = *pNext;
+      if (c == '"')
+      {
+         *pIsPlain = isPlain;
+         return pNext + 1;
+      }
+      isPlain = false;
+      pNext += (c == '\\')? 2 : 1;
+   }
+}
+
+/**
+ * Returns pointer to the first quote, backslash or control character in [pBegin, pEnd), or pEnd if there is none.
+ */
+const uint8_t *dtl_json_scan_string_special_scalar(const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   const uint8_t *pNext = pBegin;
+   while ( (pNext < pEnd) && (!SCAN_IS_STRING_SPECIAL(*pNext)) )
+   {
+      pNext++;
+   }
+   return pNext;
+}
+
+/**
+ * Returns pointer to the first quote or bracket in [pBegin, pEnd), or pEnd if there is none.
+ * Number of newline characters skipped over is added to *pNewLines.
+ * Used for skipping over nested values where everything except strings and brackets can be ignored.
+ */
+const uint8_t *dtl_json_scan_bracket(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines)
+{
+   scanFunc_t *scanFunc = SCAN_LOAD_FUNC(m_scanBracket);
+   if (scanFunc == 0)
+   {
+      scanFunc = dtl_json_scan_select_bracket();
+      SCAN_STORE_FUNC(m_scanBracket, scanFunc);
+   }
+   return scanFunc(pBegin, pEnd, pNewLines);
+}
+
+const uint8_t *dtl_json_scan_bracket_scalar(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines)
+{
+   const uint8_t *pNext = pBegin;
+   uint32_t newLines = 0u;
+   while (pNext < pEnd)
+   {
+      uint8_t c = *pNext;
+      if (SCAN_IS_BRACKET(c))
+      {
+         break;
+      }
+      if (c == '\n')
+      {
+         newLines++;
+      }
+      pNext++;
+   }
+   *pNewLines += newLines;
+   return pNext;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static scanFunc_t *dtl_json_scan_select_whitespace(void)
+{
+   switch(dtl_json_scan_simd_level())
+   {
+#ifdef DTL_JSON_SCAN_HAS_AVX2
+   case DTL_JSON_SIMD_AVX2:
+      return dtl_json_scan_whitespace_avx2;
+#endif
+#ifdef DTL_JSON_SCAN_HAS_SSE2
+   case DTL_JSON_SIMD_SSE2:
+      return dtl_json_scan_whitespace_sse2;
+#endif
+   default:
+      break;
+   }
+   return dtl_json_scan_whitespace_scalar;
+}
+
+static findFunc_t *dtl_json_scan_select_string_special(void)
+{
+   switch(dtl_json_scan_simd_level())
+   {
+#ifdef DTL_JSON_SCAN_HAS_AVX2
+   case DTL_JSON_SIMD_AVX2:
+      return dtl_json_scan_string_special_avx2;
+#endif
+#ifdef DTL_JSON_SCAN_HAS_SSE2
+   case DTL_JSON_SIMD_SSE2:
+      return dtl_json_scan_string_special_sse2;
+#endif
+   default:
+      break;
+   }
+   return dtl_json_scan_string_special_scalar;
+}
+
+static scanFunc_t *dtl_json_scan_select_bracket(void)
+{
+   switch(dtl_json_scan_simd_level())
+   {
+#ifdef DTL_JSON_SCAN_HAS_AVX2
+   case DTL_JSON_SIMD_AVX2:
+      return dtl_json_scan_bracket_avx2;
+#endif
+#ifdef DTL_JSON_SCAN_HAS_SSE2
+   case DTL_JSON_SIMD_SSE2:
+      return dtl_json_scan_bracket_sse2;
+#endif
+   default:
+      break;
+   }
+   return dtl_json_scan_bracket_scalar;
+}
+
+#ifdef DTL_JSON_SCAN_HAS_SSE2
+/**
+ * Classifies 16 bytes per step. Newlines are counted from a separate compare mask using popcount.
+ */
+static const uint8_t *dtl_json_scan_whitespace_sse2(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines)
+{
+   const uint8_t *pNext = pBegin;
+   const __m128i space = _mm_set1_epi8(' ');
+   const __m128i newLine = _mm_set1_epi8('\n');
+   const __m128i carriageReturn = _mm_set1_epi8('\r');
+   const __m128i tab = _mm_set1_epi8('\t');
+   uint32_t newLines = 0u;
+   while ( (pEnd - pNext) >= 16 )
+   {
+      __m128i chunk = _mm_loadu_si128((const __m128i*) pNext);
+      __m128i isNewLine = _mm_cmpeq_epi8(chunk, newLine);
+      __m128i isWhitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), isNewLine),
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, carriageReturn), _mm_cmpeq_epi8(chunk, tab)));
+      uint32_t whitespaceMask = (uint32_t) _mm_movemask_epi8(isWhitespace);
+      uint32_t newLineMask = (uint32_t) _mm_movemask_epi8(isNewLine);
+      if (whitespaceMask != 0xFFFFu)
+      {
+         uint32_t offset = dtl_json_scan_ctz(~whitespaceMask);
+         newLines += dtl_json_scan_popcount(newLineMask & ((1u << offset) - 1u));
+         *pNewLines += newLines;
+         return pNext + offset;
+      }
+      newLines += dtl_json_scan_popcount(newLineMask);
+      pNext += 16;
+   }
+   *pNewLines += newLines;
+   return dtl_json_scan_whitespace_scalar(pNext, pEnd, pNewLines);
+}
+
+/**
+ * Control characters are found by comparing max(c, 0x1F) against 0x1F since SSE2 lacks unsigned byte compare.
+ */
+static const uint8_t *dtl_json_scan_string_special_sse2(const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   const uint8_t *pNext = pBegin;
+   const __m128i quote = _mm_set1_epi8('"');
+   const __m128i backslash = _mm_set1_epi8('\\');
+   const __m128i controlMax = _mm_set1_epi8(0x1F);
+   while ( (pEnd - pNext) >= 16 )
+   {
+      __m128i chunk = _mm_loadu_si128((const __m128i*) pNext);
+      __m128i isSpecial = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                       _mm_cmpeq_epi8(_mm_max_epu8(chunk, controlMax), controlMax));
+      uint32_t specialMask = (uint32_t) _mm_movemask_epi8(isSpecial);
+      if (specialMask != 0u)
+      {
+         return pNext + dtl_json_scan_ctz(specialMask);
+      }
+      pNext += 16;
+   }
+   return dtl_json_scan_string_special_scalar(pNext, pEnd);
+}
+
+/**
+ * Setting bit 5 (0x20) maps '[' to '{' and ']' to '}', which leaves three compares per chunk.
+ */
+static const uint8_t *dtl_json_scan_bracket_sse2(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines)
+{
+   const uint8_t *pNext = pBegin;
+   const __m128i quote = _mm_set1_epi8('"');
+   const __m128i newLine = _mm_set1_epi8('\n');
+   const __m128i bracketBit = _mm_set1_epi8(0x20);
+   const __m128i openBracket = _mm_set1_epi8('{');
+   const __m128i closeBracket = _mm_set1_epi8('}');
+   uint32_t newLines = 0u;
+   while ( (pEnd - pNext) >= 16 )
+   {
+      __m128i chunk = _mm_loadu_si128((const __m128i*) pNext);
+      __m128i folded = _mm_or_si128(chunk, bracketBit);
+      __m128i isBracket = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                       _mm_or_si128(_mm_cmpeq_epi8(folded, openBracket), _mm_cmpeq_epi8(folded, closeBracket)));
+      uint32_t bracketMask = (uint32_t) _mm_movemask_epi8(isBracket);
+      uint32_t newLineMask = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newLine));
+      if (bracketMask != 0u)
+      {
+         uint32_t offset = dtl_json_scan_ctz(bracketMask);
+         newLines += dtl_json_scan_popcount(newLineMask & ((1u << offset) - 1u));
+         *pNewLines += newLines;
+         return pNext + offset;
+      }
+      newLines += dtl_json_scan_popcount(newLineMask);
+      pNext += 16;
+   }
+   *pNewLines += newLines;
+   return dtl_json_scan_bracket_scalar(pNext, pEnd, pNewLines);
+}
+#endif
+
+#ifdef DTL_JSON_SCAN_HAS_AVX2
+/**
+ * Same as the SSE2 version but classifies 32 bytes per step.
+ */
+__attribute__((target("avx2")))
+static const uint8_t *dtl_json_scan_whitespace_avx2(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines)
+{
+   const uint8_t *pNext = pBegin;
+   const __m256i space = _mm256_set1_epi8(' ');
+   const __m256i newLine = _mm256_set1_epi8('\n');
+   const __m256i carriageReturn = _mm256_set1_epi8('\r');
+   const __m256i tab = _mm256_set1_epi8('\t');
+   uint32_t newLines = 0u;
+   while ( (pEnd - pNext) >= 32 )
+   {
+      __m256i chunk = _mm256_loadu_si256((const __m256i*) pNext);
+      __m256i isNewLine = _mm256_cmpeq_epi8(chunk, newLine);
+      __m256i isWhitespace = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), isNewLine),
+                                             _mm256_or_si256(_mm256_cmpeq_epi8(chunk, carriageReturn), _mm256_cmpeq_epi8(chunk, tab)));
+      uint32_t whitespaceMask = (uint32_t) _mm256_movemask_epi8(isWhitespace);
+      uint32_t newLineMask = (uint32_t) _mm256_movemask_epi8(isNewLine);
+      if (whitespaceMask != 0xFFFFFFFFu)
+      {
+         uint32_t offset = dtl_json_scan_ctz(~whitespaceMask);
+         uint32_t below = (offset == 0u)? 0u : (0xFFFFFFFFu >> (32u - offset));
+         newLines += dtl_json_scan_popcount(newLineMask & below);
+         *pNewLines += newLines;
+         return pNext + offset;
+      }
+      newLines += dtl_json_scan_popcount(newLineMask);
+      pNext += 32;
+   }
+   *pNewLines += newLines;
+   return dtl_json_scan_whitespace_sse2(pNext, pEnd, pNewLines);
+}
+
+__attribute__((target("avx2")))
+static const uint8_t *dtl_json_scan_string_special_avx2(const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   const uint8_t *pNext = pBegin;
+   const __m256i quote = _mm256_set1_epi8('"');
+   const __m256i backslash = _mm256_set1_epi8('\\');
+   const __m256i controlMax = _mm256_set1_epi8(0x1F);
+   while ( (pEnd - pNext) >= 32 )
+   {
+      __m256i chunk = _mm256_loadu_si256((const __m256i*) pNext);
+      __m256i isSpecial = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+                                          _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, controlMax), controlMax));
+      uint32_t specialMask = (uint32_t) _mm256_movemask_epi8(isSpecial);
+      if (specialMask != 0u)
+      {
+         return pNext + dtl_json_scan_ctz(specialMask);
+      }
+      pNext += 32;
+   }
+   return dtl_json_scan_string_special_sse2(pNext, pEnd);
+}
+
+__attribute__((target("avx2")))
+static const uint8_t *dtl_json_scan_bracket_avx2(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines)
+{
+   const uint8_t *pNext = pBegin;
+   const __m256i quote = _mm256_set1_epi8('"');
+   const __m256i newLine = _mm256_set1_epi8('\n');
+   const __m256i bracketBit = _mm256_set1_epi8(0x20);
+   const __m256i openBracket = _mm256_set1_epi8('{');
+   const __m256i closeBracket = _mm256_set1_epi8('}');
+   uint32_t newLines = 0u;
+   while ( (pEnd - pNext) >= 32 )
+   {
+      __m256i chunk = _mm256_loadu_si256((const __m256i*) pNext);
+      __m256i folded = _mm256_or_si256(chunk, bracketBit);
+      __m256i isBracket = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                          _mm256_or_si256(_mm256_cmpeq_epi8(folded, openBracket), _mm256_cmpeq_epi8(folded, closeBracket)));
+      uint32_t bracketMask = (uint32_t) _mm256_movemask_epi8(isBracket);
+      uint32_t newLineMask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newLine));
+      if (bracketMask != 0u)
+      {
+         uint32_t offset = dtl_json_scan_ctz(bracketMask);
+         uint32_t below = (offset == 0u)? 0u : (0xFFFFFFFFu >> (32u - offset));
+         newLines += dtl_json_scan_popcount(newLineMask & below);
+         *pNewLines += newLines;
+         return pNext + offset;
+      }
+      newLines += dtl_json_scan_popcount(newLineMask);
+      pNext += 32;
+   }
+   *pNewLines += newLines;
+   return dtl_json_scan_bracket_sse2(pNext, pEnd, pNewLines);
+}
+#endif
+
+#ifdef DTL_JSON_SCAN_HAS_SSE2
+static uint32_t dtl_json_scan_popcount(uint32_t value)
+{
+#ifdef __GNUC__
+   return (uint32_t) __builtin_popcount(value);
+#else
+   value = value - ((value >> 1) & 0x55555555u);
+   value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+   return (((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+}
+
+/**
+ * Returns number of trailing zero bits. value must not be 0.
+ */
+static uint32_t dtl_json_scan_ctz(uint32_t value)
+{
+#ifdef __GNUC__
+   return (uint32_t) __builtin_ctz(value);
+#elif defined(_MSC_VER)
+   unsigned long index;
+   _BitScanForward(&index, value);
+   return (uint32_t) index;
+#else
+   uint32_t count = 0u;
+   while ( (value & 1u) == 0u )
+   {
+      value >>= 1;
+      count++;
+   }
+   return count;
+#endif
+}
+#endif
@@ -0,0 +1,55 @@
+/*****************************************************************************
+* \file      dtl_json_scan.h
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Fast byte scanning routines used by the JSON parsers
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef DTL_JSON_SCAN_H
+#define DTL_JSON_SCAN_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+typedef uint8_t dtl_json_simd_t;
+
+#define DTL_JSON_SIMD_NONE  ((dtl_json_simd_t) 0u)
+#define DTL_JSON_SIMD_SSE2  ((dtl_json_simd_t) 1u)
+#define DTL_JSON_SIMD_AVX2  ((dtl_json_simd_t) 2u)
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+dtl_json_simd_t dtl_json_scan_simd_level(void);
+const uint8_t *dtl_json_scan_whitespace(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines);
+const uint8_t *dtl_json_scan_whitespace_scalar(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines);
+const uint8_t *dtl_json_scan_string_end(const uint8_t *pBegin, const uint8_t *pEnd, bool *pIsPlain);
+const uint8_t *dtl_json_scan_string_special_scalar(const uint8_t *pBegin, const uint8_t *pEnd);
+const uint8_t *dtl_json_scan_bracket(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines);
+const uint8_t *dtl_json_scan_bracket_scalar(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *pNewLines);
+
+#endif //DTL_JSON_SCAN_H
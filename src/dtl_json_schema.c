@@ -0,0 +1,675 @@
+/*****************************************************************************
+* \file      dtl_json_schema.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Schema-bound decoding and encoding of C structs
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include "dtl_json.h"
+#include "dtl_json_number.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define ENCODE_BUF_SIZE 64
+#define ENCODE_SEPARATOR ", "
+#define ENCODE_SEPARATOR_LEN 2u
+
+typedef struct dtl_json_encoder_field_tag
+{
+   char *key; //separator, quoted and escaped key and colon, the separator is skipped for the first field
+   uint32_t keyLen;
+   struct dtl_json_encoder_tag *child; //for DTL_JSON_FIELD_STRUCT
+} dtl_json_encoder_field_t;
+
+struct dtl_json_encoder_tag
+{
+   const dtl_json_schema_t *schema;
+   dtl_json_encoder_field_t *fields;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static dtl_json_error_t dtl_json_decode_struct(dtl_json_cursor_t *cursor, const dtl_json_schema_t *schema, uint8_t *base);
+static dtl_json_error_t dtl_json_decode_field(dtl_json_cursor_t *cursor, const dtl_json_field_t *field, uint8_t *base);
+static dtl_json_error_t dtl_json_decode_element(dtl_json_cursor_t *cursor, const dtl_json_field_t *field, uint8_t *pElem);
+static const dtl_json_field_t *dtl_json_decode_find_field(const dtl_json_schema_t *schema, const char *pKey, uint32_t keyLen, uint32_t *pHint);
+static size_t dtl_json_schema_element_size(const dtl_json_field_t *field);
+static dtl_json_error_t dtl_json_decode_next(dtl_json_cursor_t *cursor);
+static bool dtl_json_encoder_compile_key(dtl_json_encoder_field_t *compiled, const char *name);
+static bool dtl_json_encode_struct(const dtl_json_encoder_t *self, const uint8_t *base, adt_str_t *dest);
+static bool dtl_json_encode_field(const dtl_json_encoder_field_t *compiled, const dtl_json_field_t *field, const uint8_t *base, adt_str_t *dest);
+static bool dtl_json_encode_element(const dtl_json_encoder_field_t *compiled, const dtl_json_field_t *field, const uint8_t *pElem, adt_str_t *dest);
+static bool dtl_json_encode_u64(uint64_t value, bool isNegative, adt_str_t *dest);
+static bool dtl_json_encode_string(const char *pStr, size_t strLen, adt_str_t *dest);
+static bool dtl_json_encode_append(adt_str_t *dest, const char *pStr, size_t len);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Decodes a JSON object straight into the caller-owned struct at dest, no dtl_dv_t values are created.
+ * Keys not found in the schema are skipped, members missing from the document and members set to null are left untouched.
+ * Numbers out of range for their member and values of the wrong JSON type give DTL_JSON_TYPE_ERROR.
+ * Strings that do not fit (with terminator) in elemSize bytes and arrays longer than maxCount give DTL_JSON_LIMIT_ERROR.
+ * On error dest may be partially written.
+ */
+dtl_json_error_t dtl_json_decode(const uint8_t *pBegin, const uint8_t *pEnd, const dtl_json_schema_t *schema, void *dest)
+{
+   dtl_json_cursor_t cursor;
+   dtl_json_error_t retval;
+   if ( (pBegin == 0) || (pEnd == 0) || (pBegin > pEnd) || (schema == 0) || (dest == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   dtl_json_cursor_create(&cursor, pBegin, pEnd);
+   retval = dtl_json_decode_next(&cursor);
+   if (retval == DTL_JSON_NO_ERROR)
+   {
+      retval = dtl_json_decode_struct(&cursor, schema, (uint8_t*) dest);
+   }
+   if (retval == DTL_JSON_NO_ERROR)
+   {
+      //only whitespace may follow the object
+      retval = dtl_json_decode_next(&cursor);
+      if ( (retval == DTL_JSON_NO_ERROR) && (dtl_json_cursor_type(&cursor) != DTL_JSON_TOKEN_END) )
+      {
+         retval = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+      }
+   }
+   dtl_json_cursor_destroy(&cursor);
+   return retval;
+}
+
+/**
+ * Compiles schema for dtl_json_encoder_write. Keys are quoted and escaped here, once, and nested schemas are compiled as well.
+ * The schema tables must remain valid until the encoder is deleted. Returns NULL when out of memory.
+ */
+dtl_json_encoder_t* dtl_json_encoder_new(const dtl_json_schema_t *schema)
+{
+   dtl_json_encoder_t *self;
+   uint32_t i;
+   if ( (schema == 0) || ( (schema->fields == 0) && (schema->numFields > 0u) ) )
+   {
+      return (dtl_json_encoder_t*) 0;
+   }
+   self = (dtl_json_encoder_t*) malloc(sizeof(dtl_json_encoder_t));
+   if (self == 0)
+   {
+      return self;
+   }
+   self->schema = schema;
+   self->fields = (dtl_json_encoder_field_t*) calloc(schema->numFields + 1u, sizeof(dtl_json_encoder_field_t));
+   if (self->fields == 0)
+   {
+      free(self);
+      return (dtl_json_encoder_t*) 0;
+   }
+   for (i = 0u; i < schema->numFields; i++)
+   {
+      const dtl_json_field_t *field = &schema->fields[i];
+      bool isValid = (field->name != 0) && dtl_json_encoder_compile_key(&self->fields[i], field->name);
+      if ( isValid && (field->type == DTL_JSON_FIELD_STRUCT) )
+      {
+         self->fields[i].child = dtl_json_encoder_new(field->schema);
+         isValid = (self->fields[i].child != 0);
+      }
+      if (!isValid)
+      {
+         dtl_json_encoder_delete(self);
+         return (dtl_json_encoder_t*) 0;
+      }
+   }
+   return self;
+}
+
+void dtl_json_encoder_delete(dtl_json_encoder_t *self)
+{
+   if (self != 0)
+   {
+      uint32_t i;
+      for (i = 0u; i < self->schema->numFields; i++)
+      {
+         if (self->fields[i].key != 0)
+         {
+            free(self->fields[i].key);
+         }
+         dtl_json_encoder_delete(self->fields[i].child);
+      }
+      free(self->fields);
+      free(self);
+   }
+}
+
+/**
+ * Appends the struct at src to dest as a JSON object, in the same format as dtl_json_dumps without indentation.
+ * All fields of the schema are written in table order. Arrays hold the number of elements given by their count member
+ * (at most maxCount), strings end at the first null character or after elemSize bytes, non-finite doubles are written as null.
+ */
+dtl_json_error_t dtl_json_encoder_write(const dtl_json_encoder_t *self, const void *src, adt_str_t *dest)
+{
+   if ( (self == 0) || (src == 0) || (dest == 0) )
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   if (!dtl_json_encode_struct(self, (const uint8_t*) src, dest))
+   {
+      return DTL_JSON_MEM_ERROR;
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static dtl_json_error_t dtl_json_decode_struct(dtl_json_cursor_t *cursor, const dtl_json_schema_t *schema, uint8_t *base)
+{
+   uint32_t hint = 0u;
+   if (dtl_json_cursor_type(cursor) != DTL_JSON_TOKEN_BEGIN_OBJECT)
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   for (;;)
+   {
+      dtl_json_error_t retval = dtl_json_decode_next(cursor);
+      const dtl_json_field_t *field;
+      const char *pKey;
+      uint32_t keyLen;
+      if (retval != DTL_JSON_NO_ERROR)
+      {
+         return retval;
+      }
+      if (dtl_json_cursor_type(cursor) == DTL_JSON_TOKEN_END_OBJECT)
+      {
+         break;
+      }
+      retval = dtl_json_cursor_get_string_slice(cursor, &pKey, &keyLen);
+      if (retval != DTL_JSON_NO_ERROR)
+      {
+         return retval;
+      }
+      field = dtl_json_decode_find_field(schema, pKey, keyLen, &hint);
+      if (field == 0)
+      {
+         retval = dtl_json_cursor_skip(cursor);
+      }
+      else
+      {
+         retval = dtl_json_decode_next(cursor);
+         if (retval == DTL_JSON_NO_ERROR)
+         {
+            retval = dtl_json_decode_field(cursor, field, base);
+         }
+      }
+      if (retval != DTL_JSON_NO_ERROR)
+      {
+         return retval;
+      }
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+static dtl_json_error_t dtl_json_decode_field(dtl_json_cursor_t *cursor, const dtl_json_field_t *field, uint8_t *base)
+{
+   uint8_t *pElem = base + field->offset;
+   uint32_t count = 0u;
+   size_t elemSize;
+   if (dtl_json_cursor_type(cursor) == DTL_JSON_TOKEN_NULL)
+   {
+      return DTL_JSON_NO_ERROR;
+   }
+   if (field->maxCount == 0u)
+   {
+      return dtl_json_decode_element(cursor, field, pElem);
+   }
+   if (dtl_json_cursor_type(cursor) != DTL_JSON_TOKEN_BEGIN_ARRAY)
+   {
+      return DTL_JSON_TYPE_ERROR;
+   }
+   elemSize = dtl_json_schema_element_size(field);
+   for (;;)
+   {
+      dtl_json_error_t retval = dtl_json_decode_next(cursor);
+      if (retval != DTL_JSON_NO_ERROR)
+      {
+         return retval;
+      }
+      if (dtl_json_cursor_type(cursor) == DTL_JSON_TOKEN_END_ARRAY)
+      {
+         break;
+      }
+      if (count >= field->maxCount)
+      {
+         return DTL_JSON_LIMIT_ERROR;
+      }
+      retval = dtl_json_decode_element(cursor, field, pElem);
+      if (retval != DTL_JSON_NO_ERROR)
+      {
+         return retval;
+      }
+      pElem += elemSize;
+      count++;
+   }
+   memcpy(base + field->countOffset, &count, sizeof(count));
+   return DTL_JSON_NO_ERROR;
+}
+
+static dtl_json_error_t dtl_json_decode_element(dtl_json_cursor_t *cursor, const dtl_json_field_t *field, uint8_t *pElem)
+{
+   dtl_json_error_t retval = DTL_JSON_TYPE_ERROR;
+   switch(field->type)
+   {
+   case DTL_JSON_FIELD_BOOL:
+      {
+         bool value;
+         retval = dtl_json_cursor_get_bool(cursor, &value);
+         if (retval == DTL_JSON_NO_ERROR)
+         {
+            memcpy(pElem, &value, sizeof(value));
+         }
+      }
+      break;
+   case DTL_JSON_FIELD_I32:
+      {
+         int64_t value;
+         retval = dtl_json_cursor_get_i64(cursor, &value);
+         if (retval == DTL_JSON_NO_ERROR)
+         {
+            int32_t i32Value;
+            if ( (value < INT32_MIN) || (value > INT32_MAX) )
+            {
+               return DTL_JSON_TYPE_ERROR;
+            }
+            i32Value = (int32_t) value;
+            memcpy(pElem, &i32Value, sizeof(i32Value));
+         }
+      }
+      break;
+   case DTL_JSON_FIELD_U32:
+      {
+         uint64_t value;
+         retval = dtl_json_cursor_get_u64(cursor, &value);
+         if (retval == DTL_JSON_NO_ERROR)
+         {
+            uint32_t u32Value;
+            if (value > UINT32_MAX)
+            {
+               return DTL_JSON_TYPE_ERROR;
+            }
+            u32Value = (uint32_t) value;
+            memcpy(pElem, &u32Value, sizeof(u32Value));
+         }
+      }
+      break;
+   case DTL_JSON_FIELD_I64:
+      {
+         int64_t value;
+         retval = dtl_json_cursor_get_i64(cursor, &value);
+         if (retval == DTL_JSON_NO_ERROR)
+         {
+            memcpy(pElem, &value, sizeof(value));
+         }
+      }
+      break;
+   case DTL_JSON_FIELD_U64:
+      {
+         uint64_t value;
+         retval = dtl_json_cursor_get_u64(cursor, &value);
+         if (retval == DTL_JSON_NO_ERROR)
+         {
+            memcpy(pElem, &value, sizeof(value));
+         }
+      }
+      break;
+   case DTL_JSON_FIELD_DOUBLE:
+      {
+         double value;
+         retval = dtl_json_cursor_get_double(cursor, &value);
+         if (retval == DTL_JSON_NO_ERROR)
+         {
+            memcpy(pElem, &value, sizeof(value));
+         }
+      }
+      break;
+   case DTL_JSON_FIELD_STRING:
+      {
+         const char *pStr;
+         uint32_t strLen;
+         if (dtl_json_cursor_type(cursor) != DTL_JSON_TOKEN_STRING)
+         {
+            return DTL_JSON_TYPE_ERROR;
+         }
+         retval = dtl_json_cursor_get_string_slice(cursor, &pStr, &strLen);
+         if (retval == DTL_JSON_NO_ERROR)
+         {
+            if ( (size_t) strLen >= field->elemSize)
+            {
+               return DTL_JSON_LIMIT_ERROR;
+            }
+            memcpy(pElem, pStr, strLen);
+            pElem[strLen] = 0u;
+         }
+      }
+      break;
+   case DTL_JSON_FIELD_STRUCT:
+      if (field->schema != 0)
+      {
+         retval = dtl_json_decode_struct(cursor, field->schema, pElem);
+      }
+      break;
+   default:
+      break;
+   }
+   return retval;
+}
+
+/**
+ * Members usually appear in the same order as in the descriptor table, the search therefore starts after the previous match.
+ */
+static const dtl_json_field_t *dtl_json_decode_find_field(const dtl_json_schema_t *schema, const char *pKey, uint32_t keyLen, uint32_t *pHint)
+{
+   uint32_t i;
+   uint32_t index = *pHint;
+   for (i = 0u; i < schema->numFields; i++)
+   {
+      const dtl_json_field_t *field;
+      if (index >= schema->numFields)
+      {
+         index = 0u;
+      }
+      field = &schema->fields[index];
+      if ( (strlen(field->name) == (size_t) keyLen) && (memcmp(field->name, pKey, keyLen) == 0) )
+      {
+         *pHint = index + 1u;
+         return field;
+      }
+      index++;
+   }
+   return (const dtl_json_field_t*) 0;
+}
+
+static size_t dtl_json_schema_element_size(const dtl_json_field_t *field)
+{
+   switch(field->type)
+   {
+   case DTL_JSON_FIELD_BOOL:
+      return sizeof(bool);
+   case DTL_JSON_FIELD_I32:
+      return sizeof(int32_t);
+   case DTL_JSON_FIELD_U32:
+      return sizeof(uint32_t);
+   case DTL_JSON_FIELD_I64:
+      return sizeof(int64_t);
+   case DTL_JSON_FIELD_U64:
+      return sizeof(uint64_t);
+   case DTL_JSON_FIELD_DOUBLE:
+      return sizeof(double);
+   default:
+      break;
+   }
+   return field->elemSize;
+}
+
+static dtl_json_error_t dtl_json_decode_next(dtl_json_cursor_t *cursor)
+{
+   if (dtl_json_cursor_next(cursor) == DTL_JSON_TOKEN_ERROR)
+   {
+      return dtl_json_cursor_last_error(cursor);
+   }
+   return DTL_JSON_NO_ERROR;
+}
+
+static bool dtl_json_encoder_compile_key(dtl_json_encoder_field_t *compiled, const char *name)
+{
+   adt_str_t str;
+   bool isValid;
+   adt_str_create(&str);
+   isValid = dtl_json_encode_append(&str, ENCODE_SEPARATOR, ENCODE_SEPARATOR_LEN) &&
+             dtl_json_encode_string(name, strlen(name), &str) &&
+             dtl_json_encode_append(&str, ": ", 2u);
+   if (isValid)
+   {
+      compiled->keyLen = (uint32_t) adt_str_size(&str);
+      compiled->key = (char*) malloc(compiled->keyLen + 1u);
+      isValid = (compiled->key != 0);
+      if (isValid)
+      {
+         memcpy(compiled->key, adt_str_cstr(&str), compiled->keyLen + 1u);
+      }
+   }
+   adt_str_destroy(&str);
+   return isValid;
+}
+
+static bool dtl_json_encode_struct(const dtl_json_encoder_t *self, const uint8_t *base, adt_str_t *dest)
+{
+   uint32_t i;
+   if (adt_str_push(dest, '{') != ADT_NO_ERROR)
+   {
+      return false;
+   }
+   for (i = 0u; i < self->schema->numFields; i++)
+   {
+      const dtl_json_encoder_field_t *compiled = &self->fields[i];
+      uint32_t skip = (i == 0u)? ENCODE_SEPARATOR_LEN : 0u;
+      if ( (!dtl_json_encode_append(dest, compiled->key + skip, compiled->keyLen - skip)) ||
+           (!dtl_json_encode_field(compiled, &self->schema->fields[i], base, dest)) )
+      {
+         return false;
+      }
+   }
+   return (adt_str_push(dest, '}') == ADT_NO_ERROR);
+}
+
+static bool dtl_json_encode_field(const dtl_json_encoder_field_t *compiled, const dtl_json_field_t *field, const uint8_t *base, adt_str_t *dest)
+{
+   const uint8_t *pElem = base + field->offset;
+   size_t elemSize;
+   uint32_t count;
+   uint32_t i;
+   if (field->maxCount == 0u)
+   {
+      return dtl_json_encode_element(compiled, field, pElem, dest);
+   }
+   memcpy(&count, base + field->countOffset, sizeof(count));
+   if (count > field->maxCount)
+   {
+      count = field->maxCount;
+   }
+   elemSize = dtl_json_schema_element_size(field);
+   if (adt_str_push(dest, '[') != ADT_NO_ERROR)
+   {
+      return false;
+   }
+   for (i = 0u; i < count; i++)
+   {
+      if ( ( (i > 0u) && (!dtl_json_encode_append(dest, ENCODE_SEPARATOR, ENCODE_SEPARATOR_LEN)) ) ||
+           (!dtl_json_encode_element(compiled, field, pElem, dest)) )
+      {
+         return false;
+      }
+      pElem += elemSize;
+   }
+   return (adt_str_push(dest, ']') == ADT_NO_ERROR);
+}
+
+static bool dtl_json_encode_element(const dtl_json_encoder_field_t *compiled, const dtl_json_field_t *field, const uint8_t *pElem, adt_str_t *dest)
+{
+   switch(field->type)
+   {
+   case DTL_JSON_FIELD_BOOL:
+      {
+         bool value;
+         memcpy(&value, pElem, sizeof(value));
+         return value? dtl_json_encode_append(dest, "true", 4u) : dtl_json_encode_append(dest, "false", 5u);
+      }
+   case DTL_JSON_FIELD_I32:
+      {
+         int32_t value;
+         memcpy(&value, pElem, sizeof(value));
+         return dtl_json_encode_u64( (value < 0)? (0u - (uint64_t) value) : (uint64_t) value, (value < 0), dest);
+      }
+   case DTL_JSON_FIELD_U32:
+      {
+         uint32_t value;
+         memcpy(&value, pElem, sizeof(value));
+         return dtl_json_encode_u64( (uint64_t) value, false, dest);
+      }
+   case DTL_JSON_FIELD_I64:
+      {
+         int64_t value;
+         memcpy(&value, pElem, sizeof(value));
+         return dtl_json_encode_u64( (value < 0)? (0u - (uint64_t) value) : (uint64_t) value, (value < 0), dest);
+      }
+   case DTL_JSON_FIELD_U64:
+      {
+         uint64_t value;
+         memcpy(&value, pElem, sizeof(value));
+         return dtl_json_encode_u64(value, false, dest);
+      }
+   case DTL_JSON_FIELD_DOUBLE:
+      {
+         char buf[ENCODE_BUF_SIZE];
+         double value;
+         int32_t len;
+         memcpy(&value, pElem, sizeof(value));
+         len = dtl_json_number_format_double(value, buf, (uint32_t) sizeof(buf));
+         if (len < 0)
+         {
+            return dtl_json_encode_append(dest, "null", 4u); //inf and NaN cannot be represented in JSON
+         }
+         return dtl_json_encode_append(dest, buf, (size_t) len);
+      }
+   case DTL_JSON_FIELD_STRING:
+      {
+         const char *pEnd = (const char*) memchr(pElem, 0, field->elemSize);
+         size_t strLen = (pEnd != 0)? (size_t) (pEnd - (const char*) pElem) : field->elemSize;
+         return dtl_json_encode_string( (const char*) pElem, strLen, dest);
+      }
+   case DTL_JSON_FIELD_STRUCT:
+      return dtl_json_encode_struct(compiled->child, pElem, dest);
+   default:
+      break;
+   }
+   return dtl_json_encode_append(dest, "null", 4u);
+}
+
+/**
+ * Writes magnitude of an integer, with a minus sign when isNegative is set.
+ */
+static bool dtl_json_encode_u64(uint64_t value, bool isNegative, adt_str_t *dest)
+{
+   char buf[ENCODE_BUF_SIZE];
+   char *pBegin = &buf[ENCODE_BUF_SIZE];
+   do
+   {
+      *(--pBegin) = (char) ('0' + (value % 10u));
+      value /= 10u;
+   } while (value > 0u);
+   if (isNegative)
+   {
+      *(--pBegin) = '-';
+   }
+   return dtl_json_encode_append(dest, pBegin, (size_t) (&buf[ENCODE_BUF_SIZE] - pBegin));
+}
+
+/**
+ * Writes a quoted JSON string. Runs of characters that need no escaping are appended with a single copy.
+ */
+static bool dtl_json_encode_string(const char *pStr, size_t strLen, adt_str_t *dest)
+{
+   static const char hexDigits[] = "0123456789abcdef";
+   const uint8_t *pNext = (const uint8_t*) pStr;
+   const uint8_t *pEnd = pNext + strLen;
+   const uint8_t *pRun = pNext;
+   if (adt_str_push(dest, '"') != ADT_NO_ERROR)
+   {
+      return false;
+   }
+   while (pNext < pEnd)
+   {
+      uint8_t c = *pNext;
+      bool isValid;
+      if ( (c >= 0x20u) && (c != '"') && (c != '\\') )
+      {
+         pNext++;
+         continue;
+      }
+      if (!dtl_json_encode_append(dest, (const char*) pRun, (size_t) (pNext - pRun)))
+      {
+         return false;
+      }
+      switch(c)
+      {
+      case '"':
+         isValid = dtl_json_encode_append(dest, "\\\"", 2u);
+         break;
+      case '\\':
+         isValid = dtl_json_encode_append(dest, "\\\\", 2u);
+         break;
+      case '\b':
+         isValid = dtl_json_encode_append(dest, "\\b", 2u);
+         break;
+      case '\f':
+         isValid = dtl_json_encode_append(dest, "\\f", 2u);
+         break;
+      case '\n':
+         isValid = dtl_json_encode_append(dest, "\\n", 2u);
+         break;
+      case '\r':
+         isValid = dtl_json_encode_append(dest, "\\r", 2u);
+         break;
+      case '\t':
+         isValid = dtl_json_encode_append(dest, "\\t", 2u);
+         break;
+      default:
+         {
+            char buf[6] = {'\\', 'u', '0', '0', 0, 0};
+            buf[4] = hexDigits[c >> 4];
+            buf[5] = hexDigits[c & 0x0Fu];
+            isValid = dtl_json_encode_append(dest, buf, sizeof(buf));
+         }
+         break;
+      }
+      if (!isValid)
+      {
+         return false;
+      }
+      pRun = ++pNext;
+   }
+   return dtl_json_encode_append(dest, (const char*) pRun, (size_t) (pEnd - pRun)) &&
+          (adt_str_push(dest, '"') == ADT_NO_ERROR);
+}
+
+static bool dtl_json_encode_append(adt_str_t *dest, const char *pStr, size_t len)
+{
+   return (adt_str_append_bstr(dest, (const uint8_t*) pStr, (const uint8_t*) pStr + len) == ADT_NO_ERROR);
+}
@@ -0,0 +1,606 @@
+/*****************************************************************************
+* \file      dtl_json_update.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Updates an existing dtl tree from a new JSON document
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include "dtl_json.h"
+#include "dtl_json_intern.h"
+#include "adt_bytearray.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define UPDATE_PATH_GROW_SIZE 256u
+
+typedef struct dtl_json_update_context_tag
+{
+   dtl_json_cursor_t cursor;
+   dtl_av_t *changes; //may be NULL
+   adt_bytearray_t path; //JSON Pointer of the current value, not null-terminated
+   adt_str_t *keys; //for each depth, the key of the member being updated
+   adt_str_t tmpStr;
+   dtl_json_intern_t seenKeys; //keys seen so far, each prefixed by the serial number of its object
+   uint32_t numObjects;
+   dtl_json_error_t lastError;
+} dtl_json_update_context_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static dtl_dv_t *dtl_json_update_value(dtl_json_update_context_t *ctx, dtl_dv_t *oldValue);
+static dtl_dv_t *dtl_json_update_object(dtl_json_update_context_t *ctx, dtl_hv_t *hv);
+static dtl_dv_t *dtl_json_update_array(dtl_json_update_context_t *ctx, dtl_av_t *av);
+static dtl_dv_t *dtl_json_update_rebuild_object(dtl_json_update_context_t *ctx, dtl_hv_t *hv, const uint8_t *pBegin, const uint8_t *pEnd);
+static dtl_dv_t *dtl_json_update_rebuild_array(dtl_json_update_context_t *ctx, dtl_av_t *av, int32_t length);
+static dtl_dv_t *dtl_json_update_make_value(dtl_json_update_context_t *ctx);
+static bool dtl_json_update_is_equal(dtl_json_cursor_t *cursor, const dtl_dv_t *dv);
+static bool dtl_json_update_is_equal_number(dtl_json_cursor_t *cursor, const dtl_sv_t *sv);
+static bool dtl_json_update_push_key(dtl_json_update_context_t *ctx, const char *pKey, uint32_t keyLen);
+static bool dtl_json_update_mark_key(dtl_json_update_context_t *ctx, uint32_t serial, const char *pKey, uint32_t keyLen, bool *pIsFirst);
+static bool dtl_json_update_push_index(dtl_json_update_context_t *ctx, int32_t index);
+static void dtl_json_update_report(dtl_json_update_context_t *ctx);
+static void dtl_json_update_set_error(dtl_json_update_context_t *ctx, dtl_json_error_t errorCode);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Updates the tree in *ppDv to match the JSON document in the buffer, for example when a configuration file is reloaded.
+ * Arrays and objects are updated in place and scalars that are equal to the new value are kept, so pointers held to
+ * unchanged parts of the tree remain valid. Changed scalars and values whose type changed are replaced by new values.
+ * dtl_hv_t and dtl_av_t cannot remove entries, an array or object that lost members is therefore replaced by a new container
+ * holding the same children. *ppDv itself is replaced when it is NULL, when the type of the top-level value changed or
+ * when it lost members, the old value is then released.
+ * When changes is not NULL, the JSON Pointer (as a string) of every added, removed or replaced value is pushed to it in document order.
+ * The document is validated before the tree is touched, a malformed document leaves it unchanged.
+ * Documents nested deeper than DTL_JSON_CURSOR_MAX_DEPTH levels give DTL_JSON_LIMIT_ERROR.
+ */
+dtl_json_error_t dtl_json_load_into(dtl_dv_t **ppDv, const uint8_t *pBegin, const uint8_t *pEnd, dtl_av_t *changes)
+{
+   dtl_json_update_context_t ctx;
+   dtl_json_error_t retval;
+   dtl_dv_t *result = (dtl_dv_t*) 0;
+   int32_t i;
+   if (ppDv == 0)
+   {
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   retval = dtl_json_validate(pBegin, pEnd, (dtl_json_error_info_t*) 0);
+   if (retval != DTL_JSON_NO_ERROR)
+   {
+      return retval;
+   }
+   ctx.keys = (adt_str_t*) malloc(sizeof(adt_str_t) * DTL_JSON_CURSOR_MAX_DEPTH);
+   if (ctx.keys == 0)
+   {
+      return DTL_JSON_MEM_ERROR;
+   }
+   for (i = 0; i < DTL_JSON_CURSOR_MAX_DEPTH; i++)
+   {
+      adt_str_create(&ctx.keys[i]);
+   }
+   ctx.changes = changes;
+   ctx.lastError = DTL_JSON_NO_ERROR;
+   adt_bytearray_create(&ctx.path, UPDATE_PATH_GROW_SIZE);
+   adt_str_create(&ctx.tmpStr);
+   dtl_json_intern_create(&ctx.seenKeys, 0u);
+   ctx.numObjects = 0u;
+   dtl_json_cursor_create(&ctx.cursor, pBegin, pEnd);
+   if (dtl_json_cursor_next(&ctx.cursor) == DTL_JSON_TOKEN_ERROR)
+   {
+      dtl_json_update_set_error(&ctx, dtl_json_cursor_last_error(&ctx.cursor));
+   }
+   else
+   {
+      result = dtl_json_update_value(&ctx, *ppDv);
+   }
+   if ( (result != 0) && (result != *ppDv) )
+   {
+      if (*ppDv != 0)
+      {
+         dtl_dv_dec_ref(*ppDv);
+      }
+      *ppDv = result;
+   }
+   retval = ctx.lastError;
+   dtl_json_cursor_destroy(&ctx.cursor);
+   dtl_json_intern_destroy(&ctx.seenKeys);
+   adt_str_destroy(&ctx.tmpStr);
+   adt_bytearray_destroy(&ctx.path);
+   for (i = 0; i < DTL_JSON_CURSOR_MAX_DEPTH; i++)
+   {
+      adt_str_destroy(&ctx.keys[i]);
+   }
+   free(ctx.keys);
+   return retval;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Updates oldValue (which may be NULL) from the value at the current token of the cursor.
+ * Returns oldValue when it was kept (its content may have been updated), otherwise a new value which the caller takes ownership of.
+ * Returns NULL on error.
+ */
+static dtl_dv_t *dtl_json_update_value(dtl_json_update_context_t *ctx, dtl_dv_t *oldValue)
+{
+   dtl_json_token_t token = dtl_json_cursor_type(&ctx->cursor);
+   dtl_dv_t *retval;
+   if ( (token == DTL_JSON_TOKEN_BEGIN_OBJECT) && (oldValue != 0) && (dtl_dv_type(oldValue) == DTL_DV_HASH) )
+   {
+      return dtl_json_update_object(ctx, (dtl_hv_t*) oldValue);
+   }
+   else if ( (token == DTL_JSON_TOKEN_BEGIN_ARRAY) && (oldValue != 0) && (dtl_dv_type(oldValue) == DTL_DV_ARRAY) )
+   {
+      return dtl_json_update_array(ctx, (dtl_av_t*) oldValue);
+   }
+   else if ( (oldValue != 0) && dtl_json_update_is_equal(&ctx->cursor, oldValue) )
+   {
+      return oldValue;
+   }
+   retval = dtl_json_update_make_value(ctx);
+   if (retval != 0)
+   {
+      dtl_json_update_report(ctx);
+   }
+   return retval;
+}
+
+/**
+ * Cursor must be at the beginning of the object. Members are updated in place and new members are added.
+ * numMatched counts the distinct members of hv found in the document, a key repeated in the document is only counted once.
+ */
+static dtl_dv_t *dtl_json_update_object(dtl_json_update_context_t *ctx, dtl_hv_t *hv)
+{
+   const uint8_t *pObjectBegin = ctx->cursor.pTokenBegin;
+   adt_str_t *key = &ctx->keys[dtl_json_cursor_depth(&ctx->cursor) - 1];
+   uint32_t pathLen = adt_bytearray_length(&ctx->path);
+   uint32_t serial = ctx->numObjects++;
+   int32_t numOld = dtl_hv_length(hv);
+   int32_t numMatched = 0;
+   dtl_json_token_t token;
+   while ( (token = dtl_json_cursor_next(&ctx->cursor)) == DTL_JSON_TOKEN_KEY)
+   {
+      const char *pKey = (const char*) 0;
+      uint32_t keyLen = 0u;
+      bool isFirst = false;
+      dtl_dv_t *oldChild;
+      dtl_dv_t *child;
+      if ( (dtl_json_cursor_get_string_slice(&ctx->cursor, &pKey, &keyLen) != DTL_JSON_NO_ERROR) ||
+           (!dtl_json_update_mark_key(ctx, serial, pKey, keyLen, &isFirst)) ||
+           (adt_str_set_bstr(key, (const uint8_t*) pKey, (const uint8_t*) pKey + keyLen) != ADT_NO_ERROR) ||
+           (!dtl_json_update_push_key(ctx, pKey, keyLen)) )
+      {
+         dtl_json_update_set_error(ctx, DTL_JSON_MEM_ERROR);
+         return (dtl_dv_t*) 0;
+      }
+      (void) dtl_json_cursor_next(&ctx->cursor);
+      oldChild = dtl_hv_get_cstr(hv, adt_str_cstr(key));
+      child = dtl_json_update_value(ctx, oldChild);
+      if (child == 0)
+      {
+         return (dtl_dv_t*) 0;
+      }
+      if ( (oldChild != 0) && isFirst )
+      {
+         //a key seen for the first time that is already in hv was there before this update
+         numMatched++;
+      }
+      if (child != oldChild)
+      {
+         dtl_hv_set_cstr(hv, adt_str_cstr(key), child, false);
+      }
+      (void) adt_bytearray_resize(&ctx->path, pathLen);
+   }
+   if (token != DTL_JSON_TOKEN_END_OBJECT)
+   {
+      dtl_json_update_set_error(ctx, dtl_json_cursor_last_error(&ctx->cursor));
+      return (dtl_dv_t*) 0;
+   }
+   if (numMatched < numOld)
+   {
+      return dtl_json_update_rebuild_object(ctx, hv, pObjectBegin, ctx->cursor.pTokenEnd);
+   }
+   return (dtl_dv_t*) hv;
+}
+
+/**
+ * Cursor must be at the beginning of the array. Elements are updated in place and new elements are pushed.
+ */
+static dtl_dv_t *dtl_json_update_array(dtl_json_update_context_t *ctx, dtl_av_t *av)
+{
+   uint32_t pathLen = adt_bytearray_length(&ctx->path);
+   int32_t numOld = dtl_av_length(av);
+   int32_t index = 0;
+   dtl_json_token_t token;
+   while ( ( (token = dtl_json_cursor_next(&ctx->cursor)) != DTL_JSON_TOKEN_END_ARRAY) && (token != DTL_JSON_TOKEN_ERROR) )
+   {
+      dtl_dv_t *oldChild = (index < numOld)? dtl_av_value(av, index) : (dtl_dv_t*) 0;
+      dtl_dv_t *child;
+      if (!dtl_json_update_push_index(ctx, index))
+      {
+         dtl_json_update_set_error(ctx, DTL_JSON_MEM_ERROR);
+         return (dtl_dv_t*) 0;
+      }
+      child = dtl_json_update_value(ctx, oldChild);
+      if (child == 0)
+      {
+         return (dtl_dv_t*) 0;
+      }
+      if (index >= numOld)
+      {
+         dtl_av_push(av, child, false);
+      }
+      else if (child != oldChild)
+      {
+         dtl_av_set(av, index, child, false);
+      }
+      (void) adt_bytearray_resize(&ctx->path, pathLen);
+      index++;
+   }
+   if (token == DTL_JSON_TOKEN_ERROR)
+   {
+      dtl_json_update_set_error(ctx, dtl_json_cursor_last_error(&ctx->cursor));
+      return (dtl_dv_t*) 0;
+   }
+   if (index < numOld)
+   {
+      return dtl_json_update_rebuild_array(ctx, av, index);
+   }
+   return (dtl_dv_t*) av;
+}
+
+/**
+ * Creates a new object holding the members of hv that are found in the object between pBegin and pEnd,
+ * and reports the members that are not.
+ */
+static dtl_dv_t *dtl_json_update_rebuild_object(dtl_json_update_context_t *ctx, dtl_hv_t *hv, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   dtl_json_cursor_t cursor;
+   dtl_hv_t *result = dtl_hv_new();
+   dtl_av_t *keys = dtl_hv_keys(hv);
+   uint32_t pathLen = adt_bytearray_length(&ctx->path);
+   int32_t numKeys;
+   int32_t i;
+   if ( (result == 0) || (keys == 0) )
+   {
+      if (result != 0)
+      {
+         dtl_dv_dec_ref((dtl_dv_t*) result);
+      }
+      if (keys != 0)
+      {
+         dtl_dv_dec_ref((dtl_dv_t*) keys);
+      }
+      dtl_json_update_set_error(ctx, DTL_JSON_MEM_ERROR);
+      return (dtl_dv_t*) 0;
+   }
+   dtl_json_cursor_create(&cursor, pBegin, pEnd);
+   (void) dtl_json_cursor_next(&cursor);
+   while (dtl_json_cursor_next(&cursor) == DTL_JSON_TOKEN_KEY)
+   {
+      const char *pKey = (const char*) 0;
+      uint32_t keyLen = 0u;
+      if ( (dtl_json_cursor_get_string_slice(&cursor, &pKey, &keyLen) == DTL_JSON_NO_ERROR) &&
+           (adt_str_set_bstr(&ctx->tmpStr, (const uint8_t*) pKey, (const uint8_t*) pKey + keyLen) == ADT_NO_ERROR) )
+      {
+         dtl_hv_set_cstr(result, adt_str_cstr(&ctx->tmpStr), dtl_hv_get_cstr(hv, adt_str_cstr(&ctx->tmpStr)), true);
+      }
+      (void) dtl_json_cursor_skip(&cursor);
+   }
+   dtl_json_cursor_destroy(&cursor);
+   numKeys = dtl_av_length(keys);
+   for (i = 0; i < numKeys; i++)
+   {
+      bool ok = false;
+      const char *key = dtl_sv_to_cstr((dtl_sv_t*) dtl_av_value(keys, i), &ok);
+      if ( ok && (dtl_hv_get_cstr(result, key) == 0) )
+      {
+         if (dtl_json_update_push_key(ctx, key, (uint32_t) strlen(key)))
+         {
+            dtl_json_update_report(ctx);
+         }
+         (void) adt_bytearray_resize(&ctx->path, pathLen);
+      }
+   }
+   dtl_dv_dec_ref((dtl_dv_t*) keys);
+   return (dtl_dv_t*) result;
+}
+
+/**
+ * Creates a new array holding the first length elements of av, and reports the elements that follow.
+ */
+static dtl_dv_t *dtl_json_update_rebuild_array(dtl_json_update_context_t *ctx, dtl_av_t *av, int32_t length)
+{
+   dtl_av_t *result = dtl_av_new();
+   uint32_t pathLen = adt_bytearray_length(&ctx->path);
+   int32_t numOld = dtl_av_length(av);
+   int32_t i;
+   if (result == 0)
+   {
+      dtl_json_update_set_error(ctx, DTL_JSON_MEM_ERROR);
+      return (dtl_dv_t*) 0;
+   }
+   for (i = 0; i < length; i++)
+   {
+      dtl_av_push(result, dtl_av_value(av, i), true);
+   }
+   for (i = length; i < numOld; i++)
+   {
+      if (dtl_json_update_push_index(ctx, i))
+      {
+         dtl_json_update_report(ctx);
+      }
+      (void) adt_bytearray_resize(&ctx->path, pathLen);
+   }
+   return (dtl_dv_t*) result;
+}
+
+/**
+ * Creates a new value from the current token of the cursor. Arrays and objects are loaded by dtl_json_load_bstr,
+ * scalars are created directly, using the same types as dtl_json_load_bstr.
+ */
+static dtl_dv_t *dtl_json_update_make_value(dtl_json_update_context_t *ctx)
+{
+   dtl_json_cursor_t *cursor = &ctx->cursor;
+   dtl_dv_t *retval = (dtl_dv_t*) 0;
+   const char *pStr = (const char*) 0;
+   uint32_t strLen = 0u;
+   const uint8_t *pValueBegin = cursor->pTokenBegin;
+   int64_t i64;
+   uint64_t u64;
+   double dbl;
+   switch(dtl_json_cursor_type(cursor))
+   {
+   case DTL_JSON_TOKEN_BEGIN_OBJECT:
+   case DTL_JSON_TOKEN_BEGIN_ARRAY:
+      if (dtl_json_cursor_skip(cursor) == DTL_JSON_NO_ERROR)
+      {
+         retval = dtl_json_load_bstr(pValueBegin, cursor->pTokenEnd);
+      }
+      break;
+   case DTL_JSON_TOKEN_STRING:
+      if ( (dtl_json_cursor_get_string_slice(cursor, &pStr, &strLen) == DTL_JSON_NO_ERROR) &&
+           (adt_str_set_bstr(&ctx->tmpStr, (const uint8_t*) pStr, (const uint8_t*) pStr + strLen) == ADT_NO_ERROR) )
+      {
+         retval = (dtl_dv_t*) dtl_sv_make_str(&ctx->tmpStr);
+      }
+      break;
+   case DTL_JSON_TOKEN_NUMBER:
+      if (dtl_json_cursor_get_i64(cursor, &i64) == DTL_JSON_NO_ERROR)
+      {
+         if ( (i64 >= INT32_MIN) && (i64 <= INT32_MAX) )
+         {
+            retval = (dtl_dv_t*) dtl_sv_make_i32((int32_t) i64);
+         }
+         else if ( (i64 > 0) && (i64 <= UINT32_MAX) )
+         {
+            retval = (dtl_dv_t*) dtl_sv_make_u32((uint32_t) i64);
+         }
+         else
+         {
+            retval = (dtl_dv_t*) dtl_sv_make_i64(i64);
+         }
+      }
+      else if (dtl_json_cursor_get_u64(cursor, &u64) == DTL_JSON_NO_ERROR)
+      {
+         retval = (dtl_dv_t*) dtl_sv_make_u64(u64);
+      }
+      else if (dtl_json_cursor_get_double(cursor, &dbl) == DTL_JSON_NO_ERROR)
+      {
+         retval = (dtl_dv_t*) dtl_sv_make_dbl(dbl);
+      }
+      break;
+   case DTL_JSON_TOKEN_TRUE:
+   case DTL_JSON_TOKEN_FALSE:
+      retval = (dtl_dv_t*) dtl_sv_make_bool(dtl_json_cursor_type(cursor) == DTL_JSON_TOKEN_TRUE);
+      break;
+   case DTL_JSON_TOKEN_NULL:
+      retval = (dtl_dv_t*) dtl_sv_none();
+      break;
+   default:
+      break;
+   }
+   if (retval == 0)
+   {
+      dtl_json_update_set_error(ctx, DTL_JSON_MEM_ERROR);
+   }
+   return retval;
+}
+
+/**
+ * Returns true when dv is a scalar equal to the scalar at the current token of the cursor.
+ * Integers are compared by value regardless of their storage type, but an integer is never equal to a double.
+ */
+static bool dtl_json_update_is_equal(dtl_json_cursor_t *cursor, const dtl_dv_t *dv)
+{
+   dtl_json_token_t token = dtl_json_cursor_type(cursor);
+   const dtl_sv_t *sv = (const dtl_sv_t*) dv;
+   bool ok = false;
+   if (dtl_dv_type(dv) == DTL_DV_NULL)
+   {
+      return (token == DTL_JSON_TOKEN_NULL);
+   }
+   else if (dtl_dv_type(dv) != DTL_DV_SCALAR)
+   {
+      return false;
+   }
+   switch(dtl_sv_type(sv))
+   {
+   case DTL_SV_NONE:
+      return (token == DTL_JSON_TOKEN_NULL);
+   case DTL_SV_BOOL:
+      if ( (token == DTL_JSON_TOKEN_TRUE) || (token == DTL_JSON_TOKEN_FALSE) )
+      {
+         bool value = dtl_sv_to_bool(sv, &ok);
+         return ( ok && (value == (token == DTL_JSON_TOKEN_TRUE)) );
+      }
+      break;
+   case DTL_SV_STR:
+      if (token == DTL_JSON_TOKEN_STRING)
+      {
+         const char *pStr = (const char*) 0;
+         uint32_t strLen = 0u;
+         const char *value = dtl_sv_to_cstr((dtl_sv_t*) sv, &ok);
+         if ( ok && (dtl_json_cursor_get_string_slice(cursor, &pStr, &strLen) == DTL_JSON_NO_ERROR) )
+         {
+            return ( (strlen(value) == (size_t) strLen) && (memcmp(value, pStr, strLen) == 0) );
+         }
+      }
+      break;
+   default:
+      if (token == DTL_JSON_TOKEN_NUMBER)
+      {
+         return dtl_json_update_is_equal_number(cursor, sv);
+      }
+   }
+   return false;
+}
+
+static bool dtl_json_update_is_equal_number(dtl_json_cursor_t *cursor, const dtl_sv_t *sv)
+{
+   bool ok = false;
+   int64_t i64;
+   uint64_t u64;
+   double dbl;
+   dtl_sv_type_id type = dtl_sv_type(sv);
+   if (dtl_json_cursor_get_i64(cursor, &i64) == DTL_JSON_NO_ERROR)
+   {
+      if ( (type == DTL_SV_I32) || (type == DTL_SV_U32) || (type == DTL_SV_I64) )
+      {
+         return ( (dtl_sv_to_i64(sv, &ok) == i64) && ok );
+      }
+      else if (type == DTL_SV_U64)
+      {
+         return ( (i64 >= 0) && (dtl_sv_to_u64(sv, &ok) == (uint64_t) i64) && ok );
+      }
+   }
+   else if (dtl_json_cursor_get_u64(cursor, &u64) == DTL_JSON_NO_ERROR)
+   {
+      return ( (type == DTL_SV_U64) && (dtl_sv_to_u64(sv, &ok) == u64) && ok );
+   }
+   else if ( (type == DTL_SV_DBL) && (dtl_json_cursor_get_double(cursor, &dbl) == DTL_JSON_NO_ERROR) )
+   {
+      return ( (dtl_sv_to_dbl(sv, &ok) == dbl) && ok );
+   }
+   return false;
+}
+
+/**
+ * Appends the key to the path as an escaped reference token.
+ */
+static bool dtl_json_update_push_key(dtl_json_update_context_t *ctx, const char *pKey, uint32_t keyLen)
+{
+   uint32_t i;
+   if (adt_bytearray_append(&ctx->path, (const uint8_t*) "/", 1u) != ADT_NO_ERROR)
+   {
+      return false;
+   }
+   for (i = 0u; i < keyLen; i++)
+   {
+      const char *pEscaped = (pKey[i] == '~')? "~0" : ( (pKey[i] == '/')? "~1" : (const char*) 0 );
+      adt_error_t result;
+      if (pEscaped != 0)
+      {
+         result = adt_bytearray_append(&ctx->path, (const uint8_t*) pEscaped, 2u);
+      }
+      else
+      {
+         result = adt_bytearray_append(&ctx->path, (const uint8_t*) &pKey[i], 1u);
+      }
+      if (result != ADT_NO_ERROR)
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+/**
+ * Records the key as seen in the object with the given serial number. *pIsFirst tells if it had not been seen there before.
+ * Using one table for the whole document avoids clearing a table for every object.
+ */
+static bool dtl_json_update_mark_key(dtl_json_update_context_t *ctx, uint32_t serial, const char *pKey, uint32_t keyLen, bool *pIsFirst)
+{
+   uint32_t numKeys = dtl_json_intern_length(&ctx->seenKeys);
+   const uint8_t *pEntry;
+   if ( (adt_str_set_bstr(&ctx->tmpStr, (const uint8_t*) &serial, (const uint8_t*) &serial + sizeof(serial)) != ADT_NO_ERROR) ||
+        (adt_str_append_bstr(&ctx->tmpStr, (const uint8_t*) pKey, (const uint8_t*) pKey + keyLen) != ADT_NO_ERROR) )
+   {
+      return false;
+   }
+   pEntry = (const uint8_t*) adt_str_cstr(&ctx->tmpStr);
+   if (dtl_json_intern_bstr(&ctx->seenKeys, pEntry, pEntry + sizeof(serial) + keyLen) == 0)
+   {
+      return false;
+   }
+   *pIsFirst = (dtl_json_intern_length(&ctx->seenKeys) > numKeys);
+   return true;
+}
+
+static bool dtl_json_update_push_index(dtl_json_update_context_t *ctx, int32_t index)
+{
+   char buf[16];
+   int len = sprintf(buf, "/%d", (int) index);
+   return (adt_bytearray_append(&ctx->path, (const uint8_t*) buf, (uint32_t) len) == ADT_NO_ERROR);
+}
+
+/**
+ * Pushes the current path to the change list.
+ */
+static void dtl_json_update_report(dtl_json_update_context_t *ctx)
+{
+   if (ctx->changes != 0)
+   {
+      const uint8_t *pPath = adt_bytearray_data(&ctx->path);
+      uint32_t pathLen = adt_bytearray_length(&ctx->path);
+      if (pathLen == 0u)
+      {
+         //the whole document
+         dtl_av_push(ctx->changes, (dtl_dv_t*) dtl_sv_make_cstr(""), false);
+      }
+      else if (adt_str_set_bstr(&ctx->tmpStr, pPath, pPath + pathLen) == ADT_NO_ERROR)
+      {
+         dtl_av_push(ctx->changes, (dtl_dv_t*) dtl_sv_make_str(&ctx->tmpStr), false);
+      }
+   }
+}
+
+static void dtl_json_update_set_error(dtl_json_update_context_t *ctx, dtl_json_error_t errorCode)
+{
+   if (ctx->lastError == DTL_JSON_NO_ERROR)
+   {
+      ctx->lastError = (errorCode != DTL_JSON_NO_ERROR)? errorCode : DTL_JSON_UNEXPECTED_CHAR_ERROR;
+   }
+}
@@ -0,0 +1,323 @@
+/*****************************************************************************
+* \file      dtl_json_validate.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Validate-only parsing of JSON documents
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "dtl_json.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define VALIDATE_ASCII_MASK UINT64_C(0x8080808080808080)
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static dtl_json_error_t dtl_json_validate_document(const uint8_t *pBegin, const uint8_t *pEnd, bool checkUtf8, dtl_json_error_info_t *errInfo);
+static const uint8_t *dtl_json_validate_string(const uint8_t *pBegin, const uint8_t *pEnd, bool checkUtf8, dtl_json_error_t *errorCode);
+static const uint8_t *dtl_json_validate_escape(const uint8_t *pBegin, const uint8_t *pEnd);
+static const uint8_t *dtl_json_validate_utf8_char(const uint8_t *pBegin, const uint8_t *pEnd);
+static void dtl_json_validate_set_error_info(dtl_json_error_info_t *errInfo, dtl_json_error_t errorCode, const uint8_t *pBegin,
+                                             const uint8_t *pError, uint32_t lineNumber);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Checks that the buffer holds exactly one well-formed JSON document without creating any dtl values.
+ * Returns DTL_JSON_NO_ERROR for a valid document, otherwise the error code of the first problem found.
+ * Nesting deeper than DTL_JSON_CURSOR_MAX_DEPTH levels gives DTL_JSON_LIMIT_ERROR even though the document is well-formed.
+ * When errInfo is not NULL it receives the error code and the location of the offending byte.
+ */
+dtl_json_error_t dtl_json_validate(const uint8_t *pBegin, const uint8_t *pEnd, dtl_json_error_info_t *errInfo)
+{
+   return dtl_json_validate_document(pBegin, pEnd, false, errInfo);
+}
+
+/**
+ * Same as dtl_json_validate but also checks that all strings and keys are well-formed UTF-8.
+ * Overlong encodings, surrogates and code points above U+10FFFF are rejected with DTL_JSON_INVALID_UTF8_ERROR.
+ */
+dtl_json_error_t dtl_json_validate_utf8(const uint8_t *pBegin, const uint8_t *pEnd, dtl_json_error_info_t *errInfo)
+{
+   return dtl_json_validate_document(pBegin, pEnd, true, errInfo);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Steps through the document with a cursor. Structure, literals and numbers are checked by the cursor itself,
+ * string content is only inspected here when the cursor saw escapes or control characters (or when UTF-8 is checked).
+ */
+static dtl_json_error_t dtl_json_validate_document(const uint8_t *pBegin, const uint8_t *pEnd, bool checkUtf8, dtl_json_error_info_t *errInfo)
+{
+   dtl_json_cursor_t cursor;
+   dtl_json_error_t retval = DTL_JSON_NO_ERROR;
+   const uint8_t *pError = (const uint8_t*) 0;
+   if (errInfo != 0)
+   {
+      memset(errInfo, 0, sizeof(dtl_json_error_info_t));
+   }
+   if ( (pBegin == 0) || (pEnd == 0) || (pEnd < pBegin) )
+   {
+      if (errInfo != 0)
+      {
+         errInfo->errorCode = DTL_JSON_INVALID_ARGUMENT_ERROR;
+      }
+      return DTL_JSON_INVALID_ARGUMENT_ERROR;
+   }
+   dtl_json_cursor_create(&cursor, pBegin, pEnd);
+   for(;;)
+   {
+      dtl_json_token_t token = dtl_json_cursor_next(&cursor);
+      if (token == DTL_JSON_TOKEN_END)
+      {
+         break;
+      }
+      else if (token == DTL_JSON_TOKEN_ERROR)
+      {
+         retval = cursor.lastError;
+         pError = cursor.pNext;
+         break;
+      }
+      else if ( ( (token == DTL_JSON_TOKEN_STRING) || (token == DTL_JSON_TOKEN_KEY) ) &&
+                ( (!cursor.isPlainString) || checkUtf8 ) )
+      {
+         pError = dtl_json_validate_string(cursor.pTokenBegin + 1, cursor.pTokenEnd - 1, checkUtf8, &retval);
+         if (pError != 0)
+         {
+            break;
+         }
+      }
+   }
+   if (retval != DTL_JSON_NO_ERROR)
+   {
+      dtl_json_validate_set_error_info(errInfo, retval, pBegin, pError, cursor.lineNumber);
+   }
+   dtl_json_cursor_destroy(&cursor);
+   return retval;
+}
+
+/**
+ * Checks the content of a string literal (without quotes).
+ * Returns pointer to the first invalid byte and sets *errorCode, or NULL when the content is valid.
+ */
+static const uint8_t *dtl_json_validate_string(const uint8_t *pBegin, const uint8_t *pEnd, bool checkUtf8, dtl_json_error_t *errorCode)
+{
+   const uint8_t *pNext = pBegin;
+   while (pNext < pEnd)
+   {
+      uint8_t c;
+      if (checkUtf8)
+      {
+         //skip 8 bytes at a time as long as they are plain ASCII without quotes, backslashes or control characters
+         while ((pNext + 8) <= pEnd)
+         {
+            uint64_t word;
+            memcpy(&word, pNext, sizeof(word));
+            if ( (word & VALIDATE_ASCII_MASK) != 0u )
+            {
+               break;
+            }
+            else
+            {
+               uint64_t low = (word - UINT64_C(0x2020202020202020)) & ~word & VALIDATE_ASCII_MASK;
+               uint64_t x = word ^ UINT64_C(0x5C5C5C5C5C5C5C5C);
+               uint64_t backslash = (x - UINT64_C(0x0101010101010101)) & ~x & VALIDATE_ASCII_MASK;
+               if ( (low | backslash) != 0u )
+               {
+                  break;
+               }
+            }
+            pNext += 8;
+         }
+         if (pNext >= pEnd)
+         {
+            break;
+         }
+      }
+      c = *pNext;
+      if (c == '\\')
+      {
+         const uint8_t *pResult = dtl_json_validate_escape(pNext, pEnd);
+         if (pResult == 0)
+         {
+            *errorCode = DTL_JSON_INVALID_ESCAPE_ERROR;
+            return pNext;
+         }
+         pNext = pResult;
+      }
+      else if (c < 0x20u)
+      {
+         *errorCode = DTL_JSON_UNEXPECTED_CHAR_ERROR;
+         return pNext;
+      }
+      else if ( (c >= 0x80u) && checkUtf8 )
+      {
+         const uint8_t *pResult = dtl_json_validate_utf8_char(pNext, pEnd);
+         if (pResult == 0)
+         {
+            *errorCode = DTL_JSON_INVALID_UTF8_ERROR;
+            return pNext;
+         }
+         pNext = pResult;
+      }
+      else
+      {
+         pNext++;
+      }
+   }
+   return (const uint8_t*) 0;
+}
+
+/**
+ * pBegin must point to a backslash. Returns pointer to the character after the escape sequence or NULL if it is invalid.
+ */
+static const uint8_t *dtl_json_validate_escape(const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   const uint8_t *pNext = pBegin + 1;
+   if (pNext >= pEnd)
+   {
+      return (const uint8_t*) 0;
+   }
+   switch(*pNext)
+   {
+   case '"':
+   case '\\':
+   case '/':
+   case 'b':
+   case 'f':
+   case 'n':
+   case 'r':
+   case 't':
+      return pNext + 1;
+   case 'u':
+   {
+      int i;
+      pNext++;
+      if ((pEnd - pNext) < 4)
+      {
+         return (const uint8_t*) 0;
+      }
+      for (i = 0; i < 4; i++)
+      {
+         uint8_t c = pNext[i];
+         if ( !( ( (c >= '0') && (c <= '9') ) || ( (c >= 'a') && (c <= 'f') ) || ( (c >= 'A') && (c <= 'F') ) ) )
+         {
+            return (const uint8_t*) 0;
+         }
+      }
+      return pNext + 4;
+   }
+   default:
+      break;
+   }
+   return (const uint8_t*) 0;
+}
+
+/**
+ * pBegin must point to a non-ASCII byte. Returns pointer to the byte after the UTF-8 sequence or NULL if it is ill-formed.
+ */
+static const uint8_t *dtl_json_validate_utf8_char(const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   uint8_t c = pBegin[0];
+   uint8_t low = 0x80u;
+   uint8_t high = 0xBFu;
+   int32_t len;
+   int32_t i;
+   if ( (c >= 0xC2u) && (c <= 0xDFu) )
+   {
+      len = 2;
+   }
+   else if ( (c >= 0xE0u) && (c <= 0xEFu) )
+   {
+      len = 3;
+      if (c == 0xE0u)
+      {
+         low = 0xA0u; //overlong
+      }
+      else if (c == 0xEDu)
+      {
+         high = 0x9Fu; //surrogates
+      }
+   }
+   else if ( (c >= 0xF0u) && (c <= 0xF4u) )
+   {
+      len = 4;
+      if (c == 0xF0u)
+      {
+         low = 0x90u; //overlong
+      }
+      else if (c == 0xF4u)
+      {
+         high = 0x8Fu; //above U+10FFFF
+      }
+   }
+   else
+   {
+      return (const uint8_t*) 0;
+   }
+   if ((pEnd - pBegin) < len)
+   {
+      return (const uint8_t*) 0;
+   }
+   if ( (pBegin[1] < low) || (pBegin[1] > high) )
+   {
+      return (const uint8_t*) 0;
+   }
+   for (i = 2; i < len; i++)
+   {
+      if ( (pBegin[i] & 0xC0u) != 0x80u )
+      {
+         return (const uint8_t*) 0;
+      }
+   }
+   return pBegin + len;
+}
+
+static void dtl_json_validate_set_error_info(dtl_json_error_info_t *errInfo, dtl_json_error_t errorCode, const uint8_t *pBegin,
+                                             const uint8_t *pError, uint32_t lineNumber)
+{
+   if (errInfo != 0)
+   {
+      const uint8_t *pLineBegin = pError;
+      while ( (pLineBegin > pBegin) && (pLineBegin[-1] != '\n') )
+      {
+         pLineBegin--;
+      }
+      errInfo->errorCode = errorCode;
+      errInfo->offset = (size_t) (pError - pBegin);
+      errInfo->lineNumber = lineNumber;
+      errInfo->column = (uint32_t) (pError - pLineBegin) + 1u;
+   }
+}
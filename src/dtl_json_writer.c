@@ -30,6 +30,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include "dtl_json.h"
+#include "dtl_json_number.h"
 #include "adt_bytearray.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
@@ -280,6 +281,9 @@ static dtl_error_t dtl_json_writer_write_sv(dtl_json_writer_t *self, const dtl_s
       const char *str;
       int32_t i32;
       uint32_t u32;
+      int64_t i64;
+      uint64_t u64;
+      double dbl;
    } val;
    if (indentEnable)
    {
@@ -311,6 +315,45 @@ static dtl_error_t dtl_json_writer_write_sv(dtl_json_writer_t *self, const dtl_s
          adt_str_append_cstr(self->destStr, buf);
       }
       break;
+   case DTL_SV_I64:
+      val.i64 = dtl_sv_to_i64(sv, NULL);
+      if (self->destFile != 0)
+      {
+         fprintf(self->destFile, "%lld", (long long) val.i64);
+      }
+      else
+      {
+         sprintf(buf, "%lld", (long long) val.i64);
+         adt_str_append_cstr(self->destStr, buf);
+      }
+      break;
+   case DTL_SV_U64:
+      val.u64 = dtl_sv_to_u64(sv, NULL);
+      if (self->destFile != 0)
+      {
+         fprintf(self->destFile, "%llu", (unsigned long long) val.u64);
+      }
+      else
+      {
+         sprintf(buf, "%llu", (unsigned long long) val.u64);
+         adt_str_append_cstr(self->destStr, buf);
+      }
+      break;
+   case DTL_SV_DBL:
+      val.dbl = dtl_sv_to_dbl(sv, NULL);
+      if (dtl_json_number_format_double(val.dbl, buf, (uint32_t) sizeof(buf)) < 0)
+      {
+         strcpy(buf, "null"); //inf and NaN cannot be represented in JSON
+      }
+      if (self->destFile != 0)
+      {
+         fprintf(self->destFile, "%s", buf);
+      }
+      else
+      {
+         adt_str_append_cstr(self->destStr, buf);
+      }
+      break;
    case DTL_SV_BOOL:
       val.str = dtl_sv_to_bool(sv, NULL)? "true" : "false";
       if (self->destFile != 0)
@@ -8,6 +8,16 @@
 
 CuSuite* testsuite_dtl_json_writer(void);
 CuSuite* testsuite_dtl_json_reader(void);
+CuSuite* testsuite_dtl_json_cursor(void);
+CuSuite* testsuite_dtl_json_scan(void);
+CuSuite* testsuite_dtl_json_intern(void);
+CuSuite* testsuite_dtl_json_number(void);
+CuSuite* testsuite_dtl_json_index(void);
+CuSuite* testsuite_dtl_json_lazy(void);
+CuSuite* testsuite_dtl_json_pointer(void);
+CuSuite* testsuite_dtl_json_validate(void);
+CuSuite* testsuite_dtl_json_update(void);
+CuSuite* testsuite_dtl_json_schema(void);
 
 void RunAllTests(void)
 {
@@ -16,6 +26,16 @@ void RunAllTests(void)
 
    CuSuiteAddSuite(suite, testsuite_dtl_json_writer());
    CuSuiteAddSuite(suite, testsuite_dtl_json_reader());
+   CuSuiteAddSuite(suite, testsuite_dtl_json_cursor());
+   CuSuiteAddSuite(suite, testsuite_dtl_json_scan());
+   CuSuiteAddSuite(suite, testsuite_dtl_json_intern());
+   CuSuiteAddSuite(suite, testsuite_dtl_json_number());
+   CuSuiteAddSuite(suite, testsuite_dtl_json_index());
+   CuSuiteAddSuite(suite, testsuite_dtl_json_lazy());
+   CuSuiteAddSuite(suite, testsuite_dtl_json_pointer());
+   CuSuiteAddSuite(suite, testsuite_dtl_json_validate());
+   CuSuiteAddSuite(suite, testsuite_dtl_json_update());
+   CuSuiteAddSuite(suite, testsuite_dtl_json_schema());
 
    CuSuiteRun(suite);
    CuSuiteSummary(suite, output);
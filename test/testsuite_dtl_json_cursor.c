@@ -0,0 +1,301 @@
+/*****************************************************************************
+* \file      testsuite_dtl_json_cursor.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Unit tests for dtl_json_cursor
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+#include "dtl_json.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_json_cursor_scalar(CuTest* tc);
+static void test_json_cursor_array(CuTest* tc);
+static void test_json_cursor_object(CuTest* tc);
+static void test_json_cursor_escaped_string(CuTest* tc);
+static void test_json_cursor_integer_range(CuTest* tc);
+static void test_json_cursor_skip(CuTest* tc);
+static void test_json_cursor_errors(CuTest* tc);
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_dtl_json_cursor(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_json_cursor_scalar);
+   SUITE_ADD_TEST(suite, test_json_cursor_array);
+   SUITE_ADD_TEST(suite, test_json_cursor_object);
+   SUITE_ADD_TEST(suite, test_json_cursor_escaped_string);
+   SUITE_ADD_TEST(suite, test_json_cursor_integer_range);
+   SUITE_ADD_TEST(suite, test_json_cursor_skip);
+   SUITE_ADD_TEST(suite, test_json_cursor_errors);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_cursor_scalar(CuTest* tc)
+{
+   const char *json = " 1234 ";
+   dtl_json_cursor_t cursor;
+   int64_t value = 0;
+   bool b = false;
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_type(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_i64(&cursor, &value));
+   CuAssertTrue(tc, value == 1234);
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_cursor_get_bool(&cursor, &b));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END, dtl_json_cursor_next(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+
+   json = "true";
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_TRUE, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_bool(&cursor, &b));
+   CuAssertTrue(tc, b);
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_cursor_get_i64(&cursor, &value));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END, dtl_json_cursor_next(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+}
+
+static void test_json_cursor_array(CuTest* tc)
+{
+   const char *json = "[1, \"two\", false, null, [], -5]";
+   dtl_json_cursor_t cursor;
+   const char *str = 0;
+   uint32_t len = 0u;
+   int64_t value = 0;
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_ARRAY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, 1, dtl_json_cursor_depth(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_STRING, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_string_slice(&cursor, &str, &len));
+   CuAssertUIntEquals(tc, 3u, len);
+   CuAssertTrue(tc, memcmp(str, "two", 3) == 0);
+   CuAssertTrue(tc, str == json + 5); //zero-copy
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_FALSE, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NULL, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_ARRAY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, 2, dtl_json_cursor_depth(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END_ARRAY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, 1, dtl_json_cursor_depth(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_i64(&cursor, &value));
+   CuAssertTrue(tc, value == -5);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END_ARRAY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, 0, dtl_json_cursor_depth(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END, dtl_json_cursor_next(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+}
+
+static void test_json_cursor_object(CuTest* tc)
+{
+   const char *json = "{\n  \"name\": \"Alice\",\n  \"age\": 30,\n  \"tags\": {}\n}\n";
+   dtl_json_cursor_t cursor;
+   const char *str = 0;
+   uint32_t len = 0u;
+   uint64_t value = 0u;
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_OBJECT, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_KEY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_string_slice(&cursor, &str, &len));
+   CuAssertUIntEquals(tc, 4u, len);
+   CuAssertTrue(tc, memcmp(str, "name", 4) == 0);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_STRING, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_string_slice(&cursor, &str, &len));
+   CuAssertUIntEquals(tc, 5u, len);
+   CuAssertTrue(tc, memcmp(str, "Alice", 5) == 0);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_KEY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_u64(&cursor, &value));
+   CuAssertTrue(tc, value == 30u);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_KEY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_OBJECT, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END_OBJECT, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END_OBJECT, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END, dtl_json_cursor_next(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+}
+
+static void test_json_cursor_escaped_string(CuTest* tc)
+{
+   const char *json = "[\"a\\\"b\\nc\", \"x\\u0000y\", \"caf\\u00e9\"]";
+   dtl_json_cursor_t cursor;
+   const char *str = 0;
+   uint32_t len = 0u;
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_ARRAY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_STRING, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_string_slice(&cursor, &str, &len));
+   CuAssertUIntEquals(tc, 5u, len);
+   CuAssertTrue(tc, memcmp(str, "a\"b\nc", 5) == 0);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_STRING, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_string_slice(&cursor, &str, &len));
+   CuAssertUIntEquals(tc, 3u, len);
+   CuAssertTrue(tc, memcmp(str, "x\0y", 3) == 0);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_STRING, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_string_slice(&cursor, &str, &len));
+   CuAssertUIntEquals(tc, 5u, len);
+   CuAssertTrue(tc, memcmp(str, "caf\303\251", 5) == 0);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END_ARRAY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END, dtl_json_cursor_next(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+}
+
+static void test_json_cursor_integer_range(CuTest* tc)
+{
+   const char *json = "[-9223372036854775808, 9223372036854775807, 18446744073709551615, 18446744073709551616, 1.5, -1]";
+   dtl_json_cursor_t cursor;
+   int64_t i64 = 0;
+   uint64_t u64 = 0u;
+   double dbl = 0.0;
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_ARRAY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_i64(&cursor, &i64));
+   CuAssertTrue(tc, i64 == INT64_MIN);
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_cursor_get_u64(&cursor, &u64));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_i64(&cursor, &i64));
+   CuAssertTrue(tc, i64 == INT64_MAX);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_cursor_get_i64(&cursor, &i64));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_u64(&cursor, &u64));
+   CuAssertTrue(tc, u64 == UINT64_MAX);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_cursor_get_u64(&cursor, &u64));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_cursor_get_i64(&cursor, &i64));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_double(&cursor, &dbl));
+   CuAssertTrue(tc, dbl == 1.5);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_i64(&cursor, &i64));
+   CuAssertTrue(tc, i64 == -1);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_double(&cursor, &dbl));
+   CuAssertTrue(tc, dbl == -1.0);
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_cursor_get_u64(&cursor, &u64));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END_ARRAY, dtl_json_cursor_next(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+}
+
+static void test_json_cursor_skip(CuTest* tc)
+{
+   const char *json = "{\"skipped\": {\"a\": [1, 2, {\"b\": \"}]\"}]}, \"kept\": 7, \"scalar\": 1}";
+   dtl_json_cursor_t cursor;
+   const char *str = 0;
+   uint32_t len = 0u;
+   int64_t value = 0;
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_OBJECT, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_KEY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_skip(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END_OBJECT, dtl_json_cursor_type(&cursor));
+   CuAssertIntEquals(tc, 1, dtl_json_cursor_depth(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_KEY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_string_slice(&cursor, &str, &len));
+   CuAssertUIntEquals(tc, 4u, len);
+   CuAssertTrue(tc, memcmp(str, "kept", 4) == 0);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_get_i64(&cursor, &value));
+   CuAssertTrue(tc, value == 7);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_KEY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_cursor_skip(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_type(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END_OBJECT, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_END, dtl_json_cursor_next(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+}
+
+static void test_json_cursor_errors(CuTest* tc)
+{
+   dtl_json_cursor_t cursor;
+   char deepJson[DTL_JSON_CURSOR_MAX_DEPTH + 1];
+   const char *json = "[1 2]";
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_ARRAY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_cursor_get_i64(&cursor, (int64_t*) 0));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_ERROR, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, dtl_json_cursor_last_error(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_ERROR, dtl_json_cursor_next(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+
+   json = "{\"a\": [1}";
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_OBJECT, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_KEY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_ARRAY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_ERROR, dtl_json_cursor_next(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+
+   json = "[1, 2";
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_ARRAY, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_ERROR, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_EOB_ERROR, dtl_json_cursor_last_error(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+
+   json = "1 2";
+   dtl_json_cursor_create(&cursor, (const uint8_t*) json, (const uint8_t*) json + strlen(json));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NUMBER, dtl_json_cursor_next(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_ERROR, dtl_json_cursor_next(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+
+   memset(deepJson, '[', sizeof(deepJson));
+   dtl_json_cursor_create(&cursor, (const uint8_t*) deepJson, (const uint8_t*) deepJson + sizeof(deepJson));
+   while (dtl_json_cursor_next(&cursor) == DTL_JSON_TOKEN_BEGIN_ARRAY) {}
+   CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_cursor_last_error(&cursor));
+   CuAssertIntEquals(tc, DTL_JSON_CURSOR_MAX_DEPTH, dtl_json_cursor_depth(&cursor));
+   dtl_json_cursor_destroy(&cursor);
+}
@@ -0,0 +1,457 @@
+/*****************************************************************************
+* \file      testsuite_dtl_json_index.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Unit tests for dtl_json_index and the structural index engine
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "dtl_json.h"
+#include "dtl_json_index.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define RANDOM_BUF_SIZE 4096
+#define RANDOM_MAX_DEPTH 4
+
+typedef struct randomDoc_tag
+{
+   char buf[RANDOM_BUF_SIZE];
+   size_t len;
+} randomDoc_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_index_positions(CuTest* tc);
+static void test_json_index_escapes(CuTest* tc);
+static void test_json_index_random_bytes(CuTest* tc);
+static void test_json_index_engine_select(CuTest* tc);
+static void test_json_index_engine_invalid(CuTest* tc);
+static void test_json_index_engine_differential(CuTest* tc);
+static void test_json_index_engine_line_number(CuTest* tc);
+static void check_against_reference(CuTest* tc, const uint8_t *pBegin, const uint8_t *pEnd);
+static dtl_json_error_t build_reference(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *positions, uint32_t *count);
+static void check_engines_agree(CuTest* tc, const uint8_t *pBegin, const uint8_t *pEnd);
+static adt_str_t *load_with(dtl_json_engine_t engine, const uint8_t *pBegin, const uint8_t *pEnd);
+static void random_doc_append(randomDoc_t *doc, const char *str);
+static void random_doc_whitespace(randomDoc_t *doc);
+static void random_doc_value(randomDoc_t *doc, int32_t depth);
+static void random_doc_string(randomDoc_t *doc);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static const char m_alphabet[] = "{}[]:,\" \n\\a1-e.tx";
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_dtl_json_index(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_json_index_positions);
+   SUITE_ADD_TEST(suite, test_json_index_escapes);
+   SUITE_ADD_TEST(suite, test_json_index_random_bytes);
+   SUITE_ADD_TEST(suite, test_json_index_engine_select);
+   SUITE_ADD_TEST(suite, test_json_index_engine_invalid);
+   SUITE_ADD_TEST(suite, test_json_index_engine_differential);
+   SUITE_ADD_TEST(suite, test_json_index_engine_line_number);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_index_positions(CuTest* tc)
+{
+   const char *json = "{\"a\": [12, true, \"x\\\"y\"], \"b\" :null}";
+   const uint32_t expected[] = {0, 1, 3, 4, 6, 7, 9, 11, 15, 17, 22, 23, 24, 26, 28, 30, 31, 35};
+   dtl_json_index_t index;
+   uint32_t i;
+   dtl_json_index_create(&index);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_index_build(&index, (const uint8_t*) json, (const uint8_t*) json + strlen(json)));
+   CuAssertUIntEquals(tc, sizeof(expected) / sizeof(expected[0]), index.count);
+   for (i = 0; i < index.count; i++)
+   {
+      CuAssertUIntEquals(tc, expected[i], index.positions[i]);
+   }
+   json = "[\"unterminated]";
+   CuAssertIntEquals(tc, DTL_JSON_UNMATCHED_STRING_LITERAL, dtl_json_index_build(&index, (const uint8_t*) json, (const uint8_t*) json + strlen(json)));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_index_build(&index, (const uint8_t*) json, (const uint8_t*) json));
+   CuAssertUIntEquals(tc, 0u, index.count);
+   dtl_json_index_destroy(&index);
+}
+
+/**
+ * Backslash runs of every length ending at and crossing the 64-byte block boundary.
+ */
+static void test_json_index_escapes(CuTest* tc)
+{
+   uint8_t buf[3 * DTL_JSON_INDEX_BLOCK_SIZE];
+   uint32_t runLength;
+   uint32_t runEnd;
+   for (runLength = 1u; runLength <= 8u; runLength++)
+   {
+      for (runEnd = DTL_JSON_INDEX_BLOCK_SIZE - 4u; runEnd <= DTL_JSON_INDEX_BLOCK_SIZE + 4u; runEnd++)
+      {
+         uint32_t len = runEnd + 8u;
+         memset(buf, 'a', sizeof(buf));
+         buf[0] = '[';
+         buf[1] = '"';
+         memset(&buf[runEnd - runLength], '\\', runLength);
+         buf[runEnd] = '"';
+         buf[runEnd + 3u] = '"';
+         buf[runEnd + 6u] = ',';
+         buf[runEnd + 7u] = ']';
+         check_against_reference(tc, buf, buf + len);
+      }
+   }
+}
+
+static void test_json_index_random_bytes(CuTest* tc)
+{
+   uint8_t buf[5 * DTL_JSON_INDEX_BLOCK_SIZE];
+   int32_t iteration;
+   for (iteration = 0; iteration < 2000; iteration++)
+   {
+      size_t len = (size_t) rand() % sizeof(buf);
+      size_t i;
+      for (i = 0; i < len; i++)
+      {
+         //favour backslashes and quotes
+         int r = rand() % 8;
+         buf[i] = (r == 0)? '\\' : (r == 1)? '"' : (uint8_t) m_alphabet[rand() % (sizeof(m_alphabet) - 1)];
+      }
+      check_against_reference(tc, buf, buf + len);
+   }
+}
+
+static void test_json_index_engine_select(CuTest* tc)
+{
+   dtl_dv_t *result;
+   dtl_json_reader_t *reader = dtl_json_reader_new();
+   dtl_json_reader_t *other = dtl_json_reader_new();
+   CuAssertPtrNotNull(tc, reader);
+   CuAssertPtrNotNull(tc, other);
+   CuAssertIntEquals(tc, DTL_JSON_ENGINE_STATE_MACHINE, dtl_json_reader_get_engine(reader));
+   dtl_json_reader_set_engine(reader, DTL_JSON_ENGINE_STRUCTURAL_INDEX);
+   CuAssertIntEquals(tc, DTL_JSON_ENGINE_STRUCTURAL_INDEX, dtl_json_reader_get_engine(reader));
+   CuAssertIntEquals(tc, DTL_JSON_ENGINE_STATE_MACHINE, dtl_json_reader_get_engine(other));
+   dtl_json_reader_set_engine(reader, (dtl_json_engine_t) 99);
+   CuAssertIntEquals(tc, DTL_JSON_ENGINE_STRUCTURAL_INDEX, dtl_json_reader_get_engine(reader));
+   result = dtl_json_reader_load_cstr(reader, " {\"name\": \"Alice\", \"list\": [1, -2.5, [], {}, false, null]} ");
+   CuAssertPtrNotNull(tc, result);
+   CuAssertIntEquals(tc, DTL_DV_HASH, dtl_dv_type(result));
+   dtl_dv_dec_ref(result);
+   dtl_json_reader_set_engine(reader, DTL_JSON_ENGINE_STATE_MACHINE);
+   CuAssertIntEquals(tc, DTL_JSON_ENGINE_STATE_MACHINE, dtl_json_reader_get_engine(reader));
+   dtl_json_reader_delete(other);
+   dtl_json_reader_delete(reader);
+}
+
+static void test_json_index_engine_invalid(CuTest* tc)
+{
+   const char *invalid[] = {"", " ", "[1,]", "[1 2]", "1 2", "{\"\": 1}", "{\"a\" 1}", "{\"a\": 1,}", "{1: 2}",
+                            "tru", "truex", "nul", "[01]", "-", "1.", "\"abc", "[1}", "{\"a\": [1}", "]", "[", "{"};
+   size_t i;
+   dtl_json_reader_t *reader = dtl_json_reader_new();
+   CuAssertPtrNotNull(tc, reader);
+   dtl_json_reader_set_engine(reader, DTL_JSON_ENGINE_STRUCTURAL_INDEX);
+   for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+   {
+      dtl_dv_t *result = dtl_json_reader_load_cstr(reader, invalid[i]);
+      if (result != 0)
+      {
+         dtl_dv_dec_ref(result);
+         CuFail(tc, invalid[i]);
+      }
+      check_engines_agree(tc, (const uint8_t*) invalid[i], (const uint8_t*) invalid[i] + strlen(invalid[i]));
+   }
+   dtl_json_reader_delete(reader);
+}
+
+/**
+ * Random documents, plus truncated and corrupted copies, must give identical results with both engines.
+ */
+static void test_json_index_engine_differential(CuTest* tc)
+{
+   randomDoc_t doc;
+   uint8_t mutated[RANDOM_BUF_SIZE];
+   int32_t iteration;
+   for (iteration = 0; iteration < 500; iteration++)
+   {
+      adt_str_t *output;
+      doc.len = 0u;
+      random_doc_whitespace(&doc);
+      random_doc_value(&doc, 0);
+      random_doc_whitespace(&doc);
+      output = load_with(DTL_JSON_ENGINE_STRUCTURAL_INDEX, (const uint8_t*) doc.buf, (const uint8_t*) doc.buf + doc.len);
+      CuAssertPtrNotNull(tc, output);
+      adt_str_delete(output);
+      check_engines_agree(tc, (const uint8_t*) doc.buf, (const uint8_t*) doc.buf + doc.len);
+      if (doc.len > 0u)
+      {
+         size_t pos = (size_t) rand() % doc.len;
+         check_engines_agree(tc, (const uint8_t*) doc.buf, (const uint8_t*) doc.buf + pos);
+         memcpy(mutated, doc.buf, doc.len);
+         mutated[pos] = (uint8_t) m_alphabet[rand() % (sizeof(m_alphabet) - 1)];
+         check_engines_agree(tc, mutated, mutated + doc.len);
+      }
+   }
+}
+
+/**
+ * After an error, both engines report the line of the token where it was found.
+ */
+static void test_json_index_engine_line_number(CuTest* tc)
+{
+   const char *documents[5] = {"{\n  \"a\": 1,\n  \"b\": [2,\n  3 4]\n}", "[\n1,\n\n\"abc", "[\n1,\n\n", "[1,\n \"a\",\n x]", "[\n\"a\" \"b\n"};
+   const dtl_json_error_t expectedError[5] = {DTL_JSON_UNEXPECTED_CHAR_ERROR, DTL_JSON_UNMATCHED_STRING_LITERAL, DTL_JSON_UNEXPECTED_EOB_ERROR, DTL_JSON_UNEXPECTED_CHAR_ERROR, DTL_JSON_UNEXPECTED_CHAR_ERROR};
+   const uint32_t expectedLine[5] = {4u, 4u, 4u, 3u, 2u};
+   dtl_json_reader_t *reader = dtl_json_reader_new();
+   int32_t engine;
+   CuAssertPtrNotNull(tc, reader);
+   for (engine = 0; engine < 2; engine++)
+   {
+      int32_t i;
+      dtl_json_reader_set_engine(reader, (engine == 0)? DTL_JSON_ENGINE_STATE_MACHINE : DTL_JSON_ENGINE_STRUCTURAL_INDEX);
+      for (i = 0; i < 5; i++)
+      {
+         CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, documents[i]));
+         CuAssertIntEquals(tc, expectedError[i], dtl_json_reader_last_error(reader));
+         CuAssertUIntEquals(tc, expectedLine[i], dtl_json_reader_line_number(reader));
+      }
+   }
+   dtl_json_reader_delete(reader);
+}
+
+static void check_against_reference(CuTest* tc, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   static uint32_t expected[5 * DTL_JSON_INDEX_BLOCK_SIZE];
+   uint32_t expectedCount = 0u;
+   dtl_json_error_t expectedResult;
+   dtl_json_simd_t simdLevel;
+   dtl_json_index_t index;
+   CuAssertTrue(tc, (size_t) (pEnd - pBegin) <= sizeof(expected) / sizeof(expected[0]));
+   expectedResult = build_reference(pBegin, pEnd, expected, &expectedCount);
+   dtl_json_index_create(&index);
+   for (simdLevel = DTL_JSON_SIMD_NONE; simdLevel <= dtl_json_scan_simd_level(); simdLevel++)
+   {
+      CuAssertIntEquals(tc, expectedResult, dtl_json_index_build_with(&index, pBegin, pEnd, simdLevel));
+      if (expectedResult == DTL_JSON_NO_ERROR)
+      {
+         uint32_t i;
+         CuAssertUIntEquals(tc, expectedCount, index.count);
+         for (i = 0; i < expectedCount; i++)
+         {
+            CuAssertUIntEquals(tc, expected[i], index.positions[i]);
+         }
+      }
+   }
+   dtl_json_index_destroy(&index);
+}
+
+/**
+ * Byte-at-a-time version of dtl_json_index_build.
+ */
+static dtl_json_error_t build_reference(const uint8_t *pBegin, const uint8_t *pEnd, uint32_t *positions, uint32_t *count)
+{
+   const uint8_t *pNext;
+   bool isInString = false;
+   bool isEscapeNext = false;
+   bool isPrevScalar = false;
+   *count = 0u;
+   for (pNext = pBegin; pNext < pEnd; pNext++)
+   {
+      uint8_t c = *pNext;
+      bool isEscaped = isEscapeNext;
+      uint32_t position = (uint32_t) (pNext - pBegin);
+      isEscapeNext = ( (c == '\\') && (!isEscaped) );
+      if ( (c == '"') && (!isEscaped) )
+      {
+         positions[(*count)++] = position;
+         isInString = !isInString;
+         isPrevScalar = false;
+      }
+      else if (isInString)
+      {
+         isPrevScalar = false;
+      }
+      else if (strchr("{}[]:,", c) != 0)
+      {
+         positions[(*count)++] = position;
+         isPrevScalar = false;
+      }
+      else if ( (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') )
+      {
+         isPrevScalar = false;
+      }
+      else
+      {
+         if (!isPrevScalar)
+         {
+            positions[(*count)++] = position;
+         }
+         isPrevScalar = true;
+      }
+   }
+   return isInString? DTL_JSON_UNMATCHED_STRING_LITERAL : DTL_JSON_NO_ERROR;
+}
+
+static void check_engines_agree(CuTest* tc, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   adt_str_t *expected = load_with(DTL_JSON_ENGINE_STATE_MACHINE, pBegin, pEnd);
+   adt_str_t *actual = load_with(DTL_JSON_ENGINE_STRUCTURAL_INDEX, pBegin, pEnd);
+   if (expected == 0)
+   {
+      CuAssertPtrEquals(tc, 0, actual);
+   }
+   else
+   {
+      CuAssertPtrNotNull(tc, actual);
+      CuAssertStrEquals(tc, adt_str_cstr(expected), adt_str_cstr(actual));
+      adt_str_delete(expected);
+      adt_str_delete(actual);
+   }
+}
+
+static adt_str_t *load_with(dtl_json_engine_t engine, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   adt_str_t *retval = (adt_str_t*) 0;
+   dtl_dv_t *result;
+   dtl_json_reader_t *reader = dtl_json_reader_new();
+   if (reader == 0)
+   {
+      return retval;
+   }
+   dtl_json_reader_set_engine(reader, engine);
+   result = dtl_json_reader_load_bstr(reader, pBegin, pEnd);
+   dtl_json_reader_delete(reader);
+   if (result != 0)
+   {
+      retval = dtl_json_dumps(result, 0, true);
+      dtl_dv_dec_ref(result);
+   }
+   return retval;
+}
+
+static void random_doc_append(randomDoc_t *doc, const char *str)
+{
+   size_t len = strlen(str);
+   if (doc->len + len < sizeof(doc->buf))
+   {
+      memcpy(&doc->buf[doc->len], str, len);
+      doc->len += len;
+   }
+}
+
+static void random_doc_whitespace(randomDoc_t *doc)
+{
+   static const char *whitespace[] = {"", "", " ", "\n", "\r\n  ", "\t"};
+   random_doc_append(doc, whitespace[rand() % 6]);
+}
+
+static void random_doc_value(randomDoc_t *doc, int32_t depth)
+{
+   static const char *scalars[] = {"0", "-1", "42", "2147483648", "-9223372036854775808", "18446744073709551615",
+                                   "1.5", "-0.25e-3", "6.02E23", "true", "false", "null"};
+   int32_t kind = (depth < RANDOM_MAX_DEPTH)? (rand() % 4) : (rand() % 2);
+   int32_t numElements;
+   int32_t i;
+   switch(kind)
+   {
+   case 0:
+      random_doc_append(doc, scalars[rand() % 12]);
+      break;
+   case 1:
+      random_doc_string(doc);
+      break;
+   case 2:
+      numElements = rand() % 5;
+      random_doc_append(doc, "[");
+      for (i = 0; i < numElements; i++)
+      {
+         random_doc_whitespace(doc);
+         random_doc_value(doc, depth + 1);
+         random_doc_whitespace(doc);
+         if (i + 1 < numElements)
+         {
+            random_doc_append(doc, ",");
+         }
+      }
+      random_doc_whitespace(doc);
+      random_doc_append(doc, "]");
+      break;
+   default:
+      numElements = rand() % 5;
+      random_doc_append(doc, "{");
+      for (i = 0; i < numElements; i++)
+      {
+         char key[16];
+         random_doc_whitespace(doc);
+         sprintf(key, "\"k%d\"", rand() % 8);
+         random_doc_append(doc, key);
+         random_doc_whitespace(doc);
+         random_doc_append(doc, ":");
+         random_doc_whitespace(doc);
+         random_doc_value(doc, depth + 1);
+         random_doc_whitespace(doc);
+         if (i + 1 < numElements)
+         {
+            random_doc_append(doc, ",");
+         }
+      }
+      random_doc_whitespace(doc);
+      random_doc_append(doc, "}");
+      break;
+   }
+}
+
+/**
+ * Strings of up to 80 characters so that they regularly cross block boundaries, with escapes that contain quotes and backslashes.
+ */
+static void random_doc_string(randomDoc_t *doc)
+{
+   static const char *parts[] = {"a", "bc", " ", ",", ":", "{", "]", "\\\"", "\\\\", "\\n", "\\u00e9", "\\\\\\\""};
+   int32_t numParts = rand() % 40;
+   int32_t i;
+   random_doc_append(doc, "\"");
+   for (i = 0; i < numParts; i++)
+   {
+      random_doc_append(doc, parts[rand() % 12]);
+   }
+   random_doc_append(doc, "\"");
+}
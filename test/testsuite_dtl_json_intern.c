@@ -0,0 +1,240 @@
+/*****************************************************************************
+* \file      testsuite_dtl_json_intern.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Unit tests for dtl_json_intern
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+#include "dtl_json.h"
+#include "dtl_json_intern.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+typedef struct key_log_tag
+{
+   const char *keys[8];
+   uint32_t numKeys;
+} key_log_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_json_intern_same_string(CuTest* tc);
+static void test_json_intern_many_strings(CuTest* tc);
+static void test_json_intern_max_count(CuTest* tc);
+static void test_json_intern_clear(CuTest* tc);
+static void test_json_intern_long_strings(CuTest* tc);
+static void test_json_reader_shared_key_pool(CuTest* tc);
+static void key_log_on_key(void *arg, const char *pKey, uint32_t keyLen);
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_dtl_json_intern(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_json_intern_same_string);
+   SUITE_ADD_TEST(suite, test_json_intern_many_strings);
+   SUITE_ADD_TEST(suite, test_json_intern_max_count);
+   SUITE_ADD_TEST(suite, test_json_intern_clear);
+   SUITE_ADD_TEST(suite, test_json_intern_long_strings);
+   SUITE_ADD_TEST(suite, test_json_reader_shared_key_pool);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_intern_same_string(CuTest* tc)
+{
+   dtl_json_intern_t intern;
+   const char *text = "Name: Name";
+   const char *s1;
+   const char *s2;
+   const char *s3;
+   dtl_json_intern_create(&intern, 0u);
+   s1 = dtl_json_intern_bstr(&intern, (const uint8_t*) text, (const uint8_t*) text + 4);
+   s2 = dtl_json_intern_bstr(&intern, (const uint8_t*) text + 6, (const uint8_t*) text + 10);
+   s3 = dtl_json_intern_cstr(&intern, "Nam");
+   CuAssertPtrNotNull(tc, s1);
+   CuAssertTrue(tc, s1 == s2);
+   CuAssertTrue(tc, s1 != s3);
+   CuAssertTrue(tc, s1 != text);
+   CuAssertStrEquals(tc, "Name", s1);
+   CuAssertStrEquals(tc, "Nam", s3);
+   CuAssertUIntEquals(tc, 2u, dtl_json_intern_length(&intern));
+   dtl_json_intern_destroy(&intern);
+}
+
+static void test_json_intern_many_strings(CuTest* tc)
+{
+   dtl_json_intern_t intern;
+   const char *first[1000];
+   char buf[20];
+   int32_t i;
+   dtl_json_intern_create(&intern, 0u);
+   for (i = 0; i < 1000; i++)
+   {
+      sprintf(buf, "key%d", (int) i);
+      first[i] = dtl_json_intern_cstr(&intern, buf);
+      CuAssertPtrNotNull(tc, first[i]);
+   }
+   CuAssertUIntEquals(tc, 1000u, dtl_json_intern_length(&intern));
+   for (i = 0; i < 1000; i++)
+   {
+      sprintf(buf, "key%d", (int) i);
+      CuAssertTrue(tc, dtl_json_intern_cstr(&intern, buf) == first[i]);
+      CuAssertStrEquals(tc, buf, first[i]);
+   }
+   CuAssertUIntEquals(tc, 1000u, dtl_json_intern_length(&intern));
+   dtl_json_intern_destroy(&intern);
+}
+
+static void test_json_intern_max_count(CuTest* tc)
+{
+   dtl_json_intern_t *intern = dtl_json_intern_new(2u);
+   const char *s1;
+   CuAssertPtrNotNull(tc, intern);
+   s1 = dtl_json_intern_cstr(intern, "a");
+   CuAssertPtrNotNull(tc, dtl_json_intern_cstr(intern, "b"));
+   CuAssertTrue(tc, dtl_json_intern_cstr(intern, "c") == 0);
+   CuAssertTrue(tc, dtl_json_intern_cstr(intern, "a") == s1);
+   dtl_json_intern_delete(intern);
+}
+
+static void test_json_intern_clear(CuTest* tc)
+{
+   dtl_json_intern_t intern;
+   dtl_json_intern_create(&intern, 0u);
+   CuAssertPtrNotNull(tc, dtl_json_intern_cstr(&intern, "a"));
+   CuAssertPtrNotNull(tc, dtl_json_intern_cstr(&intern, "b"));
+   dtl_json_intern_clear(&intern);
+   CuAssertUIntEquals(tc, 0u, dtl_json_intern_length(&intern));
+   CuAssertStrEquals(tc, "b", dtl_json_intern_cstr(&intern, "b"));
+   CuAssertUIntEquals(tc, 1u, dtl_json_intern_length(&intern));
+   dtl_json_intern_destroy(&intern);
+}
+
+static void test_json_intern_long_strings(CuTest* tc)
+{
+   dtl_json_intern_t intern;
+   static char longStr[5000];
+   const char *shortStr;
+   int32_t i;
+   memset(longStr, 'x', sizeof(longStr) - 1u);
+   dtl_json_intern_create(&intern, 0u);
+   shortStr = dtl_json_intern_cstr(&intern, "short");
+   for (i = 0; i < 3; i++)
+   {
+      longStr[0] = (char) ('a' + i);
+      CuAssertStrEquals(tc, longStr, dtl_json_intern_cstr(&intern, longStr)); //too long for a shared block
+   }
+   CuAssertTrue(tc, dtl_json_intern_cstr(&intern, "short") == shortStr);
+   for (i = 0; i < 200; i++)
+   {
+      char buf[64];
+      sprintf(buf, "a key long enough to fill several blocks %d", (int) i);
+      CuAssertStrEquals(tc, buf, dtl_json_intern_cstr(&intern, buf));
+   }
+   CuAssertUIntEquals(tc, 204u, dtl_json_intern_length(&intern));
+   dtl_json_intern_clear(&intern);
+   CuAssertStrEquals(tc, longStr, dtl_json_intern_cstr(&intern, longStr));
+   CuAssertStrEquals(tc, "short", dtl_json_intern_cstr(&intern, "short"));
+   CuAssertUIntEquals(tc, 2u, dtl_json_intern_length(&intern));
+   dtl_json_intern_destroy(&intern);
+}
+
+static void test_json_reader_shared_key_pool(CuTest* tc)
+{
+   const char *json = "[{\"Name\": \"a\", \"Value\": 1}, {\"Name\": \"b\", \"Value\": 2}]";
+   const char *pEnd = json + strlen(json);
+   dtl_json_intern_t *pool = dtl_json_intern_new(1u);
+   dtl_json_reader_t *reader = dtl_json_reader_new();
+   dtl_json_handler_t handler;
+   key_log_t log;
+   dtl_dv_t *result;
+   const char *name;
+   int32_t i;
+   CuAssertPtrNotNull(tc, pool);
+   CuAssertPtrNotNull(tc, reader);
+   memset(&handler, 0, sizeof(handler));
+   handler.on_key = key_log_on_key;
+
+   //without a pool keys are slices of the input
+   memset(&log, 0, sizeof(log));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_reader_parse_bstr(reader, (const uint8_t*) json, (const uint8_t*) pEnd, &handler, &log));
+   CuAssertUIntEquals(tc, 4u, log.numKeys);
+   CuAssertPtrEquals(tc, (void*) (json + 3), (void*) log.keys[0]);
+   CuAssertPtrEquals(tc, (void*) (json + 30), (void*) log.keys[2]);
+
+   //DOM loads do not touch the pool
+   dtl_json_reader_set_key_pool(reader, pool);
+   result = dtl_json_reader_load_cstr(reader, json);
+   CuAssertPtrNotNull(tc, result);
+   dtl_dv_dec_ref(result);
+   CuAssertUIntEquals(tc, 0u, dtl_json_intern_length(pool));
+
+   for (i = 0; i < 2; i++)
+   {
+      memset(&log, 0, sizeof(log));
+      CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_reader_parse_bstr(reader, (const uint8_t*) json, (const uint8_t*) pEnd, &handler, &log));
+      CuAssertUIntEquals(tc, 4u, log.numKeys);
+      name = dtl_json_intern_cstr(pool, "Name");
+      CuAssertPtrEquals(tc, (void*) name, (void*) log.keys[0]);
+      CuAssertPtrEquals(tc, (void*) name, (void*) log.keys[2]);
+      //"Value" did not fit in the pool and was passed as a slice
+      CuAssertPtrEquals(tc, (void*) (json + 16), (void*) log.keys[1]);
+   }
+   CuAssertUIntEquals(tc, 1u, dtl_json_intern_length(pool));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_reader_parse_bstr(reader, (const uint8_t*) json, (const uint8_t*) pEnd, (const dtl_json_handler_t*) 0, &log));
+   dtl_json_reader_delete(reader);
+   dtl_json_intern_delete(pool);
+}
+
+static void key_log_on_key(void *arg, const char *pKey, uint32_t keyLen)
+{
+   key_log_t *log = (key_log_t*) arg;
+   (void) keyLen;
+   if (log->numKeys < 8u)
+   {
+      log->keys[log->numKeys++] = pKey;
+   }
+}
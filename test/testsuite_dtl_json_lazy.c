@@ -0,0 +1,282 @@
+/*****************************************************************************
+* \file      testsuite_dtl_json_lazy.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Unit tests for dtl_json_load_lazy
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+#include "dtl_json.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_lazy_object(CuTest* tc);
+static void test_json_lazy_array(CuTest* tc);
+static void test_json_lazy_escaped_strings(CuTest* tc);
+static void test_json_lazy_value(CuTest* tc);
+static void test_json_lazy_invalid(CuTest* tc);
+static void test_json_lazy_invalid_scalars(CuTest* tc);
+static dtl_json_lazy_t *load_lazy_cstr(const char *json);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_dtl_json_lazy(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_json_lazy_object);
+   SUITE_ADD_TEST(suite, test_json_lazy_array);
+   SUITE_ADD_TEST(suite, test_json_lazy_escaped_strings);
+   SUITE_ADD_TEST(suite, test_json_lazy_value);
+   SUITE_ADD_TEST(suite, test_json_lazy_invalid);
+   SUITE_ADD_TEST(suite, test_json_lazy_invalid_scalars);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_lazy_object(CuTest* tc)
+{
+   dtl_json_lazy_t *doc = load_lazy_cstr("{\"skipped\": {\"a\": [1, {\"b\": \"}]\"}]}, \"name\": \"Alice\", \"age\": 30,"
+                                         " \"ratio\": 0.5, \"admin\": false, \"manager\": null}");
+   dtl_json_lazy_node_t root;
+   dtl_json_lazy_node_t node;
+   const char *str = 0;
+   uint32_t len = 0u;
+   int64_t i64 = 0;
+   double dbl = 0.0;
+   bool b = true;
+   CuAssertPtrNotNull(tc, doc);
+   root = dtl_json_lazy_root(doc);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_OBJECT, dtl_json_lazy_type(doc, root));
+   CuAssertIntEquals(tc, 6, dtl_json_lazy_length(doc, root));
+   node = dtl_json_lazy_get(doc, root, "name");
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_STRING, dtl_json_lazy_type(doc, node));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_string_slice(doc, node, &str, &len));
+   CuAssertUIntEquals(tc, 5u, len);
+   CuAssertTrue(tc, memcmp(str, "Alice", 5) == 0);
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_lazy_get_i64(doc, node, &i64));
+   node = dtl_json_lazy_get(doc, root, "age");
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_i64(doc, node, &i64));
+   CuAssertTrue(tc, i64 == 30);
+   node = dtl_json_lazy_get(doc, root, "ratio");
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_lazy_get_i64(doc, node, &i64));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_double(doc, node, &dbl));
+   CuAssertTrue(tc, dbl == 0.5);
+   node = dtl_json_lazy_get(doc, root, "admin");
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_FALSE, dtl_json_lazy_type(doc, node));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_bool(doc, node, &b));
+   CuAssertTrue(tc, !b);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_NULL, dtl_json_lazy_type(doc, dtl_json_lazy_get(doc, root, "manager")));
+   CuAssertUIntEquals(tc, DTL_JSON_LAZY_NONE, dtl_json_lazy_get(doc, root, "missing"));
+   CuAssertUIntEquals(tc, DTL_JSON_LAZY_NONE, dtl_json_lazy_get(doc, root, "a")); //nested keys are not visible from root
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_ERROR, dtl_json_lazy_type(doc, DTL_JSON_LAZY_NONE));
+   node = dtl_json_lazy_get(doc, dtl_json_lazy_at(doc, dtl_json_lazy_get(doc, dtl_json_lazy_get(doc, root, "skipped"), "a"), 1u), "b");
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_string_slice(doc, node, &str, &len));
+   CuAssertUIntEquals(tc, 2u, len);
+   CuAssertTrue(tc, memcmp(str, "}]", 2) == 0);
+   dtl_json_lazy_delete(doc);
+}
+
+static void test_json_lazy_array(CuTest* tc)
+{
+   dtl_json_lazy_t *doc = load_lazy_cstr(" [10, [], {}, [20, 30], \"x\", -9223372036854775808, 18446744073709551615] ");
+   const int64_t expected[] = {10, 20, 30};
+   dtl_json_lazy_node_t root;
+   dtl_json_lazy_node_t node;
+   int64_t i64 = 0;
+   uint64_t u64 = 0u;
+   CuAssertPtrNotNull(tc, doc);
+   root = dtl_json_lazy_root(doc);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_BEGIN_ARRAY, dtl_json_lazy_type(doc, root));
+   CuAssertIntEquals(tc, 7, dtl_json_lazy_length(doc, root));
+   CuAssertIntEquals(tc, 0, dtl_json_lazy_length(doc, dtl_json_lazy_at(doc, root, 1u)));
+   CuAssertIntEquals(tc, 0, dtl_json_lazy_length(doc, dtl_json_lazy_at(doc, root, 2u)));
+   CuAssertUIntEquals(tc, DTL_JSON_LAZY_NONE, dtl_json_lazy_first(doc, dtl_json_lazy_at(doc, root, 1u)));
+   CuAssertIntEquals(tc, -1, dtl_json_lazy_length(doc, dtl_json_lazy_at(doc, root, 0u)));
+   CuAssertUIntEquals(tc, DTL_JSON_LAZY_NONE, dtl_json_lazy_at(doc, root, 7u));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_i64(doc, dtl_json_lazy_at(doc, root, 5u), &i64));
+   CuAssertTrue(tc, i64 == INT64_MIN);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_u64(doc, dtl_json_lazy_at(doc, root, 6u), &u64));
+   CuAssertTrue(tc, u64 == UINT64_MAX);
+   //iterate over [10] and [20, 30]
+   node = dtl_json_lazy_first(doc, root);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_i64(doc, node, &i64));
+   CuAssertTrue(tc, i64 == expected[0]);
+   node = dtl_json_lazy_first(doc, dtl_json_lazy_at(doc, root, 3u));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_i64(doc, node, &i64));
+   CuAssertTrue(tc, i64 == expected[1]);
+   node = dtl_json_lazy_next(doc, node);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_i64(doc, node, &i64));
+   CuAssertTrue(tc, i64 == expected[2]);
+   CuAssertUIntEquals(tc, DTL_JSON_LAZY_NONE, dtl_json_lazy_next(doc, node));
+   CuAssertUIntEquals(tc, DTL_JSON_LAZY_NONE, dtl_json_lazy_next(doc, root));
+   dtl_json_lazy_delete(doc);
+
+   doc = load_lazy_cstr("42");
+   CuAssertPtrNotNull(tc, doc);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_i64(doc, dtl_json_lazy_root(doc), &i64));
+   CuAssertTrue(tc, i64 == 42);
+   CuAssertUIntEquals(tc, DTL_JSON_LAZY_NONE, dtl_json_lazy_first(doc, dtl_json_lazy_root(doc)));
+   dtl_json_lazy_delete(doc);
+}
+
+static void test_json_lazy_escaped_strings(CuTest* tc)
+{
+   dtl_json_lazy_t *doc = load_lazy_cstr("{\"plain\": 1, \"a\\\"b\": \"line1\\nline2\", \"\\u0041\": 2, \"nul\": \"x\\u0000y\", \"\\u00e9\": \"caf\\u00e9\"}");
+   dtl_json_lazy_node_t root;
+   dtl_json_lazy_node_t node;
+   const char *str = 0;
+   uint32_t len = 0u;
+   int64_t i64 = 0;
+   CuAssertPtrNotNull(tc, doc);
+   root = dtl_json_lazy_root(doc);
+   node = dtl_json_lazy_get(doc, root, "a\"b");
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_string_slice(doc, node, &str, &len));
+   CuAssertUIntEquals(tc, 11u, len);
+   CuAssertTrue(tc, memcmp(str, "line1\nline2", 11) == 0);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_key(doc, node, &str, &len));
+   CuAssertUIntEquals(tc, 3u, len);
+   CuAssertTrue(tc, memcmp(str, "a\"b", 3) == 0);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_i64(doc, dtl_json_lazy_get(doc, root, "A"), &i64));
+   CuAssertTrue(tc, i64 == 2);
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_lazy_get_key(doc, root, &str, &len));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_string_slice(doc, dtl_json_lazy_get(doc, root, "nul"), &str, &len));
+   CuAssertUIntEquals(tc, 3u, len);
+   CuAssertTrue(tc, memcmp(str, "x\0y", 3) == 0);
+   node = dtl_json_lazy_get(doc, root, "\303\251");
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_lazy_get_string_slice(doc, node, &str, &len));
+   CuAssertUIntEquals(tc, 5u, len);
+   CuAssertTrue(tc, memcmp(str, "caf\303\251", 5) == 0);
+   dtl_json_lazy_delete(doc);
+}
+
+static void test_json_lazy_value(CuTest* tc)
+{
+   const char *json = "{\"skipped\": [1, 2, 3], \"kept\": {\"list\": [true, \"s\", 1.5, {}], \"n\": -7}, \"last\": \"x\"}";
+   dtl_json_lazy_t *doc = load_lazy_cstr(json);
+   dtl_json_lazy_node_t node;
+   dtl_dv_t *value;
+   adt_str_t *output;
+   CuAssertPtrNotNull(tc, doc);
+   node = dtl_json_lazy_get(doc, dtl_json_lazy_root(doc), "kept");
+   value = dtl_json_lazy_value(doc, node);
+   CuAssertPtrNotNull(tc, value);
+   output = dtl_json_dumps(value, 0, true);
+   CuAssertStrEquals(tc, "{\"list\": [true, \"s\", 1.5, {}], \"n\": -7}", adt_str_cstr(output));
+   adt_str_delete(output);
+   dtl_dv_dec_ref(value);
+   value = dtl_json_lazy_value(doc, dtl_json_lazy_get(doc, node, "n"));
+   CuAssertPtrNotNull(tc, value);
+   CuAssertIntEquals(tc, DTL_DV_SCALAR, dtl_dv_type(value));
+   dtl_dv_dec_ref(value);
+   value = dtl_json_lazy_value(doc, dtl_json_lazy_get(doc, dtl_json_lazy_root(doc), "last"));
+   CuAssertPtrNotNull(tc, value);
+   output = dtl_json_dumps(value, 0, false);
+   CuAssertStrEquals(tc, "\"x\"", adt_str_cstr(output));
+   adt_str_delete(output);
+   dtl_dv_dec_ref(value);
+   CuAssertPtrEquals(tc, 0, dtl_json_lazy_value(doc, DTL_JSON_LAZY_NONE));
+   value = dtl_json_lazy_value(doc, dtl_json_lazy_root(doc));
+   CuAssertPtrNotNull(tc, value);
+   output = dtl_json_dumps(value, 0, false);
+   CuAssertStrEquals(tc, json, adt_str_cstr(output));
+   adt_str_delete(output);
+   dtl_dv_dec_ref(value);
+   dtl_json_lazy_delete(doc);
+}
+
+static void test_json_lazy_invalid(CuTest* tc)
+{
+   const char *invalid[] = {"", " ", "[1,]", "[1 2]", "1 2", "{\"a\" 1}", "{\"a\": 1,}", "{1: 2}", "[\"a\": 1]",
+                            "\"abc", "[1}", "{\"a\": [1}", "]", "[", "{", "[[[]]", "{\"a\": 1}}", ":", ","};
+   size_t i;
+   char deepJson[2000];
+   dtl_json_lazy_t *doc;
+   for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+   {
+      doc = load_lazy_cstr(invalid[i]);
+      if (doc != 0)
+      {
+         dtl_json_lazy_delete(doc);
+         CuFail(tc, invalid[i]);
+      }
+   }
+   //nesting deeper than the initial container stack
+   memset(deepJson, '[', sizeof(deepJson) / 2);
+   memset(deepJson + sizeof(deepJson) / 2, ']', sizeof(deepJson) / 2);
+   doc = dtl_json_load_lazy((const uint8_t*) deepJson, (const uint8_t*) deepJson + sizeof(deepJson));
+   CuAssertPtrNotNull(tc, doc);
+   CuAssertIntEquals(tc, 1, dtl_json_lazy_length(doc, dtl_json_lazy_root(doc)));
+   dtl_json_lazy_delete(doc);
+   deepJson[sizeof(deepJson) - 1] = '}';
+   CuAssertPtrEquals(tc, 0, dtl_json_load_lazy((const uint8_t*) deepJson, (const uint8_t*) deepJson + sizeof(deepJson)));
+}
+
+/**
+ * Scalars are not checked by dtl_json_load_lazy, errors show up when they are read.
+ */
+static void test_json_lazy_invalid_scalars(CuTest* tc)
+{
+   dtl_json_lazy_t *doc = load_lazy_cstr("[tru, 01, 1x, nul, -]");
+   dtl_json_lazy_node_t root;
+   int64_t i64 = 0;
+   double dbl = 0.0;
+   bool b = false;
+   CuAssertPtrNotNull(tc, doc);
+   root = dtl_json_lazy_root(doc);
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_ERROR, dtl_json_lazy_type(doc, dtl_json_lazy_at(doc, root, 0u)));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_lazy_get_bool(doc, dtl_json_lazy_at(doc, root, 0u), &b));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_lazy_get_i64(doc, dtl_json_lazy_at(doc, root, 1u), &i64));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_lazy_get_double(doc, dtl_json_lazy_at(doc, root, 2u), &dbl));
+   CuAssertIntEquals(tc, DTL_JSON_TOKEN_ERROR, dtl_json_lazy_type(doc, dtl_json_lazy_at(doc, root, 3u)));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, dtl_json_lazy_get_i64(doc, dtl_json_lazy_at(doc, root, 4u), &i64));
+   CuAssertPtrEquals(tc, 0, dtl_json_lazy_value(doc, root));
+   dtl_json_lazy_delete(doc);
+}
+
+static dtl_json_lazy_t *load_lazy_cstr(const char *json)
+{
+   return dtl_json_load_lazy((const uint8_t*) json, (const uint8_t*) json + strlen(json));
+}
@@ -0,0 +1,426 @@
+/*****************************************************************************
+* \file      testsuite_dtl_json_number.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Unit tests for dtl_json_number
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "CuTest.h"
+#include "dtl_json_number.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define LONG_NUMBER_LEN 2000
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_json_number_parse(CuTest* tc);
+static void test_json_number_parse_invalid(CuTest* tc);
+static void test_json_number_to_integer(CuTest* tc);
+static void test_json_number_to_double(CuTest* tc);
+static void test_json_number_hard_cases(CuTest* tc);
+static void test_json_number_long_input(CuTest* tc);
+static void test_json_number_small_mantissa_all_exponents(CuTest* tc);
+static void test_json_number_round_trip_random(CuTest* tc);
+static void test_json_number_random_digits(CuTest* tc);
+static void test_json_number_format_double(CuTest* tc);
+static double parse_cstr(const char *str);
+static const dtl_json_number_t *lex_cstr(const char *str, dtl_json_number_t *number);
+static bool is_same_double(double a, double b);
+static uint64_t random_u64(void);
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_dtl_json_number(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_json_number_parse);
+   SUITE_ADD_TEST(suite, test_json_number_parse_invalid);
+   SUITE_ADD_TEST(suite, test_json_number_to_integer);
+   SUITE_ADD_TEST(suite, test_json_number_to_double);
+   SUITE_ADD_TEST(suite, test_json_number_hard_cases);
+   SUITE_ADD_TEST(suite, test_json_number_long_input);
+   SUITE_ADD_TEST(suite, test_json_number_small_mantissa_all_exponents);
+   SUITE_ADD_TEST(suite, test_json_number_round_trip_random);
+   SUITE_ADD_TEST(suite, test_json_number_random_digits);
+   SUITE_ADD_TEST(suite, test_json_number_format_double);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_number_parse(CuTest* tc)
+{
+   const char *input1 = "123";
+   const char *input2 = "-0.00125";
+   const char *input3 = "2.5E+3,";
+   const char *input4 = "12345678901234567890123";
+   const char *input5 = "01";
+   dtl_json_number_t number;
+
+   CuAssertPtrEquals(tc, (void*) (input1 + 3), (void*) dtl_json_number_parse((const uint8_t*) input1, (const uint8_t*) input1 + strlen(input1), &number));
+   CuAssertTrue(tc, number.isInteger);
+   CuAssertTrue(tc, !number.isNegative);
+   CuAssertTrue(tc, !number.isTruncated);
+   CuAssertTrue(tc, number.mantissa == 123u);
+   CuAssertIntEquals(tc, 0, number.exponent);
+
+   CuAssertPtrEquals(tc, (void*) (input2 + 8), (void*) dtl_json_number_parse((const uint8_t*) input2, (const uint8_t*) input2 + strlen(input2), &number));
+   CuAssertTrue(tc, !number.isInteger);
+   CuAssertTrue(tc, number.isNegative);
+   CuAssertTrue(tc, number.mantissa == 125u);
+   CuAssertIntEquals(tc, -5, number.exponent);
+
+   CuAssertPtrEquals(tc, (void*) (input3 + 6), (void*) dtl_json_number_parse((const uint8_t*) input3, (const uint8_t*) input3 + strlen(input3), &number));
+   CuAssertTrue(tc, !number.isInteger);
+   CuAssertTrue(tc, number.mantissa == 25u);
+   CuAssertIntEquals(tc, 2, number.exponent);
+
+   CuAssertPtrEquals(tc, (void*) (input4 + 23), (void*) dtl_json_number_parse((const uint8_t*) input4, (const uint8_t*) input4 + strlen(input4), &number));
+   CuAssertTrue(tc, number.isInteger);
+   CuAssertTrue(tc, number.isTruncated);
+   CuAssertTrue(tc, number.mantissa == UINT64_C(12345678901234567890));
+   CuAssertIntEquals(tc, 3, number.exponent);
+
+   //a leading zero ends the number, the caller decides what to do with the remaining digits
+   CuAssertPtrEquals(tc, (void*) (input5 + 1), (void*) dtl_json_number_parse((const uint8_t*) input5, (const uint8_t*) input5 + strlen(input5), &number));
+   CuAssertTrue(tc, number.mantissa == 0u);
+}
+
+static void test_json_number_parse_invalid(CuTest* tc)
+{
+   const char *input[] = {"-", "+1", ".5", "-.5", "1.", "1.e5", "1e", "1e+", "1E-", "-x", "a"};
+   int32_t i;
+   for (i = 0; i < (int32_t) (sizeof(input) / sizeof(input[0])); i++)
+   {
+      dtl_json_number_t number;
+      CuAssertPtrEquals(tc, 0, (void*) dtl_json_number_parse((const uint8_t*) input[i], (const uint8_t*) input[i] + strlen(input[i]), &number));
+   }
+}
+
+static void test_json_number_to_integer(CuTest* tc)
+{
+   dtl_json_number_t number;
+   int64_t i64 = 0;
+   uint64_t u64 = 0u;
+
+   CuAssertTrue(tc, dtl_json_number_to_i64(lex_cstr("9223372036854775807", &number), &i64));
+   CuAssertTrue(tc, i64 == INT64_MAX);
+   CuAssertTrue(tc, dtl_json_number_to_u64(&number, &u64));
+   CuAssertTrue(tc, u64 == (uint64_t) INT64_MAX);
+   CuAssertTrue(tc, dtl_json_number_to_i64(lex_cstr("-9223372036854775808", &number), &i64));
+   CuAssertTrue(tc, i64 == INT64_MIN);
+   CuAssertTrue(tc, !dtl_json_number_to_u64(&number, &u64));
+   CuAssertTrue(tc, !dtl_json_number_to_i64(lex_cstr("9223372036854775808", &number), &i64));
+   CuAssertTrue(tc, dtl_json_number_to_u64(&number, &u64));
+   CuAssertTrue(tc, u64 == UINT64_C(9223372036854775808));
+   CuAssertTrue(tc, !dtl_json_number_to_i64(lex_cstr("-9223372036854775809", &number), &i64));
+   CuAssertTrue(tc, dtl_json_number_to_u64(lex_cstr("18446744073709551615", &number), &u64));
+   CuAssertTrue(tc, u64 == UINT64_MAX);
+   CuAssertTrue(tc, !number.isTruncated);
+   CuAssertIntEquals(tc, 0, number.exponent);
+   CuAssertTrue(tc, dtl_json_number_to_i64(lex_cstr("-0", &number), &i64));
+   CuAssertTrue(tc, i64 == 0);
+   CuAssertTrue(tc, dtl_json_number_to_u64(&number, &u64));
+   CuAssertTrue(tc, u64 == 0u);
+
+   //overflow in the 20th digit
+   CuAssertTrue(tc, !dtl_json_number_to_u64(lex_cstr("18446744073709551616", &number), &u64));
+   CuAssertTrue(tc, number.isTruncated);
+   CuAssertTrue(tc, number.mantissa == UINT64_C(1844674407370955161));
+   CuAssertIntEquals(tc, 1, number.exponent);
+   //digits after an overflowing digit must not be accumulated even when they would fit
+   CuAssertTrue(tc, !dtl_json_number_to_u64(lex_cstr("184467440737095516170", &number), &u64));
+   CuAssertTrue(tc, number.mantissa == UINT64_C(1844674407370955161));
+   CuAssertIntEquals(tc, 2, number.exponent);
+   CuAssertTrue(tc, is_same_double(184467440737095516170.0, dtl_json_number_to_double(&number)));
+   //integral values written with fraction or exponent are not integers
+   CuAssertTrue(tc, !dtl_json_number_to_i64(lex_cstr("1.0", &number), &i64));
+   CuAssertTrue(tc, !dtl_json_number_to_u64(lex_cstr("1e2", &number), &u64));
+}
+
+static void test_json_number_to_double(CuTest* tc)
+{
+   CuAssertTrue(tc, is_same_double(0.0, parse_cstr("0")));
+   CuAssertTrue(tc, is_same_double(-0.0, parse_cstr("-0")));
+   CuAssertTrue(tc, is_same_double(-0.0, parse_cstr("-0.0e10")));
+   CuAssertTrue(tc, is_same_double(1.5, parse_cstr("1.5")));
+   CuAssertTrue(tc, is_same_double(0.1, parse_cstr("0.1")));
+   CuAssertTrue(tc, is_same_double(-123.456, parse_cstr("-123.456")));
+   CuAssertTrue(tc, is_same_double(1e22, parse_cstr("1e22")));
+   CuAssertTrue(tc, is_same_double(1e23, parse_cstr("1e23")));
+   CuAssertTrue(tc, is_same_double(1e-22, parse_cstr("1e-22")));
+   CuAssertTrue(tc, is_same_double(3.141592653589793, parse_cstr("3.141592653589793")));
+   CuAssertTrue(tc, is_same_double(123456789012345678901234567890.0, parse_cstr("123456789012345678901234567890")));
+}
+
+static void test_json_number_hard_cases(CuTest* tc)
+{
+   //half-way between 2^53 and 2^53+2 rounds to even, anything above rounds up
+   CuAssertTrue(tc, is_same_double(9007199254740992.0, parse_cstr("9007199254740993")));
+   CuAssertTrue(tc, is_same_double(9007199254740994.0, parse_cstr("9007199254740993.0000000000000000001")));
+   CuAssertTrue(tc, is_same_double(9007199254740996.0, parse_cstr("9007199254740995")));
+   //boundary between subnormal and normal numbers
+   CuAssertTrue(tc, is_same_double(2.2250738585072011e-308, parse_cstr("2.2250738585072011e-308")));
+   CuAssertTrue(tc, is_same_double(2.2250738585072014e-308, parse_cstr("2.2250738585072012e-308")));
+   CuAssertTrue(tc, is_same_double(2.2250738585072014e-308, parse_cstr("2.2250738585072014e-308")));
+   //smallest subnormal and values around half of it
+   CuAssertTrue(tc, is_same_double(4.9406564584124654e-324, parse_cstr("4.9406564584124654e-324")));
+   CuAssertTrue(tc, is_same_double(0.0, parse_cstr("2.4703282292062327e-324")));
+   CuAssertTrue(tc, is_same_double(4.9406564584124654e-324, parse_cstr("2.4703282292062328e-324")));
+   CuAssertTrue(tc, is_same_double(0.0, parse_cstr("1e-400")));
+   CuAssertTrue(tc, is_same_double(-0.0, parse_cstr("-1e-400")));
+   //largest double and overflow
+   CuAssertTrue(tc, is_same_double(1.7976931348623157e308, parse_cstr("1.7976931348623157e308")));
+   CuAssertTrue(tc, is_same_double(1.7976931348623157e308, parse_cstr("1.7976931348623158e308")));
+   CuAssertTrue(tc, is_same_double(HUGE_VAL, parse_cstr("1.7976931348623159e308")));
+   CuAssertTrue(tc, is_same_double(HUGE_VAL, parse_cstr("1e400")));
+   CuAssertTrue(tc, is_same_double(-HUGE_VAL, parse_cstr("-1e99999999999")));
+   CuAssertTrue(tc, is_same_double(0.0, parse_cstr("0e99999999999")));
+   //inputs known to need more than 64 bits of precision
+   CuAssertTrue(tc, is_same_double(8.98846567431158e307, parse_cstr("8.98846567431158e307")));
+   CuAssertTrue(tc, is_same_double(7.0064923216240854e-46, parse_cstr("7.0064923216240854e-46")));
+   CuAssertTrue(tc, is_same_double(strtod("1.00000000000000011102230246251565404236316680908203125", 0), parse_cstr("1.00000000000000011102230246251565404236316680908203125")));
+   CuAssertTrue(tc, is_same_double(strtod("1.00000000000000011102230246251565404236316680908203124", 0), parse_cstr("1.00000000000000011102230246251565404236316680908203124")));
+   CuAssertTrue(tc, is_same_double(strtod("1.00000000000000011102230246251565404236316680908203126", 0), parse_cstr("1.00000000000000011102230246251565404236316680908203126")));
+}
+
+/**
+ * Exact decimal expansions of half-way points are very long, this forces the arbitrary precision fallback.
+ */
+static void test_json_number_long_input(CuTest* tc)
+{
+   char *str = (char*) malloc(LONG_NUMBER_LEN + 16);
+   int32_t i;
+   CuAssertPtrNotNull(tc, str);
+
+   //close to half of the smallest subnormal, with far more digits than the decimal fallback keeps
+   strcpy(str, "2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936316934053428095891446089856648812684617063021574726218402590478734302468405683808306513553880127466609706698117658906937155866637513779624536418693648611834098924005722398024716419698221478935862093614869221543393282935405627803573963855418386627005008216154848213221117208452346303432021024327917286049219007542113316604062307149512201131300012574005406252218698003958616049618227768932209116225716808283048376149002021245001658813548616006547405426099802542009082012099659818888227950697219926225081393208005093521719908327419567316346125052437612838829215454054807101059838689848046837001486822107181718052127066407226009612451125758722516047221240209939999016217097823107911931893048347625225131055584733807022066484779891211807451466718209758883045869788154609683869935126107726045106201702733342406278920856218103520734498536015140201633584810052055591063719706041478627811765919096007390564154223702107279130788829302802730802519117612587116807405296271609149049212826151087000124919174212183046733041312018917718669262822328466546101946522021633021599758215779011908283126131452698059078452744418812495037209102566400628698939154581627400402119808125306049193818624010599707018546193451025007802547637609373584398807406342306733209016210215612315734698130218322779219216406549963823102213016055624004316101406224106271659508713088512751316298828239624945669127617055286066015218315107124917215806718542040542021216406322032240006110115010010009e-325");
+   CuAssertTrue(tc, is_same_double(strtod(str, 0), parse_cstr(str)));
+
+   //many digits just below and above half-way between 1 and the next double
+   strcpy(str, "1.00000000000000011102230246251565404236316680908203125");
+   CuAssertTrue(tc, is_same_double(1.0, parse_cstr(str))); //exactly half-way, rounds to even
+   i = (int32_t) strlen(str);
+   str[i - 1] = '4';
+   while (i < LONG_NUMBER_LEN)
+   {
+      str[i++] = '9';
+   }
+   str[i] = '\0';
+   CuAssertTrue(tc, is_same_double(1.0, parse_cstr(str)));
+   strcpy(str, "1.00000000000000011102230246251565404236316680908203125");
+   i = (int32_t) strlen(str);
+   while (i < LONG_NUMBER_LEN - 1)
+   {
+      str[i++] = '0';
+   }
+   str[i++] = '1';
+   str[i] = '\0';
+   CuAssertTrue(tc, is_same_double(1.0000000000000002, parse_cstr(str)));
+
+   //very long integer
+   for (i = 0; i < 400; i++)
+   {
+      str[i] = (char) ('1' + (i % 9));
+   }
+   str[i] = '\0';
+   CuAssertTrue(tc, is_same_double(HUGE_VAL, parse_cstr(str)));
+   str[300] = '\0';
+   CuAssertTrue(tc, is_same_double(strtod(str, 0), parse_cstr(str)));
+   free(str);
+}
+
+/**
+ * Every mantissa in [1, 999] combined with every decimal exponent that can produce a finite non-zero double.
+ * The C library's strtod is used as reference.
+ */
+static void test_json_number_small_mantissa_all_exponents(CuTest* tc)
+{
+   int32_t mantissa;
+   int32_t exponent;
+   char buf[32];
+   for (mantissa = 1; mantissa < 1000; mantissa++)
+   {
+      for (exponent = -330; exponent <= 310; exponent++)
+      {
+         sprintf(buf, "%de%d", (int) mantissa, (int) exponent);
+         if (!is_same_double(strtod(buf, 0), parse_cstr(buf)))
+         {
+            CuFail(tc, buf);
+         }
+      }
+   }
+}
+
+/**
+ * Random bit patterns are printed with 17 significant digits and must convert back to the same bit pattern.
+ */
+static void test_json_number_round_trip_random(CuTest* tc)
+{
+   int32_t i;
+   char buf[DTL_JSON_NUMBER_FORMAT_BUF_SIZE];
+   srand(1234);
+   for (i = 0; i < 200000; i++)
+   {
+      uint64_t bits = random_u64();
+      double value;
+      memcpy(&value, &bits, sizeof(value));
+      if (!isfinite(value))
+      {
+         continue;
+      }
+      sprintf(buf, "%.17g", value);
+      if (!is_same_double(value, parse_cstr(buf)))
+      {
+         CuFail(tc, buf);
+      }
+      CuAssertTrue(tc, dtl_json_number_format_double(value, buf, (uint32_t) sizeof(buf)) > 0);
+      if (!is_same_double(value, parse_cstr(buf)))
+      {
+         CuFail(tc, buf);
+      }
+   }
+}
+
+/**
+ * Random digit strings of up to 40 digits, with exponents covering the whole range, compared with strtod.
+ */
+static void test_json_number_random_digits(CuTest* tc)
+{
+   int32_t i;
+   char buf[64];
+   srand(4321);
+   for (i = 0; i < 100000; i++)
+   {
+      int32_t numDigits = 1 + rand() % 40;
+      int32_t pointPos = rand() % numDigits;
+      int32_t len = 0;
+      int32_t j;
+      if (rand() % 2 != 0)
+      {
+         buf[len++] = '-';
+      }
+      for (j = 0; j < numDigits; j++)
+      {
+         if (j == pointPos + 1)
+         {
+            buf[len++] = '.';
+         }
+         //favor runs of zeros and nines, they sit close to rounding boundaries
+         switch ( (j == 0)? 3 : (rand() % 4) )
+         {
+         case 0:
+            buf[len++] = '0';
+            break;
+         case 1:
+            buf[len++] = '9';
+            break;
+         default:
+            buf[len++] = (char) ( (j == 0)? ('1' + rand() % 9) : ('0' + rand() % 10) ); //no leading zeros in JSON
+         }
+      }
+      sprintf(&buf[len], "e%d", (int) (rand() % 700) - 350);
+      if (!is_same_double(strtod(buf, 0), parse_cstr(buf)))
+      {
+         CuFail(tc, buf);
+      }
+   }
+}
+
+static void test_json_number_format_double(CuTest* tc)
+{
+   char buf[DTL_JSON_NUMBER_FORMAT_BUF_SIZE];
+   CuAssertIntEquals(tc, 3, dtl_json_number_format_double(0.5, buf, (uint32_t) sizeof(buf)));
+   CuAssertStrEquals(tc, "0.5", buf);
+   CuAssertIntEquals(tc, 3, dtl_json_number_format_double(2.0, buf, (uint32_t) sizeof(buf)));
+   CuAssertStrEquals(tc, "2.0", buf);
+   CuAssertIntEquals(tc, 3, dtl_json_number_format_double(0.1, buf, (uint32_t) sizeof(buf)));
+   CuAssertStrEquals(tc, "0.1", buf);
+   dtl_json_number_format_double(0.1 + 0.2, buf, (uint32_t) sizeof(buf));
+   CuAssertStrEquals(tc, "0.30000000000000004", buf);
+   dtl_json_number_format_double(1e21, buf, (uint32_t) sizeof(buf));
+   CuAssertStrEquals(tc, "1e+21", buf);
+   dtl_json_number_format_double(-1.7976931348623157e308, buf, (uint32_t) sizeof(buf));
+   CuAssertStrEquals(tc, "-1.7976931348623157e+308", buf);
+   CuAssertIntEquals(tc, -1, dtl_json_number_format_double(HUGE_VAL, buf, (uint32_t) sizeof(buf)));
+   CuAssertIntEquals(tc, -1, dtl_json_number_format_double(0.5, buf, 4u));
+}
+
+static double parse_cstr(const char *str)
+{
+   dtl_json_number_t number;
+   if (lex_cstr(str, &number) == 0)
+   {
+      return NAN;
+   }
+   return dtl_json_number_to_double(&number);
+}
+
+static const dtl_json_number_t *lex_cstr(const char *str, dtl_json_number_t *number)
+{
+   const uint8_t *pEnd = (const uint8_t*) str + strlen(str);
+   if (dtl_json_number_parse((const uint8_t*) str, pEnd, number) != pEnd)
+   {
+      return (const dtl_json_number_t*) 0;
+   }
+   return number;
+}
+
+static bool is_same_double(double a, double b)
+{
+   return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+static uint64_t random_u64(void)
+{
+   uint64_t value = 0u;
+   int32_t i;
+   for (i = 0; i < 4; i++)
+   {
+      value = (value << 16) | (uint64_t) (rand() & 0xFFFF);
+   }
+   return value;
+}
@@ -0,0 +1,244 @@
+/*****************************************************************************
+* \file      testsuite_dtl_json_pointer.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Unit tests for dtl_json_extract and dtl_json_load_projected
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+#include "dtl_json.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_extract_paths(CuTest* tc);
+static void test_json_extract_escaped_tokens(CuTest* tc);
+static void test_json_extract_not_found(CuTest* tc);
+static void test_json_extract_stops_at_value(CuTest* tc);
+static void test_json_projection_paths(CuTest* tc);
+static void test_json_projection_wildcard(CuTest* tc);
+static void test_json_projection_overlapping_paths(CuTest* tc);
+static void test_json_projection_invalid(CuTest* tc);
+static char *extract_dumps(const char *json, const char *pointer);
+static char *projected_dumps(const char *json, const char **paths, uint32_t numPaths);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static char m_output[256];
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_dtl_json_pointer(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_json_extract_paths);
+   SUITE_ADD_TEST(suite, test_json_extract_escaped_tokens);
+   SUITE_ADD_TEST(suite, test_json_extract_not_found);
+   SUITE_ADD_TEST(suite, test_json_extract_stops_at_value);
+   SUITE_ADD_TEST(suite, test_json_projection_paths);
+   SUITE_ADD_TEST(suite, test_json_projection_wildcard);
+   SUITE_ADD_TEST(suite, test_json_projection_overlapping_paths);
+   SUITE_ADD_TEST(suite, test_json_projection_invalid);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_extract_paths(CuTest* tc)
+{
+   const char *json = "{\"skip\": {\"x\": [1, \"]}\", {\"y\": false}]}, \"a\": {\"b\": [10, 20, {}, {\"c\": \"found\", \"d\": [true]}]}, \"z\": 1.5}";
+   CuAssertStrEquals(tc, "\"found\"", extract_dumps(json, "/a/b/3/c"));
+   CuAssertStrEquals(tc, "[true]", extract_dumps(json, "/a/b/3/d"));
+   CuAssertStrEquals(tc, "true", extract_dumps(json, "/a/b/3/d/0"));
+   CuAssertStrEquals(tc, "20", extract_dumps(json, "/a/b/1"));
+   CuAssertStrEquals(tc, "{}", extract_dumps(json, "/a/b/2"));
+   CuAssertStrEquals(tc, "1.5", extract_dumps(json, "/z"));
+   CuAssertStrEquals(tc, "false", extract_dumps(json, "/skip/x/2/y"));
+   CuAssertStrEquals(tc, "{\"c\": \"found\", \"d\": [true]}", extract_dumps(json, "/a/b/3"));
+   CuAssertStrEquals(tc, "[1]", extract_dumps("[1]", ""));
+}
+
+static void test_json_extract_escaped_tokens(CuTest* tc)
+{
+   const char *json = "{\"a/b\": 1, \"m~n\": 2, \"q\\\"r\": 4, \" \": 5}";
+   CuAssertStrEquals(tc, "1", extract_dumps(json, "/a~1b"));
+   CuAssertStrEquals(tc, "2", extract_dumps(json, "/m~0n"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/")); //empty keys are not supported
+   CuAssertStrEquals(tc, "4", extract_dumps(json, "/q\"r"));
+   CuAssertStrEquals(tc, "5", extract_dumps(json, "/ "));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/a/b"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/m~2n"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/m~"));
+}
+
+static void test_json_extract_not_found(CuTest* tc)
+{
+   const char *json = "{\"a\": [0, 1, 2], \"s\": \"text\"}";
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/b"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/a/3"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/a/-"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/a/01"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/a/1x"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/a/"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/a/99999999999"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "/s/0"));
+   CuAssertPtrEquals(tc, 0, extract_dumps(json, "a"));
+   CuAssertPtrEquals(tc, 0, extract_dumps("[1, 2", "/1/0"));
+   CuAssertPtrEquals(tc, 0, extract_dumps("{\"a\": [1, 2}", "/a"));
+   CuAssertPtrEquals(tc, 0, extract_dumps("{\"a\": [1, 2]", ""));
+   CuAssertPtrEquals(tc, 0, dtl_json_extract((const uint8_t*) json, (const uint8_t*) json + strlen(json), (const char*) 0));
+}
+
+/**
+ * Content after the addressed value is not read.
+ */
+static void test_json_extract_stops_at_value(CuTest* tc)
+{
+   CuAssertStrEquals(tc, "[2]", extract_dumps("{\"a\": 1, \"b\": [2], \"c\": not json", "/b"));
+   CuAssertStrEquals(tc, "1", extract_dumps("[1, ", "/0"));
+}
+
+static void test_json_projection_paths(CuTest* tc)
+{
+   const char *json = "{\"header\": {\"id\": 7, \"note\": \"\\q is not decoded\", \"tags\": [[1], {\"a\": 2}]}, "
+                      "\"items\": [{\"price\": 1.5, \"name\": \"x\"}, {\"name\": \"y\"}, {\"price\": {\"sek\": 20}}, 3], \"trailer\": null}";
+   const char *paths[] = {"/header/id", "/items/*/price"};
+   const char *indexPaths[] = {"/items/2/price/sek", "/items/3", "/items/1/price"}; //items[1] has no price
+   const char *rootPaths[] = {""};
+   CuAssertStrEquals(tc, "{\"header\": {\"id\": 7}, \"items\": [{\"price\": 1.5}, {}, {\"price\": {\"sek\": 20}}]}",
+                     projected_dumps(json, paths, 2u));
+   CuAssertStrEquals(tc, "{\"items\": [{}, {\"price\": {\"sek\": 20}}, 3]}", projected_dumps(json, indexPaths, 3u));
+   CuAssertStrEquals(tc, "[1, 2]", projected_dumps("[1, 2]", rootPaths, 1u));
+   CuAssertStrEquals(tc, "{}", projected_dumps(json, paths, 0u));
+   CuAssertStrEquals(tc, "[]", projected_dumps("[{\"header\": 1}]", paths, 2u));
+   CuAssertPtrEquals(tc, 0, projected_dumps("\"text\"", paths, 2u));
+}
+
+static void test_json_projection_wildcard(CuTest* tc)
+{
+   const char *json = "{\"a\": {\"x\": {\"v\": 1, \"w\": 2}, \"y\": {\"v\": 3}, \"z\": 4}, \"*\": {\"v\": 5}}";
+   const char *paths[] = {"/*/*/v"};
+   const char *escapedPaths[] = {"/a~1b", "/m~0n"};
+   CuAssertStrEquals(tc, "{\"*\": {}, \"a\": {\"x\": {\"v\": 1}, \"y\": {\"v\": 3}}}", projected_dumps(json, paths, 1u));
+   CuAssertStrEquals(tc, "{\"a/b\": 1, \"m~n\": [2]}", projected_dumps("{\"a/b\": 1, \"m~n\": [2], \"a\": {\"b\": 3}}", escapedPaths, 2u));
+}
+
+/**
+ * A path selecting an entire value takes precedence over longer paths through the same value.
+ */
+static void test_json_projection_overlapping_paths(CuTest* tc)
+{
+   const char *json = "{\"a\": {\"b\": 1, \"c\": [2, 3]}, \"d\": [{\"e\": 4, \"f\": 5}, {\"e\": 6}]}";
+   const char *paths[] = {"/a/b", "/a", "/a/c/0"};
+   const char *arrayPaths[] = {"/d/*/e", "/d/1", "/d/0/f"};
+   CuAssertStrEquals(tc, "{\"a\": {\"b\": 1, \"c\": [2, 3]}}", projected_dumps(json, paths, 3u));
+   CuAssertStrEquals(tc, "{\"d\": [{\"e\": 4, \"f\": 5}, {\"e\": 6}]}", projected_dumps(json, arrayPaths, 3u));
+}
+
+static void test_json_projection_invalid(CuTest* tc)
+{
+   const char *badPaths[] = {"/a", "b"};
+   const char *badEscape[] = {"/a~2"};
+   const char *nullPath[] = {(const char*) 0};
+   const char *paths[] = {"/a/b"};
+   dtl_json_projection_t *projection = dtl_json_projection_new(paths, 1u);
+   CuAssertPtrNotNull(tc, projection);
+   CuAssertPtrEquals(tc, 0, dtl_json_load_projected((const uint8_t*) 0, (const uint8_t*) 0, projection));
+   dtl_json_projection_delete(projection);
+   CuAssertPtrEquals(tc, 0, dtl_json_projection_new(badPaths, 2u));
+   CuAssertPtrEquals(tc, 0, dtl_json_projection_new(badEscape, 1u));
+   CuAssertPtrEquals(tc, 0, dtl_json_projection_new(nullPath, 1u));
+   CuAssertPtrEquals(tc, 0, dtl_json_projection_new((const char**) 0, 1u));
+   CuAssertPtrEquals(tc, 0, projected_dumps("{\"a\": {\"b\": 1}", paths, 1u));
+   CuAssertPtrEquals(tc, 0, projected_dumps("{\"a\": {\"b\": tru}}", paths, 1u));
+   CuAssertPtrEquals(tc, 0, projected_dumps("{\"x\": [1, 2, \"a\": {\"b\": 1}}", paths, 1u));
+   CuAssertPtrEquals(tc, 0, projected_dumps("{\"a\": {\"b\": 1}} 2", paths, 1u));
+   CuAssertPtrEquals(tc, 0, projected_dumps("{\"a\": {\"b\": [1}}", paths, 1u));
+}
+
+/**
+ * Returns extracted value serialized into a static buffer, or NULL if dtl_json_extract failed.
+ */
+static char *extract_dumps(const char *json, const char *pointer)
+{
+   char *retval = (char*) 0;
+   dtl_dv_t *value = dtl_json_extract((const uint8_t*) json, (const uint8_t*) json + strlen(json), pointer);
+   if (value != 0)
+   {
+      adt_str_t *output = dtl_json_dumps(value, 0, false);
+      if (output != 0)
+      {
+         strncpy(m_output, adt_str_cstr(output), sizeof(m_output) - 1u);
+         m_output[sizeof(m_output) - 1u] = '\0';
+         retval = m_output;
+         adt_str_delete(output);
+      }
+      dtl_dv_dec_ref(value);
+   }
+   return retval;
+}
+
+/**
+ * Returns projected document serialized with sorted keys into a static buffer, or NULL if dtl_json_load_projected failed.
+ */
+static char *projected_dumps(const char *json, const char **paths, uint32_t numPaths)
+{
+   char *retval = (char*) 0;
+   dtl_json_projection_t *projection = dtl_json_projection_new(paths, numPaths);
+   if (projection != 0)
+   {
+      dtl_dv_t *value = dtl_json_load_projected((const uint8_t*) json, (const uint8_t*) json + strlen(json), projection);
+      if (value != 0)
+      {
+         adt_str_t *output = dtl_json_dumps(value, 0, true);
+         if (output != 0)
+         {
+            strncpy(m_output, adt_str_cstr(output), sizeof(m_output) - 1u);
+            m_output[sizeof(m_output) - 1u] = '\0';
+            retval = m_output;
+            adt_str_delete(output);
+         }
+         dtl_dv_dec_ref(value);
+      }
+      dtl_json_projection_delete(projection);
+   }
+   return retval;
+}
@@ -28,6 +28,7 @@
 //////////////////////////////////////////////////////////////////////////////
 #include <stdio.h>
 #include <stddef.h>
+#include <string.h>
 #include "dtl_type.h"
 #include "CuTest.h"
 #include "dtl_json.h"
@@ -41,6 +42,13 @@
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
+typedef struct lines_log_tag
+{
+   adt_str_t *log;
+   bool skipErrors;
+   uint32_t maxRecords; //0 means no limit
+   uint32_t numRecords;
+} lines_log_t;
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -51,7 +59,10 @@ static void test_json_read_false(CuTest* tc);
 static void test_json_read_true(CuTest* tc);
 static void test_json_read_i32(CuTest* tc);
 static void test_json_read_u32(CuTest* tc);
+static void test_json_read_integer_boundaries(CuTest* tc);
+static void test_json_read_double(CuTest* tc);
 static void test_json_read_string(CuTest* tc);
+static void test_json_read_escaped_utf8(CuTest* tc);
 static void test_json_read_empty_list(CuTest *tc);
 static void test_json_read_list_of_i32(CuTest* tc);
 static void test_json_read_list_of_empty_lists(CuTest* tc);
@@ -60,6 +71,41 @@ static void test_json_read_empty_object(CuTest* tc);
 static void test_json_read_object(CuTest* tc);
 static void test_json_read_object_with_array(CuTest* tc);
 static void test_json_read_array_of_objects(CuTest* tc);
+static void test_json_read_streamed_file(CuTest* tc);
+static void test_json_read_streamed_file_truncated(CuTest* tc);
+static void test_json_load_file(CuTest* tc);
+static void test_json_read_deeply_nested(CuTest* tc);
+static void test_json_parser_feed_bytewise(CuTest* tc);
+static void test_json_parser_feed_number(CuTest* tc);
+static void test_json_parser_feed_errors(CuTest* tc);
+static void test_json_parser_feed_after_done(CuTest* tc);
+static void test_json_parse_events(CuTest* tc);
+static void test_json_parse_events_from_file(CuTest* tc);
+static void test_json_parse_events_error(CuTest* tc);
+static void test_json_load_lines(CuTest* tc);
+static void test_json_load_lines_errors(CuTest* tc);
+static void test_json_load_lines_stop(CuTest* tc);
+static void test_json_load_lines_from_file(CuTest* tc);
+static void test_json_load_lines_parallel(CuTest* tc);
+static void test_json_load_lines_null_arguments(CuTest* tc);
+static void test_json_load_parallel(CuTest* tc);
+static void test_json_reader_reuse(CuTest* tc);
+static void test_json_reader_limits(CuTest* tc);
+static void test_json_parser_limits(CuTest* tc);
+static void event_begin_object(void *arg);
+static void event_end_object(void *arg);
+static void event_begin_array(void *arg);
+static void event_end_array(void *arg);
+static void event_key(void *arg, const char *pKey, uint32_t keyLen);
+static void event_string(void *arg, const char *pStr, uint32_t strLen);
+static void event_int(void *arg, int64_t value);
+static void event_double(void *arg, double value);
+static void event_uint(void *arg, uint64_t value);
+static void event_bool(void *arg, bool value);
+static void event_null(void *arg);
+static void event_handler_create(dtl_json_handler_t *handler);
+static bool lines_log_record(void *arg, uint32_t lineNumber, dtl_dv_t *dv, dtl_json_error_t errorCode);
+static dtl_json_error_t lines_load_cstr(lines_log_t *lines, const char *input);
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -77,7 +123,10 @@ CuSuite* testsuite_dtl_json_reader(void)
    SUITE_ADD_TEST(suite, test_json_read_true);
    SUITE_ADD_TEST(suite, test_json_read_i32);
    SUITE_ADD_TEST(suite, test_json_read_u32);
+   SUITE_ADD_TEST(suite, test_json_read_integer_boundaries);
+   SUITE_ADD_TEST(suite, test_json_read_double);
    SUITE_ADD_TEST(suite, test_json_read_string);
+   SUITE_ADD_TEST(suite, test_json_read_escaped_utf8);
    SUITE_ADD_TEST(suite, test_json_read_empty_list);
    SUITE_ADD_TEST(suite, test_json_read_list_of_i32);
    SUITE_ADD_TEST(suite, test_json_read_list_of_empty_lists);
@@ -86,6 +135,27 @@ CuSuite* testsuite_dtl_json_reader(void)
    SUITE_ADD_TEST(suite, test_json_read_object);
    SUITE_ADD_TEST(suite, test_json_read_object_with_array);
    SUITE_ADD_TEST(suite, test_json_read_array_of_objects);
+   SUITE_ADD_TEST(suite, test_json_read_streamed_file);
+   SUITE_ADD_TEST(suite, test_json_read_streamed_file_truncated);
+   SUITE_ADD_TEST(suite, test_json_load_file);
+   SUITE_ADD_TEST(suite, test_json_read_deeply_nested);
+   SUITE_ADD_TEST(suite, test_json_parser_feed_bytewise);
+   SUITE_ADD_TEST(suite, test_json_parser_feed_number);
+   SUITE_ADD_TEST(suite, test_json_parser_feed_errors);
+   SUITE_ADD_TEST(suite, test_json_parser_feed_after_done);
+   SUITE_ADD_TEST(suite, test_json_parse_events);
+   SUITE_ADD_TEST(suite, test_json_parse_events_from_file);
+   SUITE_ADD_TEST(suite, test_json_parse_events_error);
+   SUITE_ADD_TEST(suite, test_json_load_lines);
+   SUITE_ADD_TEST(suite, test_json_load_lines_errors);
+   SUITE_ADD_TEST(suite, test_json_load_lines_stop);
+   SUITE_ADD_TEST(suite, test_json_load_lines_from_file);
+   SUITE_ADD_TEST(suite, test_json_load_lines_parallel);
+   SUITE_ADD_TEST(suite, test_json_load_lines_null_arguments);
+   SUITE_ADD_TEST(suite, test_json_load_parallel);
+   SUITE_ADD_TEST(suite, test_json_reader_reuse);
+   SUITE_ADD_TEST(suite, test_json_reader_limits);
+   SUITE_ADD_TEST(suite, test_json_parser_limits);
 
    return suite;
 }
@@ -216,6 +286,82 @@ static void test_json_read_u32(CuTest* tc)
 
 }
 
+/**
+ * Integers are stored in the narrowest scalar type that can hold them and must be written back unchanged.
+ */
+static void test_json_read_integer_boundaries(CuTest* tc)
+{
+   const char *input[] = {"2147483647", "-2147483648", "2147483648", "4294967295", "4294967296", "-2147483649",
+                          "9223372036854775807", "-9223372036854775808", "9223372036854775808", "18446744073709551615",
+                          "1234567890123456789", "-1234567890123456789", "12345678901234567890"};
+   const dtl_sv_type_id expected[] = {DTL_SV_I32, DTL_SV_I32, DTL_SV_U32, DTL_SV_U32, DTL_SV_I64, DTL_SV_I64,
+                                      DTL_SV_I64, DTL_SV_I64, DTL_SV_U64, DTL_SV_U64,
+                                      DTL_SV_I64, DTL_SV_I64, DTL_SV_U64};
+   int32_t i;
+   bool ok;
+   dtl_dv_t *result;
+   adt_str_t *output;
+
+   for (i = 0; i < (int32_t) (sizeof(expected) / sizeof(expected[0])); i++)
+   {
+      result = dtl_json_load_cstr(input[i]);
+      CuAssertPtrNotNull(tc, result);
+      CuAssertIntEquals(tc, DTL_DV_SCALAR, dtl_dv_type(result));
+      CuAssertIntEquals(tc, expected[i], dtl_sv_type((dtl_sv_t*) result));
+      output = dtl_json_dumps(result, 0, false);
+      CuAssertPtrNotNull(tc, output);
+      CuAssertStrEquals(tc, input[i], adt_str_cstr(output));
+      adt_str_delete(output);
+      dtl_dv_delete(result);
+   }
+
+   result = dtl_json_load_cstr("-9223372036854775808");
+   CuAssertTrue(tc, dtl_sv_to_i64((dtl_sv_t*) result, &ok) == INT64_MIN);
+   CuAssertTrue(tc, ok);
+   dtl_dv_delete(result);
+   result = dtl_json_load_cstr("18446744073709551615");
+   CuAssertTrue(tc, dtl_sv_to_u64((dtl_sv_t*) result, &ok) == UINT64_MAX);
+   CuAssertTrue(tc, ok);
+   dtl_dv_delete(result);
+
+   //outside of the 64-bit range the value is approximated by a double
+   result = dtl_json_load_cstr("18446744073709551616");
+   CuAssertIntEquals(tc, DTL_SV_DBL, dtl_sv_type((dtl_sv_t*) result));
+   CuAssertTrue(tc, dtl_sv_to_dbl((dtl_sv_t*) result, &ok) == 18446744073709551616.0);
+   dtl_dv_delete(result);
+   result = dtl_json_load_cstr("-9223372036854775809");
+   CuAssertIntEquals(tc, DTL_SV_DBL, dtl_sv_type((dtl_sv_t*) result));
+   CuAssertTrue(tc, dtl_sv_to_dbl((dtl_sv_t*) result, &ok) == -9223372036854775809.0);
+   dtl_dv_delete(result);
+}
+
+static void test_json_read_double(CuTest* tc)
+{
+   const char *input[] = {"0.5", "-2.5e-3", "1E2", "0.1", "1.7976931348623157e308", "4.9406564584124654e-324", "-0.0", "123456789012345678901234567890"};
+   const double expected[] = {0.5, -2.5e-3, 1E2, 0.1, 1.7976931348623157e308, 4.9406564584124654e-324, -0.0, 123456789012345678901234567890.0};
+   int32_t i;
+   bool ok;
+   double value;
+   dtl_dv_t *result;
+   dtl_sv_t *sv;
+
+   for (i = 0; i < (int32_t) (sizeof(expected) / sizeof(expected[0])); i++)
+   {
+      result = dtl_json_load_cstr(input[i]);
+      CuAssertPtrNotNull(tc, result);
+      CuAssertIntEquals(tc, DTL_DV_SCALAR, dtl_dv_type(result));
+      sv = (dtl_sv_t*) result;
+      CuAssertIntEquals(tc, DTL_SV_DBL, dtl_sv_type(sv));
+      value = dtl_sv_to_dbl(sv, &ok);
+      CuAssertTrue(tc, ok);
+      CuAssertTrue(tc, memcmp(&expected[i], &value, sizeof(double)) == 0); //also checks sign of zero
+      dtl_dv_delete(result);
+   }
+   CuAssertPtrEquals(tc, 0, dtl_json_load_cstr("1."));
+   CuAssertPtrEquals(tc, 0, dtl_json_load_cstr("1e"));
+   CuAssertPtrEquals(tc, 0, dtl_json_load_cstr("-.5"));
+}
+
 static void test_json_read_string(CuTest* tc)
 {
    dtl_dv_t *result;
@@ -252,6 +398,42 @@ static void test_json_read_string(CuTest* tc)
    dtl_dv_delete(result);
 }
 
+static void test_json_read_escaped_utf8(CuTest* tc)
+{
+   dtl_dv_t *result;
+   dtl_sv_t *sv;
+   dtl_hv_t *hv;
+   dtl_json_handler_t handler;
+   adt_str_t *log;
+   const char *input1 = "\"caf\\u00e9 \\u3084\"";
+   const char *input2 = "{\"\\u00e9t\\u00e9\": \"\\u3084\\u3042\"}";
+   bool ok;
+
+   result = dtl_json_load_cstr(input1);
+   CuAssertPtrNotNull(tc, result);
+   CuAssertIntEquals(tc, DTL_DV_SCALAR, dtl_dv_type(result));
+   sv = (dtl_sv_t*) result;
+   CuAssertStrEquals(tc, "caf\303\251 \343\202\204", dtl_sv_to_cstr(sv, &ok));
+   CuAssertTrue(tc, ok);
+   dtl_dv_delete(result);
+
+   result = dtl_json_load_cstr(input2);
+   CuAssertPtrNotNull(tc, result);
+   CuAssertIntEquals(tc, DTL_DV_HASH, dtl_dv_type(result));
+   hv = (dtl_hv_t*) result;
+   CuAssertIntEquals(tc, 1, dtl_hv_length(hv));
+   sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, "\303\251t\303\251");
+   CuAssertPtrNotNull(tc, sv);
+   CuAssertStrEquals(tc, "\343\202\204\343\201\202", dtl_sv_to_cstr(sv, &ok));
+   dtl_dv_delete(result);
+
+   log = adt_str_new();
+   event_handler_create(&handler);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_parse_bstr((const uint8_t*) input2, (const uint8_t*) input2 + strlen(input2), &handler, log));
+   CuAssertStrEquals(tc, "{ K(\303\251t\303\251) S(\343\202\204\343\201\202) } ", adt_str_cstr(log));
+   adt_str_delete(log);
+}
+
 static void test_json_read_empty_list(CuTest *tc)
 {
    dtl_dv_t *result;
@@ -569,3 +751,827 @@ static void test_json_read_array_of_objects(CuTest* tc)
 
    dtl_dv_dec_ref(result);
 }
+
+/**
+ * Document is large enough to make strings, numbers, keys and literals straddle the chunk boundaries of the file reader
+ */
+static void test_json_read_streamed_file(CuTest* tc)
+{
+   const int32_t numElems = 5000;
+   int32_t i;
+   FILE *fh;
+   dtl_dv_t *result;
+   dtl_av_t *av;
+   dtl_hv_t *hv;
+   dtl_sv_t *sv;
+   bool ok;
+
+   fh = tmpfile();
+   CuAssertPtrNotNull(tc, fh);
+   fprintf(fh, "[\n");
+   for (i = 0; i < numElems; i++)
+   {
+      fprintf(fh, "   {\"Name\": \"element \\\"%d\\\"\", \"Value\": %d, \"Enabled\": %s, \"Other\": null}%s\n",
+            (int) i, (int) (i * 1000), (i % 2) ? "true" : "false", (i < (numElems - 1)) ? "," : "");
+   }
+   fprintf(fh, "]\n");
+   rewind(fh);
+   result = dtl_json_load(fh);
+   fclose(fh);
+   CuAssertPtrNotNull(tc, result);
+   CuAssertIntEquals(tc, DTL_DV_ARRAY, dtl_dv_type(result));
+   av = (dtl_av_t*) result;
+   CuAssertIntEquals(tc, numElems, dtl_av_length(av));
+   for (i = 0; i < numElems; i++)
+   {
+      char expected[32];
+      hv = (dtl_hv_t*) dtl_av_value(av, i);
+      CuAssertIntEquals(tc, DTL_DV_HASH, dtl_dv_type( (dtl_dv_t*) hv));
+      CuAssertIntEquals(tc, 4, dtl_hv_length(hv));
+      sprintf(expected, "element \"%d\"", (int) i);
+      sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, "Name");
+      CuAssertPtrNotNull(tc, sv);
+      CuAssertStrEquals(tc, expected, dtl_sv_to_cstr(sv, &ok));
+      sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, "Value");
+      CuAssertPtrNotNull(tc, sv);
+      CuAssertIntEquals(tc, i * 1000, dtl_sv_to_i32(sv, &ok));
+      sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, "Enabled");
+      CuAssertPtrNotNull(tc, sv);
+      CuAssertIntEquals(tc, DTL_SV_BOOL, dtl_sv_type(sv));
+      CuAssertTrue(tc, dtl_sv_to_bool(sv, &ok) == ((i % 2) != 0) );
+   }
+   dtl_dv_dec_ref(result);
+
+   fh = tmpfile();
+   CuAssertPtrNotNull(tc, fh);
+   fprintf(fh, "   12345678");
+   rewind(fh);
+   result = dtl_json_load(fh);
+   fclose(fh);
+   CuAssertPtrNotNull(tc, result);
+   CuAssertIntEquals(tc, 12345678, dtl_sv_to_i32((dtl_sv_t*) result, &ok));
+   dtl_dv_dec_ref(result);
+}
+
+static void test_json_read_streamed_file_truncated(CuTest* tc)
+{
+   const int32_t numElems = 1000;
+   int32_t i;
+   FILE *fh;
+
+   fh = tmpfile();
+   CuAssertPtrNotNull(tc, fh);
+   fprintf(fh, "[\n");
+   for (i = 0; i < numElems; i++)
+   {
+      fprintf(fh, "   \"element %d\",\n", (int) i);
+   }
+   fprintf(fh, "   \"unterminated");
+   rewind(fh);
+   CuAssertTrue(tc, dtl_json_load(fh) == 0);
+   fclose(fh);
+
+   fh = tmpfile();
+   CuAssertPtrNotNull(tc, fh);
+   fprintf(fh, "{\"a\": [1, 2, 3]} [4]");
+   rewind(fh);
+   CuAssertTrue(tc, dtl_json_load(fh) == 0);
+   fclose(fh);
+}
+
+static void test_json_load_file(CuTest* tc)
+{
+   const char *path = "test_json_load_file.json";
+   const int32_t numElems = 2000;
+   int32_t i;
+   FILE *fh;
+   dtl_dv_t *result;
+   dtl_av_t *av;
+   bool ok;
+
+   fh = fopen(path, "w");
+   CuAssertPtrNotNull(tc, fh);
+   fprintf(fh, "[\n");
+   for (i = 0; i < numElems; i++)
+   {
+      fprintf(fh, "   %d%s\n", (int) i, (i < (numElems - 1)) ? "," : "");
+   }
+   fprintf(fh, "]\n");
+   fclose(fh);
+   result = dtl_json_load_file(path);
+   CuAssertPtrNotNull(tc, result);
+   CuAssertIntEquals(tc, DTL_DV_ARRAY, dtl_dv_type(result));
+   av = (dtl_av_t*) result;
+   CuAssertIntEquals(tc, numElems, dtl_av_length(av));
+   CuAssertIntEquals(tc, numElems - 1, dtl_sv_to_i32((dtl_sv_t*) dtl_av_value(av, numElems - 1), &ok));
+   dtl_dv_dec_ref(result);
+
+   fh = fopen(path, "w");
+   CuAssertPtrNotNull(tc, fh);
+   fprintf(fh, "[1, 2");
+   fclose(fh);
+   CuAssertTrue(tc, dtl_json_load_file(path) == 0);
+
+   fh = fopen(path, "w");
+   CuAssertPtrNotNull(tc, fh);
+   fclose(fh);
+   CuAssertTrue(tc, dtl_json_load_file(path) == 0);
+   remove(path);
+
+   CuAssertTrue(tc, dtl_json_load_file("does_not_exist.json") == 0);
+}
+
+static void test_json_read_deeply_nested(CuTest* tc)
+{
+   const int32_t depth = 100;
+   int32_t i;
+   adt_str_t *json = adt_str_new();
+   dtl_dv_t *result;
+   dtl_dv_t *dv;
+   bool ok;
+   for (i = 0; i < depth; i++)
+   {
+      adt_str_append_cstr(json, (i % 2) ? "{\"k\": " : "[0, ");
+   }
+   adt_str_append_cstr(json, "1");
+   for (i = depth - 1; i >= 0; i--)
+   {
+      adt_str_append_cstr(json, (i % 2) ? "}" : "]");
+   }
+   result = dtl_json_load_cstr(adt_str_cstr(json));
+   CuAssertPtrNotNull(tc, result);
+   dv = result;
+   for (i = 0; i < depth; i++)
+   {
+      if (i % 2)
+      {
+         CuAssertIntEquals(tc, DTL_DV_HASH, dtl_dv_type(dv));
+         dv = dtl_hv_get_cstr((dtl_hv_t*) dv, "k");
+      }
+      else
+      {
+         CuAssertIntEquals(tc, DTL_DV_ARRAY, dtl_dv_type(dv));
+         CuAssertIntEquals(tc, 2, dtl_av_length((dtl_av_t*) dv));
+         dv = dtl_av_value((dtl_av_t*) dv, 1);
+      }
+   }
+   CuAssertIntEquals(tc, 1, dtl_sv_to_i32((dtl_sv_t*) dv, &ok));
+   dtl_dv_dec_ref(result);
+   adt_str_delete(json);
+}
+
+static void test_json_parser_feed_bytewise(CuTest* tc)
+{
+   const char *input = "{ \"Name\": \"first\\n\",\n  \"Values\": [1, -20, 300, true, false, null],\n  \"Empty\": {}\n}\n";
+   size_t inputLen = strlen(input);
+   size_t i;
+   dtl_json_parser_t *parser;
+   dtl_json_parser_status_t status = DTL_JSON_PARSER_NEED_MORE;
+   dtl_dv_t *result;
+   dtl_hv_t *hv;
+   dtl_av_t *av;
+   bool ok;
+
+   parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, parser);
+   for (i = 0; i < inputLen; i++)
+   {
+      status = dtl_json_parser_feed(parser, (const uint8_t*) &input[i], 1u);
+      if (i < (inputLen - 2))
+      {
+         CuAssertIntEquals(tc, DTL_JSON_PARSER_NEED_MORE, status);
+         CuAssertPtrEquals(tc, 0, dtl_json_parser_result(parser));
+      }
+      else
+      {
+         //done as soon as the closing brace arrives, the trailing newline keeps it done
+         CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, status);
+      }
+   }
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, status);
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, dtl_json_parser_finish(parser));
+   result = dtl_json_parser_result(parser);
+   dtl_json_parser_delete(parser);
+   CuAssertPtrNotNull(tc, result);
+   CuAssertIntEquals(tc, DTL_DV_HASH, dtl_dv_type(result));
+   hv = (dtl_hv_t*) result;
+   CuAssertIntEquals(tc, 3, dtl_hv_length(hv));
+   CuAssertStrEquals(tc, "first\n", dtl_sv_to_cstr((dtl_sv_t*) dtl_hv_get_cstr(hv, "Name"), &ok));
+   av = (dtl_av_t*) dtl_hv_get_cstr(hv, "Values");
+   CuAssertPtrNotNull(tc, av);
+   CuAssertIntEquals(tc, 6, dtl_av_length(av));
+   CuAssertIntEquals(tc, -20, dtl_sv_to_i32((dtl_sv_t*) dtl_av_value(av, 1), &ok));
+   CuAssertIntEquals(tc, 300, dtl_sv_to_i32((dtl_sv_t*) dtl_av_value(av, 2), &ok));
+   CuAssertIntEquals(tc, DTL_SV_BOOL, dtl_sv_type((dtl_sv_t*) dtl_av_value(av, 3)));
+   CuAssertIntEquals(tc, DTL_SV_NONE, dtl_sv_type((dtl_sv_t*) dtl_av_value(av, 5)));
+   dtl_dec_ref(result);
+}
+
+static void test_json_parser_feed_number(CuTest* tc)
+{
+   dtl_json_parser_t *parser;
+   dtl_dv_t *result;
+   bool ok;
+
+   parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, parser);
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_NEED_MORE, dtl_json_parser_feed(parser, (const uint8_t*) " 12", 3u));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_NEED_MORE, dtl_json_parser_feed(parser, (const uint8_t*) "34", 2u));
+   CuAssertPtrEquals(tc, 0, dtl_json_parser_result(parser));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, dtl_json_parser_finish(parser));
+   result = dtl_json_parser_result(parser);
+   CuAssertPtrNotNull(tc, result);
+   CuAssertIntEquals(tc, 1234, dtl_sv_to_i32((dtl_sv_t*) result, &ok));
+   dtl_dec_ref(result);
+   dtl_json_parser_delete(parser);
+}
+
+static void test_json_parser_feed_errors(CuTest* tc)
+{
+   dtl_json_parser_t *parser;
+
+   parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, parser);
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_NEED_MORE, dtl_json_parser_feed(parser, (const uint8_t*) "[1, 2", 5u));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_ERROR, dtl_json_parser_feed(parser, (const uint8_t*) " x]", 3u));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, dtl_json_parser_last_error(parser));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_ERROR, dtl_json_parser_finish(parser));
+   CuAssertPtrEquals(tc, 0, dtl_json_parser_result(parser));
+   dtl_json_parser_delete(parser);
+
+   parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, parser);
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_NEED_MORE, dtl_json_parser_feed(parser, (const uint8_t*) "{\"a\": tr", 8u));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_ERROR, dtl_json_parser_finish(parser));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, dtl_json_parser_last_error(parser));
+   dtl_json_parser_delete(parser);
+
+   parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, parser);
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_NEED_MORE, dtl_json_parser_feed(parser, (const uint8_t*) "{\"a\": [", 7u));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_ERROR, dtl_json_parser_finish(parser));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_EOB_ERROR, dtl_json_parser_last_error(parser));
+   dtl_json_parser_delete(parser);
+}
+
+static void test_json_parser_feed_after_done(CuTest* tc)
+{
+   dtl_json_parser_t *parser;
+   dtl_dv_t *result;
+
+   parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, parser);
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, dtl_json_parser_feed(parser, (const uint8_t*) "[1]", 3u));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, dtl_json_parser_feed(parser, (const uint8_t*) " \n", 2u));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, dtl_json_parser_finish(parser));
+   result = dtl_json_parser_result(parser);
+   CuAssertPtrNotNull(tc, result);
+   CuAssertIntEquals(tc, DTL_DV_ARRAY, dtl_dv_type(result));
+   dtl_dec_ref(result);
+   dtl_json_parser_delete(parser);
+
+   parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, parser);
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, dtl_json_parser_feed(parser, (const uint8_t*) "{}", 2u));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_ERROR, dtl_json_parser_feed(parser, (const uint8_t*) "x", 1u));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, dtl_json_parser_last_error(parser));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_ERROR, dtl_json_parser_finish(parser));
+   CuAssertPtrEquals(tc, 0, dtl_json_parser_result(parser));
+   dtl_json_parser_delete(parser);
+
+   parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, parser);
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, dtl_json_parser_feed(parser, (const uint8_t*) "[1] ", 4u));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_ERROR, dtl_json_parser_feed(parser, (const uint8_t*) "[2]", 3u));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, dtl_json_parser_last_error(parser));
+   CuAssertPtrEquals(tc, 0, dtl_json_parser_result(parser));
+   dtl_json_parser_delete(parser);
+
+   parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, parser);
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_NEED_MORE, dtl_json_parser_feed(parser, (const uint8_t*) "42", 2u)); //more digits may follow
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, dtl_json_parser_feed(parser, (const uint8_t*) " ", 1u));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_DONE, dtl_json_parser_finish(parser));
+   dtl_json_parser_delete(parser);
+}
+
+static void test_json_parse_events(CuTest* tc)
+{
+   const char *input = "{\"Name\": \"first\", \"Esc\\naped\": \"a\\tb\", \"List\": [1, -2, 0.5, -1e3, -9223372036854775808, 18446744073709551615, true, false, null, [], {}]}";
+   const char *input2 = "[\"a\\u0000b\"]";
+   dtl_json_handler_t handler;
+   adt_str_t *log = adt_str_new();
+
+   event_handler_create(&handler);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_parse_bstr((const uint8_t*) input, (const uint8_t*) input + strlen(input), &handler, log));
+   CuAssertStrEquals(tc, "{ K(Name) S(first) K(Esc\naped) S(a\tb) K(List) [ I(1) I(-2) D(0.5) D(-1000) I(-9223372036854775808) U(18446744073709551615) B(1) B(0) N [ ] { } ] } ", adt_str_cstr(log));
+
+   adt_str_clear(log);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_parse_bstr((const uint8_t*) " 42 ", (const uint8_t*) " 42 " + 4, &handler, log));
+   CuAssertStrEquals(tc, "I(42) ", adt_str_cstr(log));
+
+   adt_str_clear(log);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_parse_bstr((const uint8_t*) input2, (const uint8_t*) input2 + strlen(input2), &handler, log));
+   CuAssertIntEquals(tc, 11, adt_str_length(log));
+   CuAssertTrue(tc, memcmp(adt_str_cstr(log), "[ S(a\0b) ] ", 11u) == 0);
+   adt_str_delete(log);
+}
+
+static void test_json_parse_events_from_file(CuTest* tc)
+{
+   const int32_t numElems = 1000;
+   int32_t i;
+   FILE *fh;
+   dtl_json_handler_t handler;
+   adt_str_t *log = adt_str_new();
+   adt_str_t *expected = adt_str_new();
+
+   event_handler_create(&handler);
+   fh = tmpfile();
+   CuAssertPtrNotNull(tc, fh);
+   fprintf(fh, "[\n");
+   adt_str_append_cstr(expected, "[ ");
+   for (i = 0; i < numElems; i++)
+   {
+      char buf[64];
+      fprintf(fh, "   {\"Id\": %d, \"Name\": \"element %d\"}%s\n", (int) i, (int) i, (i < (numElems - 1)) ? "," : "");
+      sprintf(buf, "{ K(Id) I(%d) K(Name) S(element %d) } ", (int) i, (int) i);
+      adt_str_append_cstr(expected, buf);
+   }
+   fprintf(fh, "]\n");
+   adt_str_append_cstr(expected, "] ");
+   rewind(fh);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_parse(fh, &handler, log));
+   fclose(fh);
+   CuAssertStrEquals(tc, adt_str_cstr(expected), adt_str_cstr(log));
+   adt_str_delete(log);
+   adt_str_delete(expected);
+}
+
+static void test_json_parse_events_error(CuTest* tc)
+{
+   const char *input1 = "[1, 2";
+   const char *input2 = "[1, x]";
+   dtl_json_handler_t handler;
+   adt_str_t *log = adt_str_new();
+
+   event_handler_create(&handler);
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_EOB_ERROR, dtl_json_parse_bstr((const uint8_t*) input1, (const uint8_t*) input1 + strlen(input1), &handler, log));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, dtl_json_parse_bstr((const uint8_t*) input2, (const uint8_t*) input2 + strlen(input2), &handler, log));
+   adt_str_delete(log);
+}
+
+static void test_json_load_lines(CuTest* tc)
+{
+   lines_log_t lines = {0, false, 0u, 0u};
+   lines.log = adt_str_new();
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, lines_load_cstr(&lines, "{\"a\": 1}\n\n  [true, \"x\"]\r\n \t \n42\n\"last\""));
+   CuAssertStrEquals(tc, "1:{\"a\": 1} 3:[true, \"x\"] 5:42 6:\"last\" ", adt_str_cstr(lines.log));
+   adt_str_clear(lines.log);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, lines_load_cstr(&lines, "{\"a\": [1, {\"b\": 2}]}\n{\"a\": [3, {\"b\": 4}]}\n"));
+   CuAssertStrEquals(tc, "1:{\"a\": [1, {\"b\": 2}]} 2:{\"a\": [3, {\"b\": 4}]} ", adt_str_cstr(lines.log));
+   adt_str_clear(lines.log);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, lines_load_cstr(&lines, ""));
+   CuAssertStrEquals(tc, "", adt_str_cstr(lines.log));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines_bstr((const uint8_t*) "1", (const uint8_t*) "1" + 1, (dtl_json_line_func_t) 0, 0));
+   adt_str_delete(lines.log);
+}
+
+/**
+ * Records spanning several lines are malformed, each of their lines is reported separately.
+ */
+static void test_json_load_lines_errors(CuTest* tc)
+{
+   const char *input = "{\"a\": 1}\n{\"a\": \n2}\n[1, x]\n{\"a\": 3} 4\n{\"a\": 5}";
+   lines_log_t lines = {0, true, 0u, 0u};
+   lines.log = adt_str_new();
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, lines_load_cstr(&lines, input));
+   CuAssertStrEquals(tc, "1:{\"a\": 1} 2:E3 3:E2 4:E2 5:E2 6:{\"a\": 5} ", adt_str_cstr(lines.log));
+   adt_str_clear(lines.log);
+   lines.skipErrors = false;
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_EOB_ERROR, lines_load_cstr(&lines, input));
+   CuAssertStrEquals(tc, "1:{\"a\": 1} 2:E3 ", adt_str_cstr(lines.log));
+   adt_str_delete(lines.log);
+}
+
+static void test_json_load_lines_stop(CuTest* tc)
+{
+   lines_log_t lines = {0, false, 2u, 0u};
+   lines.log = adt_str_new();
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, lines_load_cstr(&lines, "1\n2\n3\nnot json"));
+   CuAssertStrEquals(tc, "1:1 2:2 ", adt_str_cstr(lines.log));
+   adt_str_delete(lines.log);
+}
+
+static void test_json_load_lines_from_file(CuTest* tc)
+{
+   const int32_t numRecords = 500;
+   int32_t i;
+   FILE *fh;
+   lines_log_t lines = {0, true, 0u, 0u};
+   adt_str_t *expected = adt_str_new();
+   lines.log = adt_str_new();
+   fh = tmpfile();
+   CuAssertPtrNotNull(tc, fh);
+   for (i = 0; i < numRecords; i++)
+   {
+      char buf[128];
+      if (i == 100)
+      {
+         fprintf(fh, "{\"Id\": %d, \"Name\": \"broken\"\n", (int) i);
+         sprintf(buf, "%d:E3 ", (int) i + 1);
+      }
+      else
+      {
+         fprintf(fh, "{\"Id\": %d, \"Name\": \"record %d\"}\n", (int) i, (int) i);
+         sprintf(buf, "%d:{\"Id\": %d, \"Name\": \"record %d\"} ", (int) i + 1, (int) i, (int) i);
+      }
+      adt_str_append_cstr(expected, buf);
+   }
+   fprintf(fh, "[\"unterminated last line\"]");
+   adt_str_append_cstr(expected, "501:[\"unterminated last line\"] ");
+   rewind(fh);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_load_lines(fh, lines_log_record, &lines));
+   fclose(fh);
+   CuAssertStrEquals(tc, adt_str_cstr(expected), adt_str_cstr(lines.log));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines((FILE*) 0, lines_log_record, &lines));
+   adt_str_delete(lines.log);
+   adt_str_delete(expected);
+}
+
+/**
+ * Input is large enough to be split between four threads. Ordered mode must give the same result as dtl_json_load_lines_bstr.
+ */
+static void test_json_load_lines_parallel(CuTest* tc)
+{
+   const int32_t numRecords = 20000;
+   int32_t i;
+   const uint8_t *pBegin;
+   const uint8_t *pEnd;
+   lines_log_t lines = {0, true, 0u, 0u};
+   adt_str_t *input = adt_str_new();
+   adt_str_t *expected;
+   for (i = 0; i < numRecords; i++)
+   {
+      char buf[128];
+      if (i == 7000)
+      {
+         sprintf(buf, "{\"Id\": %d, \"Name\": \"broken\"\n", (int) i);
+      }
+      else if (i == 13000)
+      {
+         sprintf(buf, " \n");
+      }
+      else
+      {
+         sprintf(buf, "{\"Id\": %d, \"Name\": \"record %d\"}\n", (int) i, (int) i);
+      }
+      adt_str_append_cstr(input, buf);
+   }
+   adt_str_append_cstr(input, "[\"unterminated last line\"]");
+   pBegin = (const uint8_t*) adt_str_cstr(input);
+   pEnd = pBegin + strlen(adt_str_cstr(input));
+   CuAssertTrue(tc, (pEnd - pBegin) > 4 * 65536);
+
+   expected = adt_str_new();
+   lines.log = expected;
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_load_lines_bstr(pBegin, pEnd, lines_log_record, &lines));
+   CuAssertIntEquals(tc, numRecords - 1, (int) lines.numRecords);
+
+   lines.log = adt_str_new();
+   lines.numRecords = 0u;
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_load_lines_parallel(pBegin, pEnd, 4u, true, lines_log_record, &lines));
+   CuAssertStrEquals(tc, adt_str_cstr(expected), adt_str_cstr(lines.log));
+
+   adt_str_clear(lines.log);
+   lines.numRecords = 0u;
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_load_lines_parallel(pBegin, pEnd, 4u, false, lines_log_record, &lines));
+   CuAssertIntEquals(tc, numRecords - 1, (int) lines.numRecords);
+   CuAssertIntEquals(tc, (int) strlen(adt_str_cstr(expected)), (int) strlen(adt_str_cstr(lines.log)));
+
+   adt_str_clear(lines.log);
+   lines.skipErrors = false;
+   lines.numRecords = 0u;
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_EOB_ERROR, dtl_json_load_lines_parallel(pBegin, pEnd, 4u, true, lines_log_record, &lines));
+   CuAssertIntEquals(tc, 7000, (int) lines.numRecords);
+   CuAssertPtrNotNull(tc, strstr(adt_str_cstr(lines.log), " 7001:E3 "));
+
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines_parallel(pBegin, pEnd, 4u, true, (dtl_json_line_func_t) 0, 0));
+   adt_str_delete(lines.log);
+   adt_str_delete(expected);
+   adt_str_delete(input);
+}
+
+/**
+ * Documents must be larger than 256 kB per thread to be split. Results must be identical to dtl_json_load_bstr.
+ */
+static void test_json_load_lines_null_arguments(CuTest* tc)
+{
+   const uint8_t *pBegin = (const uint8_t*) "1\n2\n";
+   const uint8_t *pEnd = pBegin + 4;
+   lines_log_t lines;
+   memset(&lines, 0, sizeof(lines));
+   lines.log = adt_str_new();
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines((FILE*) 0, lines_log_record, &lines));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines(stdin, (dtl_json_line_func_t) 0, 0));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines_bstr((const uint8_t*) 0, pEnd, lines_log_record, &lines));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines_bstr(pEnd, pBegin, lines_log_record, &lines));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines_parallel((const uint8_t*) 0, pEnd, 2u, true, lines_log_record, &lines));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines_parallel(pBegin, pEnd, 2u, false, (dtl_json_line_func_t) 0, 0));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines_file((const char*) 0, 2u, true, lines_log_record, &lines));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_lines_file("lines.jsonl", 2u, true, (dtl_json_line_func_t) 0, 0));
+   CuAssertStrEquals(tc, "", adt_str_cstr(lines.log));
+   adt_str_delete(lines.log);
+}
+
+static void test_json_load_parallel(CuTest* tc)
+{
+   const int32_t numElems = 40000;
+   int32_t i;
+   int32_t pass;
+   for (pass = 0; pass < 2; pass++)
+   {
+      bool isObject = (pass == 1);
+      adt_str_t *input = adt_str_new();
+      adt_str_t *expected;
+      adt_str_t *result;
+      const uint8_t *pBegin;
+      const uint8_t *pEnd;
+      dtl_dv_t *dv;
+      adt_str_append_cstr(input, isObject? " {\n" : " [\n");
+      for (i = 0; i < numElems; i++)
+      {
+         char buf[128];
+         if (isObject)
+         {
+            sprintf(buf, "%s\"key%d\": {\"Id\": %d, \"Tags\": [\"a,b\", \"]\"], \"Value\": %d.5}", (i > 0)? ",\n" : "", (int) i, (int) i, (int) i);
+         }
+         else
+         {
+            sprintf(buf, "%s{\"Id\": %d, \"Tags\": [\"a,b\", \"]\"]}, %d, \"x\\\",y\"", (i > 0)? ",\n" : "", (int) i, (int) i);
+         }
+         adt_str_append_cstr(input, buf);
+      }
+      adt_str_append_cstr(input, isObject? "\n}\n" : "\n]\n");
+      pBegin = (const uint8_t*) adt_str_cstr(input);
+      pEnd = pBegin + strlen(adt_str_cstr(input));
+      CuAssertTrue(tc, (pEnd - pBegin) > 4 * 262144);
+
+      dv = dtl_json_load_bstr(pBegin, pEnd);
+      CuAssertPtrNotNull(tc, dv);
+      expected = dtl_json_dumps(dv, 0, true);
+      dtl_dv_dec_ref(dv);
+      dv = dtl_json_load_parallel(pBegin, pEnd, 4u);
+      CuAssertPtrNotNull(tc, dv);
+      CuAssertIntEquals(tc, isObject? numElems : numElems * 3, isObject? dtl_hv_length((dtl_hv_t*) dv) : dtl_av_length((dtl_av_t*) dv));
+      result = dtl_json_dumps(dv, 0, true);
+      dtl_dv_dec_ref(dv);
+      CuAssertStrEquals(tc, adt_str_cstr(expected), adt_str_cstr(result));
+      adt_str_delete(expected);
+      adt_str_delete(result);
+
+      //malformed element in the middle of the document
+      ((char*) strstr((const char*) pBegin + (pEnd - pBegin) / 2, "\"Id\""))[0] = '#';
+      CuAssertPtrEquals(tc, 0, dtl_json_load_parallel(pBegin, pEnd, 4u));
+      adt_str_delete(input);
+   }
+}
+
+/**
+ * A reader keeps working after an error, with both engines.
+ */
+static void test_json_reader_reuse(CuTest* tc)
+{
+   const char *documents[5] = {"{\"Id\": 1, \"Name\": \"a\"}", "[1, 2, {\"Id\": 2}]", "{\"Id\": 3, \"Name\": ", "{\"Id\": 4, \"Name\": \"d\"}", "\"text\""};
+   const char *expected[5] = {"{\"Id\": 1, \"Name\": \"a\"}", "[1, 2, {\"Id\": 2}]", 0, "{\"Id\": 4, \"Name\": \"d\"}", "\"text\""};
+   dtl_json_reader_t *reader = dtl_json_reader_new();
+   int32_t engine;
+   CuAssertPtrNotNull(tc, reader);
+   for (engine = 0; engine < 2; engine++)
+   {
+      int32_t i;
+      dtl_json_reader_set_engine(reader, (engine == 0)? DTL_JSON_ENGINE_STATE_MACHINE : DTL_JSON_ENGINE_STRUCTURAL_INDEX);
+      for (i = 0; i < 5; i++)
+      {
+         dtl_dv_t *dv = dtl_json_reader_load_cstr(reader, documents[i]);
+         if (expected[i] == 0)
+         {
+            CuAssertPtrEquals(tc, 0, dv);
+            CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_EOB_ERROR, dtl_json_reader_last_error(reader));
+         }
+         else
+         {
+            adt_str_t *output;
+            CuAssertPtrNotNull(tc, dv);
+            CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_reader_last_error(reader));
+            output = dtl_json_dumps(dv, 0, true);
+            CuAssertStrEquals(tc, expected[i], adt_str_cstr(output));
+            adt_str_delete(output);
+            dtl_dv_dec_ref(dv);
+         }
+      }
+   }
+   CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr((dtl_json_reader_t*) 0, "1"));
+   dtl_json_reader_delete(reader);
+}
+
+static void test_json_reader_limits(CuTest* tc)
+{
+   dtl_json_reader_t *reader = dtl_json_reader_new();
+   int engine;
+   CuAssertPtrNotNull(tc, reader);
+   for (engine = 0; engine < 2; engine++)
+   {
+      dtl_json_limits_t limits;
+      dtl_dv_t *dv;
+      dtl_json_reader_set_engine(reader, (engine == 0)? DTL_JSON_ENGINE_STATE_MACHINE : DTL_JSON_ENGINE_STRUCTURAL_INDEX);
+      memset(&limits, 0, sizeof(limits));
+      limits.maxDepth = 3u;
+      dtl_json_reader_set_limits(reader, &limits);
+      dv = dtl_json_reader_load_cstr(reader, "[[1], {\"a\": []}]");
+      CuAssertPtrNotNull(tc, dv);
+      dtl_dv_dec_ref(dv);
+      CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, "[[1], {\"a\": [[]]}]"));
+      CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_reader_last_error(reader));
+      CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, "[[[[]]]]"));
+      CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_reader_last_error(reader));
+
+      memset(&limits, 0, sizeof(limits));
+      limits.maxStringLength = 4u;
+      dtl_json_reader_set_limits(reader, &limits);
+      dv = dtl_json_reader_load_cstr(reader, "{\"abcd\": \"abcd\"}");
+      CuAssertPtrNotNull(tc, dv);
+      dtl_dv_dec_ref(dv);
+      CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, "[\"abcde\"]"));
+      CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_reader_last_error(reader));
+      CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, "{\"abcde\": 1}"));
+      CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_reader_last_error(reader));
+      CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, "[\"a\\u0041\"]")); //length is counted before unescaping
+      CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_reader_last_error(reader));
+
+      memset(&limits, 0, sizeof(limits));
+      limits.maxElements = 4u;
+      dtl_json_reader_set_limits(reader, &limits);
+      dv = dtl_json_reader_load_cstr(reader, "[1, \"a\", null]");
+      CuAssertPtrNotNull(tc, dv);
+      dtl_dv_dec_ref(dv);
+      CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, "[1, \"a\", null, true]"));
+      CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_reader_last_error(reader));
+      CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, "[1, -2, 3.5, 18446744073709551615]"));
+      CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_reader_last_error(reader));
+      CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, "{\"a\": {\"b\": [], \"c\": {}, \"d\": 0}}"));
+      CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_reader_last_error(reader));
+
+      memset(&limits, 0, sizeof(limits));
+      limits.maxBytes = 1024u;
+      dtl_json_reader_set_limits(reader, &limits);
+      dv = dtl_json_reader_load_cstr(reader, "[\"abcdefgh\", \"abcdefgh\"]");
+      CuAssertPtrNotNull(tc, dv);
+      dtl_dv_dec_ref(dv);
+      CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, "[0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29]"));
+      CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_reader_last_error(reader));
+
+      dtl_json_reader_set_limits(reader, (const dtl_json_limits_t*) 0);
+      dv = dtl_json_reader_load_cstr(reader, "[[[[\"abcdefgh\"]]], 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24]");
+      CuAssertPtrNotNull(tc, dv);
+      dtl_dv_dec_ref(dv);
+   }
+   dtl_json_reader_delete(reader);
+}
+
+/**
+ * An unfinished token held between chunks counts against maxBytes.
+ */
+static void test_json_parser_limits(CuTest* tc)
+{
+   char chunk[128];
+   dtl_json_limits_t limits;
+   dtl_json_parser_t *parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, parser);
+   memset(&limits, 0, sizeof(limits));
+   limits.maxBytes = 256u;
+   dtl_json_parser_set_limits(parser, &limits);
+   memset(chunk, 'a', sizeof(chunk));
+   chunk[0] = '[';
+   chunk[1] = '"';
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_NEED_MORE, dtl_json_parser_feed(parser, (const uint8_t*) chunk, (uint32_t) sizeof(chunk)));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_ERROR, dtl_json_parser_feed(parser, (const uint8_t*) chunk + 2, (uint32_t) sizeof(chunk) - 2u));
+   CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, dtl_json_parser_last_error(parser));
+   dtl_json_parser_delete(parser);
+}
+
+static void event_begin_object(void *arg)
+{
+   adt_str_append_cstr((adt_str_t*) arg, "{ ");
+}
+
+static void event_end_object(void *arg)
+{
+   adt_str_append_cstr((adt_str_t*) arg, "} ");
+}
+
+static void event_begin_array(void *arg)
+{
+   adt_str_append_cstr((adt_str_t*) arg, "[ ");
+}
+
+static void event_end_array(void *arg)
+{
+   adt_str_append_cstr((adt_str_t*) arg, "] ");
+}
+
+static void event_key(void *arg, const char *pKey, uint32_t keyLen)
+{
+   adt_str_append_cstr((adt_str_t*) arg, "K(");
+   adt_str_append_bstr((adt_str_t*) arg, (const uint8_t*) pKey, (const uint8_t*) pKey + keyLen);
+   adt_str_append_cstr((adt_str_t*) arg, ") ");
+}
+
+static void event_string(void *arg, const char *pStr, uint32_t strLen)
+{
+   adt_str_append_cstr((adt_str_t*) arg, "S(");
+   adt_str_append_bstr((adt_str_t*) arg, (const uint8_t*) pStr, (const uint8_t*) pStr + strLen);
+   adt_str_append_cstr((adt_str_t*) arg, ") ");
+}
+
+static void event_int(void *arg, int64_t value)
+{
+   char buf[32];
+   sprintf(buf, "I(%lld) ", (long long) value);
+   adt_str_append_cstr((adt_str_t*) arg, buf);
+}
+
+static void event_double(void *arg, double value)
+{
+   char buf[64];
+   sprintf(buf, "D(%g) ", value);
+   adt_str_append_cstr((adt_str_t*) arg, buf);
+}
+
+static void event_uint(void *arg, uint64_t value)
+{
+   char buf[32];
+   sprintf(buf, "U(%llu) ", (unsigned long long) value);
+   adt_str_append_cstr((adt_str_t*) arg, buf);
+}
+
+static void event_bool(void *arg, bool value)
+{
+   adt_str_append_cstr((adt_str_t*) arg, value? "B(1) " : "B(0) ");
+}
+
+static void event_null(void *arg)
+{
+   adt_str_append_cstr((adt_str_t*) arg, "N ");
+}
+
+static void event_handler_create(dtl_json_handler_t *handler)
+{
+   memset(handler, 0, sizeof(dtl_json_handler_t));
+   handler->on_begin_object = event_begin_object;
+   handler->on_end_object = event_end_object;
+   handler->on_begin_array = event_begin_array;
+   handler->on_end_array = event_end_array;
+   handler->on_key = event_key;
+   handler->on_string = event_string;
+   handler->on_int = event_int;
+   handler->on_bool = event_bool;
+   handler->on_null = event_null;
+   handler->on_double = event_double;
+   handler->on_uint = event_uint;
+}
+
+/**
+ * Logs record as "line:json " and malformed line as "line:Ecode ".
+ */
+static bool lines_log_record(void *arg, uint32_t lineNumber, dtl_dv_t *dv, dtl_json_error_t errorCode)
+{
+   lines_log_t *lines = (lines_log_t*) arg;
+   char buf[32];
+   if (dv == 0)
+   {
+      sprintf(buf, "%u:E%d ", (unsigned int) lineNumber, (int) errorCode);
+      adt_str_append_cstr(lines->log, buf);
+      return lines->skipErrors;
+   }
+   else
+   {
+      adt_str_t *output = dtl_json_dumps(dv, 0, false);
+      sprintf(buf, "%u:", (unsigned int) lineNumber);
+      adt_str_append_cstr(lines->log, buf);
+      if (output != 0)
+      {
+         adt_str_append_cstr(lines->log, adt_str_cstr(output));
+         adt_str_delete(output);
+      }
+      adt_str_append_cstr(lines->log, " ");
+      lines->numRecords++;
+      return (lines->maxRecords == 0u) || (lines->numRecords < lines->maxRecords);
+   }
+}
+
+static dtl_json_error_t lines_load_cstr(lines_log_t *lines, const char *input)
+{
+   lines->numRecords = 0u;
+   return dtl_json_load_lines_bstr((const uint8_t*) input, (const uint8_t*) input + strlen(input), lines_log_record, lines);
+}
@@ -0,0 +1,240 @@
+/*****************************************************************************
+* \file      testsuite_dtl_json_scan.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Unit tests for dtl_json_scan
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "dtl_json_scan.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_json_scan_whitespace(CuTest* tc);
+static void test_json_scan_whitespace_long_runs(CuTest* tc);
+static void test_json_scan_whitespace_random(CuTest* tc);
+static void test_json_scan_string_end(CuTest* tc);
+static void test_json_scan_string_special_random(CuTest* tc);
+static void test_json_scan_bracket_random(CuTest* tc);
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_dtl_json_scan(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_json_scan_whitespace);
+   SUITE_ADD_TEST(suite, test_json_scan_whitespace_long_runs);
+   SUITE_ADD_TEST(suite, test_json_scan_whitespace_random);
+   SUITE_ADD_TEST(suite, test_json_scan_string_end);
+   SUITE_ADD_TEST(suite, test_json_scan_string_special_random);
+   SUITE_ADD_TEST(suite, test_json_scan_bracket_random);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_scan_whitespace(CuTest* tc)
+{
+   const char *text = " \t\r\n  \n x";
+   const uint8_t *pBegin = (const uint8_t*) text;
+   const uint8_t *pEnd = pBegin + strlen(text);
+   uint32_t newLines = 0u;
+   CuAssertTrue(tc, dtl_json_scan_whitespace(pBegin, pEnd, &newLines) == pEnd - 1);
+   CuAssertUIntEquals(tc, 2u, newLines);
+   newLines = 0u;
+   CuAssertTrue(tc, dtl_json_scan_whitespace(pEnd - 1, pEnd, &newLines) == pEnd - 1);
+   CuAssertTrue(tc, dtl_json_scan_whitespace(pEnd, pEnd, &newLines) == pEnd);
+   CuAssertTrue(tc, dtl_json_scan_whitespace(pBegin, pBegin + 4, &newLines) == pBegin + 4);
+   CuAssertUIntEquals(tc, 1u, newLines);
+}
+
+static void test_json_scan_whitespace_long_runs(CuTest* tc)
+{
+   uint8_t buf[200];
+   uint32_t i;
+   for (i = 0u; i < 150u; i++)
+   {
+      uint32_t newLines = 0u;
+      uint32_t expectedNewLines = 0u;
+      uint32_t j;
+      for (j = 0u; j < i; j++)
+      {
+         buf[j] = ( (j % 7u) == 3u)? '\n' : ' ';
+         if (buf[j] == '\n')
+         {
+            expectedNewLines++;
+         }
+      }
+      memset(&buf[i], '{', sizeof(buf) - i);
+      CuAssertTrue(tc, dtl_json_scan_whitespace(buf, buf + sizeof(buf), &newLines) == &buf[i]);
+      CuAssertUIntEquals(tc, expectedNewLines, newLines);
+   }
+}
+
+/**
+ * Compares the vectorized implementation against the scalar one
+ */
+static void test_json_scan_whitespace_random(CuTest* tc)
+{
+   const char alphabet[] = " \n\r\t\n  x";
+   uint8_t buf[256];
+   int32_t iteration;
+   srand(1234);
+   for (iteration = 0; iteration < 2000; iteration++)
+   {
+      size_t len = (size_t) (rand() % (int) sizeof(buf));
+      size_t offset = (len == 0u)? 0u : (size_t) (rand() % (int) len);
+      size_t i;
+      uint32_t expectedNewLines = 0u;
+      uint32_t newLines = 0u;
+      const uint8_t *pExpected;
+      for (i = 0u; i < len; i++)
+      {
+         //mostly whitespace so that long runs are produced
+         buf[i] = (uint8_t) alphabet[(rand() % 64 == 0)? 7 : rand() % 7];
+      }
+      pExpected = dtl_json_scan_whitespace_scalar(buf + offset, buf + len, &expectedNewLines);
+      CuAssertTrue(tc, dtl_json_scan_whitespace(buf + offset, buf + len, &newLines) == pExpected);
+      CuAssertUIntEquals(tc, expectedNewLines, newLines);
+   }
+}
+
+static void test_json_scan_string_end(CuTest* tc)
+{
+   const char *plain = "\"The quick brown fox jumps over the lazy dog\", 1";
+   const char *escaped = "\"The quick brown \\\"fox\\\" jumps over the lazy dog\\\\\"";
+   const char *control = "\"The quick brown fox\tjumps over the lazy dog\"";
+   const char *unterminated = "\"The quick brown fox jumps over the lazy dog\\\"";
+   const uint8_t *pBegin;
+   const uint8_t *pEnd;
+   bool isPlain = false;
+
+   pBegin = (const uint8_t*) plain;
+   pEnd = pBegin + strlen(plain);
+   CuAssertTrue(tc, dtl_json_scan_string_end(pBegin, pEnd, &isPlain) == pEnd - 3);
+   CuAssertTrue(tc, isPlain);
+
+   pBegin = (const uint8_t*) escaped;
+   pEnd = pBegin + strlen(escaped);
+   CuAssertTrue(tc, dtl_json_scan_string_end(pBegin, pEnd, &isPlain) == pEnd);
+   CuAssertTrue(tc, !isPlain);
+
+   pBegin = (const uint8_t*) control;
+   pEnd = pBegin + strlen(control);
+   CuAssertTrue(tc, dtl_json_scan_string_end(pBegin, pEnd, &isPlain) == pEnd);
+   CuAssertTrue(tc, !isPlain);
+
+   pBegin = (const uint8_t*) unterminated;
+   pEnd = pBegin + strlen(unterminated);
+   CuAssertTrue(tc, dtl_json_scan_string_end(pBegin, pEnd, &isPlain) == 0);
+   CuAssertTrue(tc, dtl_json_scan_string_end(pBegin, pBegin + 1, &isPlain) == 0);
+}
+
+/**
+ * Compares the vectorized implementation against the scalar one
+ */
+static void test_json_scan_string_special_random(CuTest* tc)
+{
+   uint8_t buf[256];
+   int32_t iteration;
+   srand(4321);
+   for (iteration = 0; iteration < 2000; iteration++)
+   {
+      size_t len = (size_t) (rand() % (int) sizeof(buf));
+      size_t i;
+      const uint8_t *pExpected;
+      const uint8_t *pResult;
+      bool isPlain = false;
+      buf[0] = '"';
+      for (i = 1u; i < len; i++)
+      {
+         int r = rand() % 200;
+         buf[i] = (r == 0)? '"' : (r == 1)? '\\' : (r == 2)? (uint8_t) (rand() % 0x20) : (uint8_t) (0x20 + rand() % 0xE0);
+      }
+      pExpected = dtl_json_scan_string_special_scalar(buf + 1, buf + len);
+      pResult = dtl_json_scan_string_end(buf, buf + len, &isPlain);
+      if ( (pExpected < buf + len) && (*pExpected == '"') )
+      {
+         CuAssertTrue(tc, pResult == pExpected + 1);
+         CuAssertTrue(tc, isPlain);
+      }
+      else if (pExpected == buf + len)
+      {
+         CuAssertTrue(tc, pResult == 0);
+      }
+      else if (pResult != 0)
+      {
+         CuAssertTrue(tc, !isPlain);
+      }
+   }
+}
+
+static void test_json_scan_bracket_random(CuTest* tc)
+{
+   const char alphabet[] = "ab\n 1,:\\\"[]{}";
+   uint8_t buf[256];
+   int32_t iteration;
+   srand(1234);
+   for (iteration = 0; iteration < 2000; iteration++)
+   {
+      size_t len = (size_t) (rand() % (int) sizeof(buf));
+      size_t offset = (len == 0u)? 0u : (size_t) (rand() % (int) len);
+      size_t i;
+      uint32_t expectedNewLines = 0u;
+      uint32_t newLines = 0u;
+      const uint8_t *pExpected;
+      for (i = 0u; i < len; i++)
+      {
+         //brackets and quotes are rare so that long runs without them are produced
+         buf[i] = (uint8_t) alphabet[(rand() % 32 == 0)? 8 + rand() % 5 : rand() % 8];
+      }
+      pExpected = dtl_json_scan_bracket_scalar(buf + offset, buf + len, &expectedNewLines);
+      CuAssertTrue(tc, dtl_json_scan_bracket(buf + offset, buf + len, &newLines) == pExpected);
+      CuAssertUIntEquals(tc, expectedNewLines, newLines);
+   }
+}
@@ -0,0 +1,351 @@
+/*****************************************************************************
+* \file      testsuite_dtl_json_schema.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Unit tests for dtl_json_decode and dtl_json_encoder_write
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include "CuTest.h"
+#include "dtl_json.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+typedef struct point_tag
+{
+   int32_t x;
+   int32_t y;
+} point_t;
+
+typedef struct record_tag
+{
+   char name[8];
+   uint32_t id;
+   int64_t offset;
+   uint64_t size;
+   double ratio;
+   bool isEnabled;
+   point_t origin;
+   int32_t values[4];
+   uint32_t numValues;
+   point_t points[2];
+   uint32_t numPoints;
+   char tags[2][4];
+   uint32_t numTags;
+} record_t;
+
+static const dtl_json_field_t m_pointFields[] = {
+   {"x", offsetof(point_t, x), DTL_JSON_FIELD_I32, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+   {"y", offsetof(point_t, y), DTL_JSON_FIELD_I32, 0u, (const dtl_json_schema_t*) 0, 0u, 0u}
+};
+
+static const dtl_json_schema_t m_pointSchema = {m_pointFields, 2u};
+
+static const dtl_json_field_t m_recordFields[] = {
+   {"name", offsetof(record_t, name), DTL_JSON_FIELD_STRING, sizeof(((record_t*) 0)->name), (const dtl_json_schema_t*) 0, 0u, 0u},
+   {"id", offsetof(record_t, id), DTL_JSON_FIELD_U32, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+   {"offset", offsetof(record_t, offset), DTL_JSON_FIELD_I64, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+   {"size", offsetof(record_t, size), DTL_JSON_FIELD_U64, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+   {"ratio", offsetof(record_t, ratio), DTL_JSON_FIELD_DOUBLE, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+   {"enabled", offsetof(record_t, isEnabled), DTL_JSON_FIELD_BOOL, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+   {"origin", offsetof(record_t, origin), DTL_JSON_FIELD_STRUCT, sizeof(point_t), &m_pointSchema, 0u, 0u},
+   {"values", offsetof(record_t, values), DTL_JSON_FIELD_I32, 0u, (const dtl_json_schema_t*) 0, 4u, offsetof(record_t, numValues)},
+   {"points", offsetof(record_t, points), DTL_JSON_FIELD_STRUCT, sizeof(point_t), &m_pointSchema, 2u, offsetof(record_t, numPoints)},
+   {"tags", offsetof(record_t, tags), DTL_JSON_FIELD_STRING, sizeof(((record_t*) 0)->tags[0]), (const dtl_json_schema_t*) 0, 2u, offsetof(record_t, numTags)}
+};
+
+static const dtl_json_schema_t m_recordSchema = {m_recordFields, (uint32_t) (sizeof(m_recordFields) / sizeof(m_recordFields[0]))};
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_decode_scalars(CuTest* tc);
+static void test_json_decode_nested(CuTest* tc);
+static void test_json_decode_arrays(CuTest* tc);
+static void test_json_decode_unknown_and_missing(CuTest* tc);
+static void test_json_decode_limits(CuTest* tc);
+static void test_json_decode_errors(CuTest* tc);
+static void test_json_encode_scalars(CuTest* tc);
+static void test_json_encode_nested_and_arrays(CuTest* tc);
+static void test_json_encode_escaped_strings(CuTest* tc);
+static void test_json_encode_utf8_field_names(CuTest* tc);
+static void test_json_encode_round_trip(CuTest* tc);
+static dtl_json_error_t decode_cstr(const char *json, record_t *record);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_dtl_json_schema(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_json_decode_scalars);
+   SUITE_ADD_TEST(suite, test_json_decode_nested);
+   SUITE_ADD_TEST(suite, test_json_decode_arrays);
+   SUITE_ADD_TEST(suite, test_json_decode_unknown_and_missing);
+   SUITE_ADD_TEST(suite, test_json_decode_limits);
+   SUITE_ADD_TEST(suite, test_json_decode_errors);
+   SUITE_ADD_TEST(suite, test_json_encode_scalars);
+   SUITE_ADD_TEST(suite, test_json_encode_nested_and_arrays);
+   SUITE_ADD_TEST(suite, test_json_encode_escaped_strings);
+   SUITE_ADD_TEST(suite, test_json_encode_utf8_field_names);
+   SUITE_ADD_TEST(suite, test_json_encode_round_trip);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_decode_scalars(CuTest* tc)
+{
+   record_t record;
+   memset(&record, 0, sizeof(record));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, decode_cstr("{\"name\": \"a\\tb\", \"id\": 4294967295, \"offset\": -5000000000, "
+                                                        "\"size\": 18446744073709551615, \"ratio\": 0.25, \"enabled\": true}", &record));
+   CuAssertStrEquals(tc, "a\tb", record.name);
+   CuAssertUIntEquals(tc, UINT32_MAX, record.id);
+   CuAssertTrue(tc, record.offset == -5000000000LL);
+   CuAssertTrue(tc, record.size == UINT64_MAX);
+   CuAssertDblEquals(tc, 0.25, record.ratio, 0.0);
+   CuAssertTrue(tc, record.isEnabled);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, decode_cstr("{\"ratio\": 3, \"enabled\": false}", &record));
+   CuAssertDblEquals(tc, 3.0, record.ratio, 0.0);
+   CuAssertTrue(tc, !record.isEnabled);
+}
+
+static void test_json_decode_nested(CuTest* tc)
+{
+   record_t record;
+   memset(&record, 0, sizeof(record));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, decode_cstr("{\"origin\": {\"y\": -2, \"x\": 7}, \"id\": 1}", &record));
+   CuAssertIntEquals(tc, 7, record.origin.x);
+   CuAssertIntEquals(tc, -2, record.origin.y);
+   CuAssertUIntEquals(tc, 1u, record.id);
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, decode_cstr("{\"origin\": [1, 2]}", &record));
+}
+
+static void test_json_decode_arrays(CuTest* tc)
+{
+   record_t record;
+   memset(&record, 0, sizeof(record));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, decode_cstr("{\"values\": [3, -1, 4], \"points\": [{\"x\": 1, \"y\": 2}, {\"x\": 3, \"y\": 4}], "
+                                                        "\"tags\": [\"ab\", \"xyz\"]}", &record));
+   CuAssertUIntEquals(tc, 3u, record.numValues);
+   CuAssertIntEquals(tc, 3, record.values[0]);
+   CuAssertIntEquals(tc, -1, record.values[1]);
+   CuAssertIntEquals(tc, 4, record.values[2]);
+   CuAssertUIntEquals(tc, 2u, record.numPoints);
+   CuAssertIntEquals(tc, 1, record.points[0].x);
+   CuAssertIntEquals(tc, 4, record.points[1].y);
+   CuAssertUIntEquals(tc, 2u, record.numTags);
+   CuAssertStrEquals(tc, "ab", record.tags[0]);
+   CuAssertStrEquals(tc, "xyz", record.tags[1]);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, decode_cstr("{\"values\": []}", &record));
+   CuAssertUIntEquals(tc, 0u, record.numValues);
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, decode_cstr("{\"values\": 1}", &record));
+}
+
+static void test_json_decode_unknown_and_missing(CuTest* tc)
+{
+   record_t record;
+   memset(&record, 0, sizeof(record));
+   record.id = 9u;
+   record.ratio = 1.5;
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, decode_cstr("{\"extra\": {\"id\": [1, {\"a\": \"}\"}]}, \"ratio\": null, \"i\\u0064\": 2, \"more\": 1}", &record));
+   CuAssertUIntEquals(tc, 2u, record.id);
+   CuAssertDblEquals(tc, 1.5, record.ratio, 0.0);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, decode_cstr(" {} ", &record));
+   CuAssertUIntEquals(tc, 2u, record.id);
+}
+
+static void test_json_decode_limits(CuTest* tc)
+{
+   record_t record;
+   memset(&record, 0, sizeof(record));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, decode_cstr("{\"name\": \"1234567\"}", &record));
+   CuAssertStrEquals(tc, "1234567", record.name);
+   CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, decode_cstr("{\"name\": \"12345678\"}", &record));
+   CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, decode_cstr("{\"values\": [1, 2, 3, 4, 5]}", &record));
+   CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, decode_cstr("{\"tags\": [\"abcd\"]}", &record));
+}
+
+static void test_json_decode_errors(CuTest* tc)
+{
+   record_t record;
+   const char *json = "{}";
+   memset(&record, 0, sizeof(record));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, decode_cstr("{\"id\": -1}", &record));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, decode_cstr("{\"id\": 4294967296}", &record));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, decode_cstr("{\"origin\": {\"x\": 2147483648}}", &record));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, decode_cstr("{\"offset\": 1.5}", &record));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, decode_cstr("{\"name\": 1}", &record));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, decode_cstr("{\"enabled\": 1}", &record));
+   CuAssertIntEquals(tc, DTL_JSON_TYPE_ERROR, decode_cstr("[1]", &record));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, decode_cstr("{} x", &record));
+   CuAssertTrue(tc, decode_cstr("{\"id\": 1", &record) != DTL_JSON_NO_ERROR);
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_decode((const uint8_t*) json, (const uint8_t*) json + 2, (const dtl_json_schema_t*) 0, &record));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_decode((const uint8_t*) json, (const uint8_t*) json + 2, &m_recordSchema, (void*) 0));
+}
+
+static void test_json_encode_scalars(CuTest* tc)
+{
+   static const dtl_json_field_t fields[] = {
+      {"id", offsetof(record_t, id), DTL_JSON_FIELD_U32, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+      {"offset", offsetof(record_t, offset), DTL_JSON_FIELD_I64, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+      {"size", offsetof(record_t, size), DTL_JSON_FIELD_U64, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+      {"ratio", offsetof(record_t, ratio), DTL_JSON_FIELD_DOUBLE, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+      {"enabled", offsetof(record_t, isEnabled), DTL_JSON_FIELD_BOOL, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+      {"x", offsetof(record_t, origin.x), DTL_JSON_FIELD_I32, 0u, (const dtl_json_schema_t*) 0, 0u, 0u}
+   };
+   const dtl_json_schema_t schema = {fields, 6u};
+   dtl_json_encoder_t *encoder = dtl_json_encoder_new(&schema);
+   adt_str_t *str = adt_str_new();
+   record_t record;
+   memset(&record, 0, sizeof(record));
+   CuAssertPtrNotNull(tc, encoder);
+   record.id = UINT32_MAX;
+   record.offset = INT64_MIN;
+   record.size = UINT64_MAX;
+   record.ratio = 0.5;
+   record.isEnabled = true;
+   record.origin.x = INT32_MIN;
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_encoder_write(encoder, &record, str));
+   CuAssertStrEquals(tc, "{\"id\": 4294967295, \"offset\": -9223372036854775808, \"size\": 18446744073709551615, "
+                         "\"ratio\": 0.5, \"enabled\": true, \"x\": -2147483648}", adt_str_cstr(str));
+   adt_str_clear(str);
+   memset(&record, 0, sizeof(record));
+   record.ratio = 1.0 / 0.0;
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_encoder_write(encoder, &record, str));
+   CuAssertStrEquals(tc, "{\"id\": 0, \"offset\": 0, \"size\": 0, \"ratio\": null, \"enabled\": false, \"x\": 0}", adt_str_cstr(str));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_encoder_write(encoder, (const void*) 0, str));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_encoder_write((const dtl_json_encoder_t*) 0, &record, str));
+   CuAssertPtrEquals(tc, (void*) 0, dtl_json_encoder_new((const dtl_json_schema_t*) 0));
+   adt_str_delete(str);
+   dtl_json_encoder_delete(encoder);
+}
+
+static void test_json_encode_nested_and_arrays(CuTest* tc)
+{
+   static const dtl_json_field_t fields[] = {
+      {"origin", offsetof(record_t, origin), DTL_JSON_FIELD_STRUCT, sizeof(point_t), &m_pointSchema, 0u, 0u},
+      {"values", offsetof(record_t, values), DTL_JSON_FIELD_I32, 0u, (const dtl_json_schema_t*) 0, 4u, offsetof(record_t, numValues)},
+      {"points", offsetof(record_t, points), DTL_JSON_FIELD_STRUCT, sizeof(point_t), &m_pointSchema, 2u, offsetof(record_t, numPoints)},
+      {"tags", offsetof(record_t, tags), DTL_JSON_FIELD_STRING, sizeof(((record_t*) 0)->tags[0]), (const dtl_json_schema_t*) 0, 2u, offsetof(record_t, numTags)}
+   };
+   const dtl_json_schema_t schema = {fields, 4u};
+   dtl_json_encoder_t *encoder = dtl_json_encoder_new(&schema);
+   adt_str_t *str = adt_str_new();
+   record_t record;
+   memset(&record, 0, sizeof(record));
+   CuAssertPtrNotNull(tc, encoder);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_encoder_write(encoder, &record, str));
+   CuAssertStrEquals(tc, "{\"origin\": {\"x\": 0, \"y\": 0}, \"values\": [], \"points\": [], \"tags\": []}", adt_str_cstr(str));
+   adt_str_clear(str);
+   record.origin.y = -3;
+   record.values[0] = 1;
+   record.values[1] = 2;
+   record.numValues = 2u;
+   record.points[1].x = 5;
+   record.numPoints = 2u;
+   memcpy(record.tags[0], "abcd", 4u); //fills the buffer, no terminator
+   record.numTags = 9u; //more than maxCount
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_encoder_write(encoder, &record, str));
+   CuAssertStrEquals(tc, "{\"origin\": {\"x\": 0, \"y\": -3}, \"values\": [1, 2], \"points\": [{\"x\": 0, \"y\": 0}, {\"x\": 5, \"y\": 0}], "
+                         "\"tags\": [\"abcd\", \"\"]}", adt_str_cstr(str));
+   adt_str_delete(str);
+   dtl_json_encoder_delete(encoder);
+}
+
+static void test_json_encode_escaped_strings(CuTest* tc)
+{
+   static const dtl_json_field_t fields[] = {
+      {"na\"me\\", offsetof(record_t, name), DTL_JSON_FIELD_STRING, sizeof(((record_t*) 0)->name), (const dtl_json_schema_t*) 0, 0u, 0u}
+   };
+   const dtl_json_schema_t schema = {fields, 1u};
+   dtl_json_encoder_t *encoder = dtl_json_encoder_new(&schema);
+   adt_str_t *str = adt_str_new();
+   record_t record;
+   memset(&record, 0, sizeof(record));
+   CuAssertPtrNotNull(tc, encoder);
+   strcpy(record.name, "a\"\n\t\x01\xc3\xa5");
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_encoder_write(encoder, &record, str));
+   CuAssertStrEquals(tc, "{\"na\\\"me\\\\\": \"a\\\"\\n\\t\\u0001\xc3\xa5\"}", adt_str_cstr(str));
+   adt_str_delete(str);
+   dtl_json_encoder_delete(encoder);
+}
+
+static void test_json_encode_utf8_field_names(CuTest* tc)
+{
+   static const dtl_json_field_t fields[] = {
+      {"caf\xc3\xa9", offsetof(record_t, id), DTL_JSON_FIELD_U32, 0u, (const dtl_json_schema_t*) 0, 0u, 0u},
+      {"\xe3\x82\x84", offsetof(record_t, isEnabled), DTL_JSON_FIELD_BOOL, 0u, (const dtl_json_schema_t*) 0, 0u, 0u}
+   };
+   const dtl_json_schema_t schema = {fields, 2u};
+   dtl_json_encoder_t *encoder = dtl_json_encoder_new(&schema);
+   adt_str_t *str = adt_str_new();
+   record_t record;
+   memset(&record, 0, sizeof(record));
+   CuAssertPtrNotNull(tc, encoder);
+   record.id = 7u;
+   record.isEnabled = true;
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_encoder_write(encoder, &record, str));
+   CuAssertStrEquals(tc, "{\"caf\xc3\xa9\": 7, \"\xe3\x82\x84\": true}", adt_str_cstr(str));
+   adt_str_delete(str);
+   dtl_json_encoder_delete(encoder);
+}
+
+static void test_json_encode_round_trip(CuTest* tc)
+{
+   const char *json = "{\"name\": \"a\\\\b\", \"id\": 7, \"offset\": -1, \"size\": 2, \"ratio\": 0.1, \"enabled\": true, "
+                      "\"origin\": {\"x\": 1, \"y\": 2}, \"values\": [4, 5, 6], \"points\": [{\"x\": 3, \"y\": 4}], "
+                      "\"tags\": [\"ab\"]}";
+   dtl_json_encoder_t *encoder = dtl_json_encoder_new(&m_recordSchema);
+   adt_str_t *str = adt_str_new();
+   record_t record;
+   record_t copy;
+   memset(&record, 0, sizeof(record));
+   memset(&copy, 0, sizeof(copy));
+   CuAssertPtrNotNull(tc, encoder);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, decode_cstr(json, &record));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, dtl_json_encoder_write(encoder, &record, str));
+   CuAssertStrEquals(tc, json, adt_str_cstr(str));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, decode_cstr(adt_str_cstr(str), &copy));
+   CuAssertTrue(tc, memcmp(&record, &copy, sizeof(record)) == 0);
+   adt_str_delete(str);
+   dtl_json_encoder_delete(encoder);
+}
+
+static dtl_json_error_t decode_cstr(const char *json, record_t *record)
+{
+   return dtl_json_decode((const uint8_t*) json, (const uint8_t*) json + strlen(json), &m_recordSchema, record);
+}
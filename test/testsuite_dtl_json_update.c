@@ -0,0 +1,289 @@
+/*****************************************************************************
+* \file      testsuite_dtl_json_update.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Unit tests for dtl_json_load_into
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+#include "dtl_json.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_load_into_empty(CuTest* tc);
+static void test_json_load_into_unchanged(CuTest* tc);
+static void test_json_load_into_changed_values(CuTest* tc);
+static void test_json_load_into_added_and_removed(CuTest* tc);
+static void test_json_load_into_duplicate_keys(CuTest* tc);
+static void test_json_load_into_top_level(CuTest* tc);
+static void test_json_load_into_malformed(CuTest* tc);
+static dtl_json_error_t update_cstr(dtl_dv_t **ppDv, const char *json, dtl_av_t *changes);
+static char *changes_cstr(dtl_av_t *changes);
+static char *dv_dumps(const dtl_dv_t *dv);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static char m_output[256];
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_dtl_json_update(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_json_load_into_empty);
+   SUITE_ADD_TEST(suite, test_json_load_into_unchanged);
+   SUITE_ADD_TEST(suite, test_json_load_into_changed_values);
+   SUITE_ADD_TEST(suite, test_json_load_into_added_and_removed);
+   SUITE_ADD_TEST(suite, test_json_load_into_duplicate_keys);
+   SUITE_ADD_TEST(suite, test_json_load_into_top_level);
+   SUITE_ADD_TEST(suite, test_json_load_into_malformed);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_load_into_empty(CuTest* tc)
+{
+   dtl_dv_t *dv = (dtl_dv_t*) 0;
+   dtl_av_t *changes = dtl_av_new();
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, update_cstr(&dv, "{\"a\": [1, 2], \"b\": \"text\"}", changes));
+   CuAssertPtrNotNull(tc, dv);
+   CuAssertStrEquals(tc, "{\"a\": [1, 2], \"b\": \"text\"}", dv_dumps(dv));
+   CuAssertStrEquals(tc, "\"\"", changes_cstr(changes));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_load_into((dtl_dv_t**) 0, (const uint8_t*) "1", (const uint8_t*) "1" + 1, changes));
+   dtl_dv_dec_ref(dv);
+   dtl_dv_dec_ref((dtl_dv_t*) changes);
+}
+
+static void test_json_load_into_unchanged(CuTest* tc)
+{
+   const char *json = "{\"name\": \"server\", \"port\": 8080, \"big\": 5000000000, \"ratio\": 0.5, \"on\": true, \"none\": null, "
+                      "\"list\": [1, \"two\", {\"three\": 3}], \"escaped\": \"a\\\"b\"}";
+   dtl_dv_t *dv = dtl_json_load_cstr(json);
+   dtl_dv_t *list;
+   dtl_dv_t *name;
+   dtl_dv_t *three;
+   dtl_dv_t *ratio;
+   dtl_av_t *changes = dtl_av_new();
+   CuAssertPtrNotNull(tc, dv);
+   list = dtl_hv_get_cstr((dtl_hv_t*) dv, "list");
+   name = dtl_hv_get_cstr((dtl_hv_t*) dv, "name");
+   ratio = dtl_hv_get_cstr((dtl_hv_t*) dv, "ratio");
+   three = dtl_av_value((dtl_av_t*) list, 2);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, update_cstr(&dv, json, changes));
+   CuAssertIntEquals(tc, 0, dtl_av_length(changes));
+   CuAssertPtrEquals(tc, list, dtl_hv_get_cstr((dtl_hv_t*) dv, "list"));
+   CuAssertPtrEquals(tc, name, dtl_hv_get_cstr((dtl_hv_t*) dv, "name"));
+   CuAssertPtrEquals(tc, ratio, dtl_hv_get_cstr((dtl_hv_t*) dv, "ratio"));
+   CuAssertPtrEquals(tc, three, dtl_av_value((dtl_av_t*) list, 2));
+   dtl_dv_dec_ref(dv);
+   dtl_dv_dec_ref((dtl_dv_t*) changes);
+}
+
+static void test_json_load_into_changed_values(CuTest* tc)
+{
+   dtl_dv_t *dv = dtl_json_load_cstr("{\"a\": {\"x\": 1, \"y\": \"old\"}, \"b\": [true, 2, 3], \"c\": {\"d\": 1}, \"m/n~\": 1}");
+   dtl_dv_t *a;
+   dtl_dv_t *b;
+   dtl_dv_t *x;
+   dtl_av_t *changes = dtl_av_new();
+   CuAssertPtrNotNull(tc, dv);
+   a = dtl_hv_get_cstr((dtl_hv_t*) dv, "a");
+   b = dtl_hv_get_cstr((dtl_hv_t*) dv, "b");
+   x = dtl_hv_get_cstr((dtl_hv_t*) a, "x");
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR,
+                     update_cstr(&dv, "{\"a\": {\"x\": 1, \"y\": \"new\"}, \"b\": [false, 2, 3.0], \"c\": [1], \"m/n~\": 2}", changes));
+   CuAssertStrEquals(tc, "\"/a/y\" \"/b/0\" \"/b/2\" \"/c\" \"/m~1n~0\"", changes_cstr(changes));
+   CuAssertPtrEquals(tc, a, dtl_hv_get_cstr((dtl_hv_t*) dv, "a"));
+   CuAssertPtrEquals(tc, b, dtl_hv_get_cstr((dtl_hv_t*) dv, "b"));
+   CuAssertPtrEquals(tc, x, dtl_hv_get_cstr((dtl_hv_t*) a, "x"));
+   CuAssertStrEquals(tc, "{\"a\": {\"x\": 1, \"y\": \"new\"}, \"b\": [false, 2, 3.0], \"c\": [1], \"m/n~\": 2}", dv_dumps(dv));
+   dtl_dv_dec_ref(dv);
+   dtl_dv_dec_ref((dtl_dv_t*) changes);
+}
+
+static void test_json_load_into_added_and_removed(CuTest* tc)
+{
+   dtl_dv_t *dv = dtl_json_load_cstr("{\"a\": {\"x\": 1, \"y\": 2, \"z\": [0]}, \"b\": [1, 2, 3, 4]}");
+   dtl_dv_t *a;
+   dtl_dv_t *z;
+   dtl_dv_t *b;
+   dtl_av_t *changes = dtl_av_new();
+   CuAssertPtrNotNull(tc, dv);
+   a = dtl_hv_get_cstr((dtl_hv_t*) dv, "a");
+   z = dtl_hv_get_cstr((dtl_hv_t*) a, "z");
+   b = dtl_hv_get_cstr((dtl_hv_t*) dv, "b");
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, update_cstr(&dv, "{\"a\": {\"z\": [0], \"w\": 3}, \"b\": [1, 2], \"c\": []}", changes));
+   CuAssertStrEquals(tc, "\"/a/w\" \"/a/x\" \"/a/y\" \"/b/2\" \"/b/3\" \"/c\"", changes_cstr(changes));
+   //objects and arrays that lost members are replaced, their remaining children are kept
+   CuAssertTrue(tc, a != dtl_hv_get_cstr((dtl_hv_t*) dv, "a"));
+   CuAssertTrue(tc, b != dtl_hv_get_cstr((dtl_hv_t*) dv, "b"));
+   CuAssertPtrEquals(tc, z, dtl_hv_get_cstr((dtl_hv_t*) dtl_hv_get_cstr((dtl_hv_t*) dv, "a"), "z"));
+   CuAssertStrEquals(tc, "{\"a\": {\"w\": 3, \"z\": [0]}, \"b\": [1, 2], \"c\": []}", dv_dumps(dv));
+
+   dtl_av_delete(changes);
+   changes = dtl_av_new();
+   b = dtl_hv_get_cstr((dtl_hv_t*) dv, "b");
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, update_cstr(&dv, "{\"a\": {\"z\": [0], \"w\": 3}, \"b\": [1, 2, 5], \"c\": []}", changes));
+   CuAssertStrEquals(tc, "\"/b/2\"", changes_cstr(changes));
+   CuAssertPtrEquals(tc, b, dtl_hv_get_cstr((dtl_hv_t*) dv, "b"));
+   dtl_dv_dec_ref(dv);
+   dtl_dv_dec_ref((dtl_dv_t*) changes);
+}
+
+/**
+ * A key repeated in the document must not hide a member that was removed.
+ */
+static void test_json_load_into_duplicate_keys(CuTest* tc)
+{
+   dtl_dv_t *dv = dtl_json_load_cstr("{\"a\": 1, \"b\": 2}");
+   dtl_dv_t *prev = dv;
+   dtl_av_t *changes = dtl_av_new();
+   CuAssertPtrNotNull(tc, dv);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, update_cstr(&dv, "{\"a\": 1, \"a\": 2}", changes));
+   CuAssertStrEquals(tc, "\"/a\" \"/b\"", changes_cstr(changes));
+   CuAssertTrue(tc, prev != dv);
+   CuAssertStrEquals(tc, "{\"a\": 2}", dv_dumps(dv));
+   dtl_dv_dec_ref(dv);
+   dtl_dv_dec_ref((dtl_dv_t*) changes);
+
+   dv = dtl_json_load_cstr("{\"a\": 1, \"b\": 2}");
+   changes = dtl_av_new();
+   CuAssertPtrNotNull(tc, dv);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, update_cstr(&dv, "{\"c\": 1, \"c\": 2, \"a\": 1}", changes));
+   CuAssertStrEquals(tc, "\"/c\" \"/c\" \"/b\"", changes_cstr(changes));
+   CuAssertStrEquals(tc, "{\"a\": 1, \"c\": 2}", dv_dumps(dv));
+   dtl_dv_dec_ref(dv);
+   dtl_dv_dec_ref((dtl_dv_t*) changes);
+
+   dv = dtl_json_load_cstr("{\"\303\2511\": 1, \"\303\2512\": 2}");
+   prev = dv;
+   changes = dtl_av_new();
+   CuAssertPtrNotNull(tc, dv);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, update_cstr(&dv, "{\"\303\2511\": 1, \"\303\2512\": 2}", changes));
+   CuAssertIntEquals(tc, 0, dtl_av_length(changes));
+   CuAssertPtrEquals(tc, prev, dv);
+   dtl_dv_dec_ref(dv);
+   dtl_dv_dec_ref((dtl_dv_t*) changes);
+}
+
+static void test_json_load_into_top_level(CuTest* tc)
+{
+   dtl_dv_t *dv = dtl_json_load_cstr("{\"a\": 1, \"b\": 2}");
+   dtl_dv_t *prev;
+   dtl_av_t *changes = dtl_av_new();
+   CuAssertPtrNotNull(tc, dv);
+   dtl_dv_inc_ref(dv);
+   prev = dv;
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, update_cstr(&dv, "{\"a\": 1}", changes));
+   CuAssertTrue(tc, prev != dv);
+   CuAssertStrEquals(tc, "\"/b\"", changes_cstr(changes));
+   CuAssertStrEquals(tc, "{\"a\": 1}", dv_dumps(dv));
+   CuAssertStrEquals(tc, "{\"a\": 1, \"b\": 2}", dv_dumps(prev));
+   dtl_dv_dec_ref(prev);
+
+   dtl_av_delete(changes);
+   changes = dtl_av_new();
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, update_cstr(&dv, "[1]", changes));
+   CuAssertStrEquals(tc, "\"\"", changes_cstr(changes));
+   CuAssertStrEquals(tc, "[1]", dv_dumps(dv));
+   dtl_dv_dec_ref(dv);
+   dtl_dv_dec_ref((dtl_dv_t*) changes);
+}
+
+static void test_json_load_into_malformed(CuTest* tc)
+{
+   dtl_dv_t *dv = dtl_json_load_cstr("{\"a\": 1, \"b\": [2]}");
+   dtl_dv_t *prev = dv;
+   dtl_av_t *changes = dtl_av_new();
+   char deepJson[2 * (DTL_JSON_CURSOR_MAX_DEPTH + 1) + 1];
+   CuAssertPtrNotNull(tc, dv);
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, update_cstr(&dv, "{\"a\": 2, \"b\": [3 4]}", changes));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_EOB_ERROR, update_cstr(&dv, "{\"a\": 2", changes));
+   memset(deepJson, '[', DTL_JSON_CURSOR_MAX_DEPTH + 1);
+   memset(deepJson + DTL_JSON_CURSOR_MAX_DEPTH + 1, ']', DTL_JSON_CURSOR_MAX_DEPTH + 1);
+   deepJson[2 * (DTL_JSON_CURSOR_MAX_DEPTH + 1)] = '\0';
+   CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, update_cstr(&dv, deepJson, changes));
+   CuAssertPtrEquals(tc, prev, dv);
+   CuAssertIntEquals(tc, 0, dtl_av_length(changes));
+   CuAssertStrEquals(tc, "{\"a\": 1, \"b\": [2]}", dv_dumps(dv));
+   dtl_dv_dec_ref(dv);
+   dtl_dv_dec_ref((dtl_dv_t*) changes);
+}
+
+static dtl_json_error_t update_cstr(dtl_dv_t **ppDv, const char *json, dtl_av_t *changes)
+{
+   return dtl_json_load_into(ppDv, (const uint8_t*) json, (const uint8_t*) json + strlen(json), changes);
+}
+
+/**
+ * Returns the change list as space-separated quoted strings in a static buffer.
+ */
+static char *changes_cstr(dtl_av_t *changes)
+{
+   int32_t i;
+   m_output[0] = '\0';
+   for (i = 0; i < dtl_av_length(changes); i++)
+   {
+      bool ok = false;
+      const char *path = dtl_sv_to_cstr((dtl_sv_t*) dtl_av_value(changes, i), &ok);
+      size_t len = strlen(m_output);
+      snprintf(m_output + len, sizeof(m_output) - len, "%s\"%s\"", (i > 0)? " " : "", ok? path : "?");
+   }
+   return m_output;
+}
+
+/**
+ * Returns value serialized with sorted keys in a static buffer.
+ */
+static char *dv_dumps(const dtl_dv_t *dv)
+{
+   adt_str_t *output = dtl_json_dumps(dv, 0, true);
+   m_output[0] = '\0';
+   if (output != 0)
+   {
+      strncpy(m_output, adt_str_cstr(output), sizeof(m_output) - 1u);
+      m_output[sizeof(m_output) - 1u] = '\0';
+      adt_str_delete(output);
+   }
+   return m_output;
+}
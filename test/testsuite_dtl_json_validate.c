@@ -0,0 +1,202 @@
+/*****************************************************************************
+* \file      testsuite_dtl_json_validate.c
+* \author    Conny Gustafsson
+* \date      2026-10-16
+* \brief     Unit tests for dtl_json_validate
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+#include "dtl_json.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_validate_valid_documents(CuTest* tc);
+static void test_json_validate_syntax_errors(CuTest* tc);
+static void test_json_validate_error_location(CuTest* tc);
+static void test_json_validate_strings(CuTest* tc);
+static void test_json_validate_utf8_strings(CuTest* tc);
+static void test_json_validate_depth(CuTest* tc);
+static void test_json_reader_line_number(CuTest* tc);
+static dtl_json_error_t validate_cstr(const char *json, dtl_json_error_info_t *errInfo);
+static dtl_json_error_t validate_utf8_cstr(const char *json, dtl_json_error_info_t *errInfo);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_dtl_json_validate(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_json_validate_valid_documents);
+   SUITE_ADD_TEST(suite, test_json_validate_syntax_errors);
+   SUITE_ADD_TEST(suite, test_json_validate_error_location);
+   SUITE_ADD_TEST(suite, test_json_validate_strings);
+   SUITE_ADD_TEST(suite, test_json_validate_utf8_strings);
+   SUITE_ADD_TEST(suite, test_json_validate_depth);
+   SUITE_ADD_TEST(suite, test_json_reader_line_number);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_json_validate_valid_documents(CuTest* tc)
+{
+   dtl_json_error_info_t errInfo;
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, validate_cstr("{\"a\": [1, -2.5e3, true, false, null, \"s\"], \"b\": {}}", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, errInfo.errorCode);
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, validate_cstr("  [ ]\n", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, validate_cstr("\"text\"", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, validate_cstr("0", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, validate_cstr("[\"tab\\t quote\\\" slash\\/ \\u00e5\\uD83D\\uDE00\"]", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, validate_cstr("{\"a\": 1}", (dtl_json_error_info_t*) 0));
+}
+
+static void test_json_validate_syntax_errors(CuTest* tc)
+{
+   dtl_json_error_info_t errInfo;
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_EOB_ERROR, validate_cstr("", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_EOB_ERROR, validate_cstr("[1, 2", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, validate_cstr("[1, 2,]", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, validate_cstr("{\"a\" 1}", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, validate_cstr("[tru]", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, validate_cstr("[01]", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, validate_cstr("[1] [2]", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_UNMATCHED_STRING_LITERAL, validate_cstr("[\"abc]", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_EMPTY_KEY_ERROR, validate_cstr("{\"\": 1}", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_EMPTY_KEY_ERROR, errInfo.errorCode);
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, dtl_json_validate((const uint8_t*) 0, (const uint8_t*) 0, &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ARGUMENT_ERROR, errInfo.errorCode);
+}
+
+static void test_json_validate_error_location(CuTest* tc)
+{
+   dtl_json_error_info_t errInfo;
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, validate_cstr("[1, 2 3]", &errInfo));
+   CuAssertIntEquals(tc, 6, (int) errInfo.offset);
+   CuAssertIntEquals(tc, 1, (int) errInfo.lineNumber);
+   CuAssertIntEquals(tc, 7, (int) errInfo.column);
+
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, validate_cstr("{\n  \"a\": 1,\n  \"b\": x\n}", &errInfo));
+   CuAssertIntEquals(tc, 19, (int) errInfo.offset);
+   CuAssertIntEquals(tc, 3, (int) errInfo.lineNumber);
+   CuAssertIntEquals(tc, 8, (int) errInfo.column);
+
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_EOB_ERROR, validate_cstr("[\n1,\n", &errInfo));
+   CuAssertIntEquals(tc, 5, (int) errInfo.offset);
+   CuAssertIntEquals(tc, 3, (int) errInfo.lineNumber);
+   CuAssertIntEquals(tc, 1, (int) errInfo.column);
+
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ESCAPE_ERROR, validate_cstr("[\"ok\",\n \"a\\qb\"]", &errInfo));
+   CuAssertIntEquals(tc, 10, (int) errInfo.offset);
+   CuAssertIntEquals(tc, 2, (int) errInfo.lineNumber);
+   CuAssertIntEquals(tc, 4, (int) errInfo.column);
+}
+
+static void test_json_validate_strings(CuTest* tc)
+{
+   dtl_json_error_info_t errInfo;
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ESCAPE_ERROR, validate_cstr("[\"\\x41\"]", &errInfo));
+   CuAssertIntEquals(tc, 2, (int) errInfo.offset);
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ESCAPE_ERROR, validate_cstr("[\"\\u12G4\"]", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ESCAPE_ERROR, validate_cstr("[\"\\u12\"]", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ESCAPE_ERROR, validate_cstr("{\"k\\a\": 1}", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, validate_cstr("[\"line\nbreak\"]", &errInfo));
+   CuAssertIntEquals(tc, 6, (int) errInfo.offset);
+   //Without UTF-8 checking the bytes of strings are not inspected beyond escapes and control characters
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, validate_cstr("[\"\xff\xfe\"]", &errInfo));
+}
+
+static void test_json_validate_utf8_strings(CuTest* tc)
+{
+   dtl_json_error_info_t errInfo;
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, validate_utf8_cstr("{\"n\xc3\xa5me\": \"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 plain ascii text\"}", &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_UTF8_ERROR, validate_utf8_cstr("[\"abcdefghijkl\xff\"]", &errInfo));
+   CuAssertIntEquals(tc, 14, (int) errInfo.offset);
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_UTF8_ERROR, validate_utf8_cstr("[\"\xc0\xaf\"]", &errInfo)); //overlong
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_UTF8_ERROR, validate_utf8_cstr("[\"\xed\xa0\x80\"]", &errInfo)); //surrogate
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_UTF8_ERROR, validate_utf8_cstr("[\"\xf4\x90\x80\x80\"]", &errInfo)); //above U+10FFFF
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_UTF8_ERROR, validate_utf8_cstr("[\"\xe2\x82\"]", &errInfo)); //truncated
+   CuAssertIntEquals(tc, 2, (int) errInfo.offset);
+   CuAssertIntEquals(tc, DTL_JSON_INVALID_ESCAPE_ERROR, validate_utf8_cstr("[\"0123456789\\z\"]", &errInfo));
+   CuAssertIntEquals(tc, 12, (int) errInfo.offset);
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, validate_utf8_cstr("[\"0123456789\t\"]", &errInfo));
+   CuAssertIntEquals(tc, 12, (int) errInfo.offset);
+}
+
+static void test_json_validate_depth(CuTest* tc)
+{
+   dtl_json_error_info_t errInfo;
+   char json[2 * (DTL_JSON_CURSOR_MAX_DEPTH + 1) + 1];
+   memset(json, '[', DTL_JSON_CURSOR_MAX_DEPTH);
+   memset(json + DTL_JSON_CURSOR_MAX_DEPTH, ']', DTL_JSON_CURSOR_MAX_DEPTH);
+   json[2 * DTL_JSON_CURSOR_MAX_DEPTH] = '\0';
+   CuAssertIntEquals(tc, DTL_JSON_NO_ERROR, validate_cstr(json, &errInfo));
+   memset(json, '[', DTL_JSON_CURSOR_MAX_DEPTH + 1);
+   memset(json + DTL_JSON_CURSOR_MAX_DEPTH + 1, ']', DTL_JSON_CURSOR_MAX_DEPTH + 1);
+   json[2 * (DTL_JSON_CURSOR_MAX_DEPTH + 1)] = '\0';
+   CuAssertIntEquals(tc, DTL_JSON_LIMIT_ERROR, validate_cstr(json, &errInfo));
+   CuAssertIntEquals(tc, DTL_JSON_CURSOR_MAX_DEPTH, (int) errInfo.offset);
+}
+
+static void test_json_reader_line_number(CuTest* tc)
+{
+   const char *json = "{\n  \"a\": 1,\n  \"b\": ?\n}";
+   dtl_json_reader_t *reader = dtl_json_reader_new();
+   dtl_json_parser_t *parser = dtl_json_parser_new();
+   CuAssertPtrNotNull(tc, reader);
+   CuAssertPtrNotNull(tc, parser);
+   CuAssertPtrEquals(tc, 0, dtl_json_reader_load_cstr(reader, json));
+   CuAssertIntEquals(tc, DTL_JSON_UNEXPECTED_CHAR_ERROR, dtl_json_reader_last_error(reader));
+   CuAssertIntEquals(tc, 3, (int) dtl_json_reader_line_number(reader));
+   CuAssertIntEquals(tc, DTL_JSON_PARSER_ERROR, dtl_json_parser_feed(parser, (const uint8_t*) json, (uint32_t) strlen(json)));
+   CuAssertIntEquals(tc, 3, (int) dtl_json_parser_line_number(parser));
+   CuAssertIntEquals(tc, 0, (int) dtl_json_reader_line_number((const dtl_json_reader_t*) 0));
+   dtl_json_parser_delete(parser);
+   dtl_json_reader_delete(reader);
+}
+
+static dtl_json_error_t validate_cstr(const char *json, dtl_json_error_info_t *errInfo)
+{
+   return dtl_json_validate((const uint8_t*) json, (const uint8_t*) json + strlen(json), errInfo);
+}
+
+static dtl_json_error_t validate_utf8_cstr(const char *json, dtl_json_error_info_t *errInfo)
+{
+   return dtl_json_validate_utf8((const uint8_t*) json, (const uint8_t*) json + strlen(json), errInfo);
+}
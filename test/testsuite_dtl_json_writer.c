@@ -28,6 +28,7 @@
 //////////////////////////////////////////////////////////////////////////////
 #include <stdio.h>
 #include <stddef.h>
+#include <math.h>
 #include "dtl_type.h"
 #include "CuTest.h"
 #include "dtl_json.h"
@@ -60,6 +61,7 @@ static void test_json_write_u32_list_with_indent(CuTest* tc);
 static void test_json_write_small_object_no_indent(CuTest* tc);
 static void test_json_write_small_object_with_indent(CuTest* tc);
 static void test_json_write_small_objects_with_indent(CuTest* tc);
+static void test_json_write_double(CuTest* tc);
 static void test_json_write_string(CuTest* tc);
 static void test_json_write_string_list_no_indent(CuTest* tc);
 static void test_json_write_string_list_with_indent(CuTest* tc);
@@ -90,6 +92,7 @@ CuSuite* testsuite_dtl_json_writer(void)
    SUITE_ADD_TEST(suite, test_json_write_small_object_no_indent);
    SUITE_ADD_TEST(suite, test_json_write_small_object_with_indent);
    SUITE_ADD_TEST(suite, test_json_write_small_objects_with_indent);
+   SUITE_ADD_TEST(suite, test_json_write_double);
    SUITE_ADD_TEST(suite, test_json_write_string);
    SUITE_ADD_TEST(suite, test_json_write_string_list_no_indent);
    SUITE_ADD_TEST(suite, test_json_write_string_list_with_indent);
@@ -526,6 +529,34 @@ static void test_json_write_small_objects_with_indent(CuTest* tc)
    adt_str_delete(output);
 }
 
+static void test_json_write_double(CuTest* tc)
+{
+   const int indent = 0;
+   const double input[] = {0.5, 1.0, -0.0, 0.1, 1.0 / 3.0, -2.5e-3, 1e300, 5e-324};
+   const char *expected[] = {"0.5", "1.0", "-0.0", "0.1", "0.3333333333333333", "-0.0025", "1e+300", "4.94065645841247e-324"};
+   int32_t i;
+   dtl_sv_t *sv;
+   adt_str_t *output;
+
+   for (i = 0; i < (int32_t) (sizeof(input) / sizeof(input[0])); i++)
+   {
+      sv = dtl_sv_make_dbl(input[i]);
+      CuAssertPtrNotNull(tc, sv);
+      output = dtl_json_dumps((dtl_dv_t*) sv, indent, false);
+      CuAssertPtrNotNull(tc, output);
+      CuAssertStrEquals(tc, expected[i], adt_str_cstr(output));
+      dtl_sv_delete(sv);
+      adt_str_delete(output);
+   }
+
+   sv = dtl_sv_make_dbl(HUGE_VAL);
+   output = dtl_json_dumps((dtl_dv_t*) sv, indent, false);
+   CuAssertPtrNotNull(tc, output);
+   CuAssertStrEquals(tc, "null", adt_str_cstr(output));
+   dtl_sv_delete(sv);
+   adt_str_delete(output);
+}
+
 static void test_json_write_string(CuTest* tc)
 {
    const int indent = 0;